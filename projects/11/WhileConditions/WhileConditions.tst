@@ -0,0 +1,20 @@
+// File name: projects/11/WhileConditions/WhileConditions.tst
+
+// Runs the program compiled by
+//     JackCompiler projects/11/WhileConditions
+// on the VMEmulator.
+
+load,
+output-file WhileConditions.out,
+compare-to WhileConditions.cmp,
+output-list RAM[8000]%D2.6.1 RAM[8001]%D2.6.1 RAM[8002]%D2.6.1 RAM[8003]%D2.6.1;
+
+set sp 256,
+set local 256,
+set argument 256;
+
+repeat 1000 {
+  vmstep;
+}
+
+output;
@@ -0,0 +1,29 @@
+// File name: projects/12/MemoryBenchmark/MemoryBenchmark.tst
+
+// Runs the benchmark compiled with the OS by
+//     RunAll projects/12/MemoryBenchmark projects/12/MemoryBenchmark/build --write-intermediates
+// on the VMEmulator and outputs the count of executed VM commands at the end
+// of every phase (rounded up to 1000 commands). The time difference of two
+// lines divided by the count of calls of the later line is the cost of alloc
+// and deAlloc. Another Memory.jack in this directory replaces the OS class
+// for a comparison.
+
+load build/vm_files,
+output-file MemoryBenchmark.out,
+compare-to MemoryBenchmark.cmp,
+output-list RAM[17000]%D2.6.2 RAM[17001]%D2.6.2 RAM[17002]%D2.6.2 time%D1.10.1;
+
+while RAM[17000] < 1 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 2 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 3 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 4 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 5 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 6 { repeat 1000 { vmstep; } }
+output;
+while RAM[17000] < 7 { repeat 1000 { vmstep; } }
+output;
@@ -0,0 +1,32 @@
+// File name: projects/12/ScreenBenchmark/ScreenBenchmark.tst
+
+// Runs the benchmark compiled with the OS by
+//     RunAll projects/12/ScreenBenchmark projects/12/ScreenBenchmark/build --write-intermediates
+// on the VMEmulator and outputs the count of executed VM commands at the end
+// of every phase (rounded up to 1000 commands). The time difference of two
+// lines divided by the count of calls of the later line is the cost of one
+// call of Screen with the loop around it. The checksums of the screen are
+// output by the last line. Another Screen.jack in this directory replaces
+// the OS class for a comparison.
+
+load build/vm_files,
+output-file ScreenBenchmark.out,
+compare-to ScreenBenchmark.cmp,
+output-list RAM[16000]%D2.6.2 RAM[16001]%D2.6.2 RAM[16002]%D2.6.2 RAM[16003]%D2.6.2 time%D1.10.1;
+
+while RAM[16000] < 1 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 2 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 3 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 4 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 5 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 6 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 7 { repeat 1000 { vmstep; } }
+output;
+while RAM[16000] < 8 { repeat 1000 { vmstep; } }
+output;
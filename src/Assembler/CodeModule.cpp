@@ -5,6 +5,8 @@
 
 using namespace std;
 
+namespace assembler
+{
 const map<string, string, less<>> dest_table = {
     {   "", "000"},
     {  "M", "001"},
@@ -86,3 +88,4 @@ string CodeModule::jump(const string& mnemonic)
     }
     throw HackAssemblerError("Error: Failed to convert jump mnemonic " + mnemonic + " to binary.");
 }
+}
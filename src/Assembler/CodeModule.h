@@ -2,6 +2,8 @@
 
 #include <string>
 
+namespace assembler
+{
 /// <summary>
 /// The module provides services for translating symbolic Hack mnemonics into their binary codes.
 /// </summary>
@@ -30,3 +32,4 @@ private:
     /// </summary>
     CodeModule() = default;
 };
+}
@@ -6,6 +6,8 @@
 using namespace std;
 namespace fs = std::filesystem;
 
+namespace assembler
+{
 bool isNumber(string_view text)
 {
     return !text.empty() && text.find_first_not_of("0123456789") == string::npos;
@@ -16,7 +18,7 @@ bool isNumber(string_view text)
 /// </summary>
 void HackAssembler::searchSymbols()
 {
-    mParser = make_unique<Parser>(mInputFileName);
+    mParser = createParser();
 
     while (mParser->hasMoreLines())
     {
@@ -46,14 +48,21 @@ void HackAssembler::searchSymbols()
 /// </summary>
 void HackAssembler::assemblerToMachineCode(bool allowOverflowError)
 {
-    mParser = make_unique<Parser>(mInputFileName);
+    mParser = createParser();
 
-    auto outputStream = make_unique<ofstream>(mOutputFileName);
-    if (!outputStream->is_open())
+    unique_ptr<ofstream> outputFile;
+    ostream* outputStream = mOutputStream;
+    if (!outputStream)
     {
-        throw HackAssemblerError("Cannot find or open " + mOutputFileName + " file");
+        outputFile = make_unique<ofstream>(mOutputFileName);
+        if (!outputFile->is_open())
+        {
+            throw HackAssemblerError("Cannot find or open " + mOutputFileName + " file");
+        }
+        outputStream = outputFile.get();
     }
-    
+
+
     int variableAddress = 16;
     while (mParser->hasMoreLines())
     {
@@ -67,11 +76,11 @@ void HackAssembler::assemblerToMachineCode(bool allowOverflowError)
 
         if (mParser->instructionType() == InstructionType::A_INSTRUCTION)
         {
-            writeAInstruction(outputStream.get(), variableAddress, allowOverflowError);
+            writeAInstruction(outputStream, variableAddress, allowOverflowError);
         }
         else if (mParser->instructionType() == InstructionType::C_INSTRUCTION)
         {
-            writeCInstruction(outputStream.get());
+            writeCInstruction(outputStream);
         }
     }
 }
@@ -99,7 +108,30 @@ HackAssembler::HackAssembler(const string& inputFile)
     }
 }
 
-void HackAssembler::writeAInstruction(ofstream* outputStream, int& variableAddress, bool allowOverflowError)
+/// <summary>
+/// Creates assembler reading assembly code from the seekable input stream
+///     and writing machine instructions into the output stream.
+/// </summary>
+HackAssembler::HackAssembler(istream& inputStream, ostream& outputStream)
+    : mInputStream(&inputStream),
+    mOutputStream(&outputStream)
+{
+}
+
+unique_ptr<Parser> HackAssembler::createParser()
+{
+    if (!mInputStream)
+    {
+        return make_unique<Parser>(mInputFileName);
+    }
+
+    // both runs read the same stream from the beginning
+    mInputStream->clear();
+    mInputStream->seekg(0);
+    return make_unique<Parser>(*mInputStream);
+}
+
+void HackAssembler::writeAInstruction(ostream* outputStream, int& variableAddress, bool allowOverflowError)
 {
     int symbolAddress = -1;
     if (isdigit(mParser->symbol()[0]))
@@ -142,7 +174,7 @@ void HackAssembler::writeAInstruction(ofstream* outputStream, int& variableAddre
     *outputStream << binary << "\n";
 }
 
-void HackAssembler::writeCInstruction(ofstream* outputStream) const
+void HackAssembler::writeCInstruction(ostream* outputStream) const
 {
     *outputStream
         << "111"
@@ -151,3 +183,4 @@ void HackAssembler::writeCInstruction(ofstream* outputStream) const
         << CodeModule::jump(mParser->jump())
         << "\n";
 }
+}
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <istream>
+#include <ostream>
 #include <string>
 
 #include "CodeModule.h"
 #include "Parser.h"
 #include "SymbolTable.h"
 
+namespace assembler
+{
 /// <summary>
 /// HackAssembler contains main implementation to map symbols from input file,
 ///     then to convert assembler code to machine instructions
@@ -26,13 +30,23 @@ public:
     /// Creates parser, symbol table and handles file paths
     /// </summary>
     explicit HackAssembler(const std::string& inputFile);
+    /// <summary>
+    /// Creates assembler reading assembly code from the seekable input stream
+    ///     and writing machine instructions into the output stream.
+    /// </summary>
+    HackAssembler(std::istream& inputStream, std::ostream& outputStream);
 
 private:
-    void writeAInstruction(std::ofstream* outputStream, int& variableAddress, bool allowOverflowError);
-    void writeCInstruction(std::ofstream* outputStream) const;
+    std::unique_ptr<Parser> createParser();
+    void writeAInstruction(std::ostream* outputStream, int& variableAddress, bool allowOverflowError);
+    void writeCInstruction(std::ostream* outputStream) const;
+
+    std::istream* mInputStream = nullptr;
+    std::ostream* mOutputStream = nullptr;
 
     std::unique_ptr<Parser> mParser;
     std::unique_ptr<SymbolTable> mSymbolTable = std::make_unique<SymbolTable>();
     std::string mInputFileName;
     std::string mOutputFileName;
 };
+}
@@ -2,7 +2,10 @@
 #include <stdexcept>
 #include <string>
 
+namespace assembler
+{
 class HackAssemblerError : public std::runtime_error
 {
     using std::runtime_error::runtime_error;
 };
+}
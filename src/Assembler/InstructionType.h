@@ -1,5 +1,7 @@
 #pragma once
 
+namespace assembler
+{
 enum class InstructionType
 {
     /// <summary>
@@ -23,3 +25,4 @@ enum class InstructionType
     /// </summary>
     COMMENT = 4
 };
+}
@@ -4,6 +4,8 @@
 
 using namespace std;
 
+namespace assembler
+{
 const char* const whitespace_chars = " \t\n\r\f\v";
 
 // trim from end of string (right)
@@ -67,9 +69,10 @@ void Parser::advance()
         return;
     }
 
-    std::regex a_regex("@[\\w.$:]+"); // A_INSTRUCTION for @xxx
-    std::regex c_regex("([ADM]{1,3}=)?([A-Z0-1-!+&|]{1,3})(;[A-Z]{1,3})?"); // C_INSTRUCTION for dest=comp;jump
-    std::regex l_regex("\\([\\w.$:]+\\)"); // L_INSTRUCTION for (xxx)
+    // compiled once, the construction is much slower than the matching
+    static const std::regex a_regex("@[\\w.$:]+"); // A_INSTRUCTION for @xxx
+    static const std::regex c_regex("([ADM]{1,3}=)?([A-Z0-1-!+&|]{1,3})(;[A-Z]{0,3})?"); // C_INSTRUCTION for dest=comp;jump, the jump may be empty
+    static const std::regex l_regex("\\([\\w.$:]+\\)"); // L_INSTRUCTION for (xxx)
     std::cmatch match;
 
     if (std::regex_match(mCurrentLine.c_str(), match, a_regex))
@@ -158,9 +161,19 @@ string Parser::jump() const
 /// </summary>
 Parser::Parser(const string& filename)
 {
-    mInputStream = make_unique<ifstream>(filename);
-    if (!mInputStream->is_open())
+    mInputFile = make_unique<ifstream>(filename);
+    if (!mInputFile->is_open())
     {
         throw HackAssemblerError("Cannot open " + filename + " file");
     }
+    mInputStream = mInputFile.get();
+}
+
+/// <summary>
+/// Gets ready to parse the stream from its current position.
+/// </summary>
+Parser::Parser(istream& inputStream)
+    : mInputStream(&inputStream)
+{
+}
 }
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <fstream>
+#include <istream>
+#include <memory>
 #include <string>
 #include "InstructionType.h"
 
+namespace assembler
+{
 /// <summary>
 /// The Parser encapsulates access to the input assembly code. In particular, it provides a convenient means for advancing through the source code,
 /// skipping comments and white space, and breaking each symbolic instruction into its underlying components.
@@ -56,9 +60,14 @@ public:
     /// Opens the input file/stream and gets ready to parse it.
     /// </summary>
     explicit Parser(const std::string& filename);
+    /// <summary>
+    /// Gets ready to parse the stream from its current position.
+    /// </summary>
+    explicit Parser(std::istream& inputStream);
 
 private:
-    std::unique_ptr<std::ifstream> mInputStream;
+    std::unique_ptr<std::ifstream> mInputFile;
+    std::istream* mInputStream = nullptr;
     std::string mCurrentLine = "";
     int mLineNumber = -1;
 
@@ -69,3 +78,4 @@ private:
     std::string mComp = "";
     std::string mJump = "";
 };
+}
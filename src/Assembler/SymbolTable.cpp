@@ -2,6 +2,8 @@
 
 using namespace std;
 
+namespace assembler
+{
 /// <summary>
 /// Adds <symbol,address> to the table.
 /// </summary>
@@ -62,3 +64,4 @@ SymbolTable::SymbolTable()
     addEntry(string("SCREEN"), 16384);
     addEntry(string("KBD"),    24576);
 }
+}
@@ -3,6 +3,8 @@
 #include <map>
 #include <string>
 
+namespace assembler
+{
 /// <summary>
 /// Resolves symbolic references into actual addresses
 /// </summary>
@@ -30,3 +32,4 @@ public:
 private:
     std::map<std::string, int, std::less<>> mSymbolTable;
 };
+}
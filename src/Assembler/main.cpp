@@ -26,7 +26,7 @@ int main(int argc, char* argv[])
 
     try
     {
-        auto hackAssembler = HackAssembler(argv[1]);
+        auto hackAssembler = assembler::HackAssembler(argv[1]);
         
         auto startTime = std::chrono::high_resolution_clock::now();
         hackAssembler.searchSymbols();
@@ -40,7 +40,7 @@ int main(int argc, char* argv[])
 
         return EXIT_SUCCESS;
     }
-    catch (const HackAssemblerError& error)
+    catch (const assembler::HackAssemblerError& error)
     {
         std::cout << error.what() << "\n";
         return EXIT_FAILURE;
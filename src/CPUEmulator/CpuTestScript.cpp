@@ -0,0 +1,177 @@
+#include <algorithm>
+#include "CpuTestScript.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Parses the .tst file. May throw TestScriptError.
+/// </summary>
+CpuTestScript::CpuTestScript(const fs::path& path)
+    : TestScript(path)
+{
+}
+
+/// <summary>
+/// Selects, whether repeat loops of ticktock commands run natively, they are batched by default.
+/// </summary>
+void CpuTestScript::setLoopBatching(bool isLoopBatching)
+{
+    mIsLoopBatching = isLoopBatching;
+}
+
+/// <summary>
+/// Replaces files loaded by the script with the machine instructions, e.g. translated from VM code in memory.
+/// </summary>
+void CpuTestScript::setProgram(vector<uint16_t> instructions)
+{
+    mProgram = std::move(instructions);
+}
+
+/// <summary>
+/// Returns the count of clock cycles executed by all loaded programs.
+/// </summary>
+long long CpuTestScript::getCycleCount() const
+{
+    return mCycleCount + (mComputer ? mComputer->getTime() : 0);
+}
+
+bool CpuTestScript::load(const Command& command)
+{
+    // the script is meant for the HardwareSimulator or the VMEmulator
+    auto extension = command.words.size() == 2 ? fs::path(command.words[1]).extension() : fs::path();
+    if (extension != ".asm" && extension != ".hack")
+    {
+        return false;
+    }
+
+    if (mComputer)
+    {
+        mCycleCount += mComputer->getTime();
+    }
+    mComputer = make_unique<HackComputer>();
+    if (mProgram)
+    {
+        mComputer->loadProgram(*mProgram);
+    }
+    else
+    {
+        mComputer->loadProgram(mPath.parent_path() / command.words[1]);
+    }
+    return true;
+}
+
+bool CpuTestScript::executeSimulatorCommand(const Command& command)
+{
+    if (command.words.size() != 1 || command.words[0] != "ticktock")
+    {
+        return false;
+    }
+    getComputer(command).run(1);
+    return true;
+}
+
+int CpuTestScript::readValue(const Command& command, const string& name, bool& isSigned) const
+{
+    auto& computer = getComputer(command);
+    isSigned = true;
+    if (name == "A")
+    {
+        return computer.getA();
+    }
+    if (name == "D")
+    {
+        return computer.getD();
+    }
+    if (name == "PC")
+    {
+        isSigned = false;
+        return computer.getPC();
+    }
+    if (name.rfind("RAM[", 0) == 0)
+    {
+        return computer.getRam(parseAddress(command, name, HackComputer::RAM_SIZE));
+    }
+    if (name.rfind("ROM[", 0) == 0)
+    {
+        return computer.getRom(parseAddress(command, name, HackComputer::ROM_SIZE));
+    }
+    fail(command, "Unknown variable " + name);
+}
+
+void CpuTestScript::writeValue(const Command& command, const string& name, int value)
+{
+    auto& computer = getComputer(command);
+    if (name == "A")
+    {
+        computer.setA(static_cast<int16_t>(value));
+    }
+    else if (name == "D")
+    {
+        computer.setD(static_cast<int16_t>(value));
+    }
+    else if (name == "PC")
+    {
+        computer.setPC(value);
+    }
+    else if (name.rfind("RAM[", 0) == 0)
+    {
+        computer.setRam(parseAddress(command, name, HackComputer::RAM_SIZE), static_cast<int16_t>(value));
+    }
+    else if (name.rfind("ROM[", 0) == 0)
+    {
+        computer.setRom(parseAddress(command, name, HackComputer::ROM_SIZE), static_cast<int16_t>(value));
+    }
+    else
+    {
+        fail(command, "Unknown variable " + name);
+    }
+}
+
+string CpuTestScript::getTime(const Command& command) const
+{
+    return to_string(getComputer(command).getTime());
+}
+
+/// <summary>
+/// Runs repeat loops of ticktock commands as one run of the computer.
+/// </summary>
+bool CpuTestScript::repeat(const Command& command, int count)
+{
+    bool isClockOnly = mIsLoopBatching && all_of(command.body.begin(), command.body.end(), [](const Command& bodyCommand)
+    {
+        return bodyCommand.body.empty() && bodyCommand.words.size() == 1 && bodyCommand.words[0] == "ticktock";
+    });
+    if (!isClockOnly)
+    {
+        return TestScript::repeat(command, count);
+    }
+    getComputer(command).run(static_cast<long long>(count) * static_cast<long long>(command.body.size()));
+    return true;
+}
+
+/// <summary>
+/// Parses the address of "RAM[address]" or "ROM[address]".
+/// </summary>
+int CpuTestScript::parseAddress(const Command& command, const string& name, int size) const
+{
+    if (name.back() != ']')
+    {
+        fail(command, "Expected '" + name.substr(0, 3) + "[address]', found '" + name + "'");
+    }
+    int address = parseNumber(command, name.substr(4, name.size() - 5));
+    if (address < 0 || address >= size)
+    {
+        fail(command, "Address of " + name + " is out of range");
+    }
+    return address;
+}
+
+HackComputer& CpuTestScript::getComputer(const Command& command) const
+{
+    if (!mComputer)
+    {
+        fail(command, "No program is loaded");
+    }
+    return *mComputer;
+}
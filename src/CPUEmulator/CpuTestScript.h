@@ -0,0 +1,52 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "HackComputer.h"
+#include "../HardwareSimulator/TestScript.h"
+
+/// <summary>
+/// CpuTestScript executes a .tst script of the CPUEmulator, scripts of other simulators are skipped.
+/// <para/> Variables are A, D, PC, RAM[address] and ROM[address]. Repeat loops containing only ticktock
+///     commands run in the native loop of the computer instead of interpreting every cycle.
+/// </summary>
+class CpuTestScript : public TestScript
+{
+public:
+    /// <summary>
+    /// Parses the .tst file. May throw TestScriptError.
+    /// </summary>
+    explicit CpuTestScript(const std::filesystem::path& path);
+
+    /// <summary>
+    /// Selects, whether repeat loops of ticktock commands run natively, they are batched by default.
+    /// </summary>
+    void setLoopBatching(bool isLoopBatching);
+    /// <summary>
+    /// Replaces files loaded by the script with the machine instructions, e.g. translated from VM code in memory.
+    /// </summary>
+    void setProgram(std::vector<uint16_t> instructions);
+
+    /// <summary>
+    /// Returns the count of clock cycles executed by all loaded programs.
+    /// </summary>
+    long long getCycleCount() const;
+
+private:
+    bool load(const Command& command) override;
+    bool executeSimulatorCommand(const Command& command) override;
+    int readValue(const Command& command, const std::string& name, bool& isSigned) const override;
+    void writeValue(const Command& command, const std::string& name, int value) override;
+    std::string getTime(const Command& command) const override;
+    bool repeat(const Command& command, int count) override;
+
+    int parseAddress(const Command& command, const std::string& name, int size) const;
+    HackComputer& getComputer(const Command& command) const;
+
+    std::unique_ptr<HackComputer> mComputer;
+    long long mCycleCount = 0;
+    bool mIsLoopBatching = true;
+    std::optional<std::vector<uint16_t>> mProgram;
+};
@@ -0,0 +1,318 @@
+#include <fstream>
+#include <sstream>
+#include "CPUEmulatorError.h"
+#include "HackComputer.h"
+#include "../Assembler/HackAssembler.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// computations "a c1 c2 c3 c4 c5 c6" of the Hack assembly language
+enum EComputation : uint8_t
+{
+    ZERO = 0b0101010,
+    ONE = 0b0111111,
+    MINUS_ONE = 0b0111010,
+    D = 0b0001100,
+    A = 0b0110000,
+    NOT_D = 0b0001101,
+    NOT_A = 0b0110001,
+    MINUS_D = 0b0001111,
+    MINUS_A = 0b0110011,
+    D_PLUS_ONE = 0b0011111,
+    A_PLUS_ONE = 0b0110111,
+    D_MINUS_ONE = 0b0001110,
+    A_MINUS_ONE = 0b0110010,
+    D_PLUS_A = 0b0000010,
+    D_MINUS_A = 0b0010011,
+    A_MINUS_D = 0b0000111,
+    D_AND_A = 0b0000000,
+    D_OR_A = 0b0010101,
+    M = 0b1110000,
+    NOT_M = 0b1110001,
+    MINUS_M = 0b1110011,
+    M_PLUS_ONE = 0b1110111,
+    M_MINUS_ONE = 0b1110010,
+    D_PLUS_M = 0b1000010,
+    D_MINUS_M = 0b1010011,
+    M_MINUS_D = 0b1000111,
+    D_AND_M = 0b1000000,
+    D_OR_M = 0b1010101,
+};
+
+// computations outside of the assembly language, e.g. from a hand-written .hack file, run through the whole ALU
+uint16_t computeAlu(uint8_t computation, uint16_t x, uint16_t y)
+{
+    bool zx = computation & 0b0100000;
+    bool nx = computation & 0b0010000;
+    bool zy = computation & 0b0001000;
+    bool ny = computation & 0b0000100;
+    bool f = computation & 0b0000010;
+    bool no = computation & 0b0000001;
+    x = zx ? 0 : x;
+    x = nx ? ~x : x;
+    y = zy ? 0 : y;
+    y = ny ? ~y : y;
+    uint16_t out = f ? x + y : x & y;
+    return no ? ~out : out;
+}
+
+vector<uint16_t> readMachineCode(istream& stream, const string& fileName)
+{
+    vector<uint16_t> instructions;
+    string line;
+    for (int lineNumber = 1; getline(stream, line); lineNumber++)
+    {
+        while (!line.empty() && isspace(static_cast<unsigned char>(line.back())))
+        {
+            line.pop_back();
+        }
+        if (line.empty())
+        {
+            continue;
+        }
+        if (line.size() != 16 || line.find_first_not_of("01") != string::npos)
+        {
+            throw CPUEmulatorError(fileName + ":" + to_string(lineNumber) + ": Expected 16 binary digits, found '" + line + "'.");
+        }
+        if (instructions.size() == HackComputer::ROM_SIZE)
+        {
+            throw CPUEmulatorError("Program " + fileName + " does not fit into ROM.");
+        }
+        instructions.push_back(static_cast<uint16_t>(stoi(line, nullptr, 2)));
+    }
+    return instructions;
+}
+
+HackComputer::HackComputer()
+    : mRom(ROM_SIZE),
+    mInstructions(ROM_SIZE),
+    mRam(RAM_SIZE)
+{
+}
+
+/// <summary>
+/// Loads the .hack file or assembles the .asm file into ROM and resets the computer.
+/// May throw CPUEmulatorError or HackAssemblerError.
+/// </summary>
+void HackComputer::loadProgram(const fs::path& path)
+{
+    ifstream file(path);
+    if (!file.is_open())
+    {
+        throw CPUEmulatorError("Cannot open " + path.string() + " file.");
+    }
+
+    if (path.extension() == ".asm")
+    {
+        loadProgram(assemble(file, path.filename().string()));
+    }
+    else
+    {
+        loadProgram(readMachineCode(file, path.filename().string()));
+    }
+}
+
+/// <summary>
+/// Loads machine instructions into ROM and resets the computer. May throw CPUEmulatorError.
+/// </summary>
+void HackComputer::loadProgram(const vector<uint16_t>& instructions)
+{
+    if (instructions.size() > ROM_SIZE)
+    {
+        throw CPUEmulatorError("Program does not fit into ROM.");
+    }
+    int instructionCount = static_cast<int>(instructions.size());
+    for (int address = 0; address < ROM_SIZE; address++)
+    {
+        setRom(address, static_cast<int16_t>(address < instructionCount ? instructions[address] : 0));
+    }
+    reset();
+}
+
+/// <summary>
+/// Translates the assembly code into machine instructions. May throw CPUEmulatorError or HackAssemblerError.
+/// </summary>
+vector<uint16_t> HackComputer::assemble(istream& assemblyCode, const string& fileName)
+{
+    stringstream machineCode;
+    auto hackAssembler = assembler::HackAssembler(assemblyCode, machineCode);
+    hackAssembler.searchSymbols();
+    hackAssembler.assemblerToMachineCode(true);
+    return readMachineCode(machineCode, fileName);
+}
+
+/// <summary>
+/// Clears RAM, registers and the time, ROM is kept.
+/// </summary>
+void HackComputer::reset()
+{
+    fill(mRam.begin(), mRam.end(), 0);
+    mA = 0;
+    mD = 0;
+    mPC = 0;
+    mTime = 0;
+}
+
+/// <summary>
+/// Executes instructions of cycleCount clock cycles.
+/// </summary>
+void HackComputer::run(long long cycleCount)
+{
+    // registers are kept in locals, so the compiler does not reload them after every RAM write
+    auto* ram = reinterpret_cast<uint16_t*>(mRam.data());
+    const auto* instructions = mInstructions.data();
+    uint16_t a = mA;
+    uint16_t d = mD;
+    uint16_t pc = mPC;
+
+    for (long long cycle = 0; cycle < cycleCount; cycle++)
+    {
+        const auto& instruction = instructions[pc];
+        if (instruction.isAddress)
+        {
+            a = instruction.value;
+            pc = (pc + 1) & (ROM_SIZE - 1);
+            continue;
+        }
+
+        auto& m = ram[a & (RAM_SIZE - 1)];
+        uint16_t out = 0;
+        switch (instruction.computation)
+        {
+        case ZERO: out = 0; break;
+        case ONE: out = 1; break;
+        case MINUS_ONE: out = 0xFFFF; break;
+        case D: out = d; break;
+        case A: out = a; break;
+        case NOT_D: out = ~d; break;
+        case NOT_A: out = ~a; break;
+        case MINUS_D: out = -d; break;
+        case MINUS_A: out = -a; break;
+        case D_PLUS_ONE: out = d + 1; break;
+        case A_PLUS_ONE: out = a + 1; break;
+        case D_MINUS_ONE: out = d - 1; break;
+        case A_MINUS_ONE: out = a - 1; break;
+        case D_PLUS_A: out = d + a; break;
+        case D_MINUS_A: out = d - a; break;
+        case A_MINUS_D: out = a - d; break;
+        case D_AND_A: out = d & a; break;
+        case D_OR_A: out = d | a; break;
+        case M: out = m; break;
+        case NOT_M: out = ~m; break;
+        case MINUS_M: out = -m; break;
+        case M_PLUS_ONE: out = m + 1; break;
+        case M_MINUS_ONE: out = m - 1; break;
+        case D_PLUS_M: out = d + m; break;
+        case D_MINUS_M: out = d - m; break;
+        case M_MINUS_D: out = m - d; break;
+        case D_AND_M: out = d & m; break;
+        case D_OR_M: out = d | m; break;
+        default:
+            out = computeAlu(instruction.computation, d, instruction.computation & 0b1000000 ? m : a);
+            break;
+        }
+
+        auto value = static_cast<int16_t>(out);
+        bool isJump = ((instruction.jump & 0b100) && value < 0) || ((instruction.jump & 0b010) && value == 0)
+            || ((instruction.jump & 0b001) && value > 0);
+        // the jump and M use the address before the write of A
+        pc = isJump ? a & (ROM_SIZE - 1) : (pc + 1) & (ROM_SIZE - 1);
+        if (instruction.writesM)
+        {
+            m = out;
+        }
+        if (instruction.writesA)
+        {
+            a = out;
+        }
+        if (instruction.writesD)
+        {
+            d = out;
+        }
+    }
+
+    mA = a;
+    mD = d;
+    mPC = pc;
+    mTime += cycleCount;
+}
+
+int16_t HackComputer::getRam(int address) const
+{
+    return mRam[address];
+}
+
+void HackComputer::setRam(int address, int16_t value)
+{
+    mRam[address] = value;
+}
+
+int16_t HackComputer::getRom(int address) const
+{
+    return static_cast<int16_t>(mRom[address]);
+}
+
+/// <summary>
+/// Writes the instruction into ROM.
+/// </summary>
+void HackComputer::setRom(int address, int16_t value)
+{
+    mRom[address] = static_cast<uint16_t>(value);
+    mInstructions[address] = decode(mRom[address]);
+}
+
+int16_t HackComputer::getA() const
+{
+    return static_cast<int16_t>(mA);
+}
+
+void HackComputer::setA(int16_t value)
+{
+    mA = static_cast<uint16_t>(value);
+}
+
+int16_t HackComputer::getD() const
+{
+    return static_cast<int16_t>(mD);
+}
+
+void HackComputer::setD(int16_t value)
+{
+    mD = static_cast<uint16_t>(value);
+}
+
+int HackComputer::getPC() const
+{
+    return mPC;
+}
+
+void HackComputer::setPC(int value)
+{
+    mPC = static_cast<uint16_t>(value & (ROM_SIZE - 1));
+}
+
+/// <summary>
+/// Returns the count of executed clock cycles.
+/// </summary>
+long long HackComputer::getTime() const
+{
+    return mTime;
+}
+
+HackComputer::Instruction HackComputer::decode(uint16_t value)
+{
+    Instruction instruction;
+    instruction.isAddress = (value & 0x8000) == 0;
+    instruction.value = value;
+    if (!instruction.isAddress)
+    {
+        // "1 1 1 a c1 c2 c3 c4 c5 c6 d1 d2 d3 j1 j2 j3"
+        instruction.computation = (value >> 6) & 0b1111111;
+        instruction.writesA = value & 0b100000;
+        instruction.writesD = value & 0b010000;
+        instruction.writesM = value & 0b001000;
+        instruction.jump = value & 0b111;
+    }
+    return instruction;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// HackComputer emulates the Hack computer: the CPU, 32K words of ROM and 32K words of RAM
+///     with the screen memory map at 16384 and the keyboard at 24576.
+/// <para/> Loaded instructions are decoded once, every cycle only dispatches the computation
+///     of the decoded C-instruction.
+/// </summary>
+class HackComputer
+{
+public:
+    static constexpr int ROM_SIZE = 32768;
+    static constexpr int RAM_SIZE = 32768;
+    static constexpr int SCREEN_ADDRESS = 16384;
+    static constexpr int KEYBOARD_ADDRESS = 24576;
+
+    HackComputer();
+
+    /// <summary>
+    /// Loads the .hack file or assembles the .asm file into ROM and resets the computer.
+    /// May throw CPUEmulatorError or HackAssemblerError.
+    /// </summary>
+    void loadProgram(const std::filesystem::path& path);
+    /// <summary>
+    /// Loads machine instructions into ROM and resets the computer. May throw CPUEmulatorError.
+    /// </summary>
+    void loadProgram(const std::vector<uint16_t>& instructions);
+    /// <summary>
+    /// Translates the assembly code into machine instructions. May throw CPUEmulatorError or HackAssemblerError.
+    /// </summary>
+    static std::vector<uint16_t> assemble(std::istream& assemblyCode, const std::string& fileName);
+    /// <summary>
+    /// Clears RAM, registers and the time, ROM is kept.
+    /// </summary>
+    void reset();
+    /// <summary>
+    /// Executes instructions of cycleCount clock cycles.
+    /// </summary>
+    void run(long long cycleCount);
+
+    int16_t getRam(int address) const;
+    void setRam(int address, int16_t value);
+    int16_t getRom(int address) const;
+    /// <summary>
+    /// Writes the instruction into ROM.
+    /// </summary>
+    void setRom(int address, int16_t value);
+    int16_t getA() const;
+    void setA(int16_t value);
+    int16_t getD() const;
+    void setD(int16_t value);
+    int getPC() const;
+    void setPC(int value);
+    /// <summary>
+    /// Returns the count of executed clock cycles.
+    /// </summary>
+    long long getTime() const;
+
+private:
+    struct Instruction
+    {
+        // A-instruction or the computation of the C-instruction "a c1 c2 c3 c4 c5 c6"
+        bool isAddress = true;
+        uint16_t value = 0;
+        uint8_t computation = 0;
+        bool writesA = false;
+        bool writesD = false;
+        bool writesM = false;
+        // jump bits "j1 j2 j3", i.e. out < 0, out == 0, out > 0
+        uint8_t jump = 0;
+    };
+
+    static Instruction decode(uint16_t value);
+
+    std::vector<uint16_t> mRom;
+    std::vector<Instruction> mInstructions;
+    std::vector<int16_t> mRam;
+    uint16_t mA = 0;
+    uint16_t mD = 0;
+    uint16_t mPC = 0;
+    long long mTime = 0;
+};
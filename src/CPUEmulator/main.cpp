@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "CPUEmulatorError.h"
+#include "CpuTestScript.h"
+#include "../Assembler/HackAssemblerError.h"
+#include "../HardwareSimulator/TestScriptError.h"
+
+namespace fs = std::filesystem;
+
+std::vector<fs::path> findScripts(const std::vector<fs::path>& inputPaths);
+bool runScripts(const std::vector<fs::path>& scriptPaths, bool isLoopBatching);
+const char* getResultName(ETestResult result);
+void printSpeed(long long cycleCount, double milliseconds);
+
+int main(int argc, char* argv[])
+{
+    bool isLoopBatching = true;
+    std::vector<fs::path> inputPaths;
+    bool validArguments = argc >= 2;
+    for (int i = 1; i < argc && validArguments; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--no-batching")
+        {
+            isLoopBatching = false;
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            validArguments = false;
+        }
+        else
+        {
+            inputPaths.emplace_back(arg);
+        }
+    }
+
+    if (!validArguments || inputPaths.empty())
+    {
+        std::cout << "Usage: \n"
+            << "\tCPUEmulator Script.tst|Directory... [--no-batching]\n"
+            << "\t--no-batching: interprets every ticktock command of repeat loops instead of running them natively\n";
+        return EXIT_FAILURE;
+    }
+
+    return runScripts(findScripts(inputPaths), isLoopBatching) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// <summary>
+/// Replaces directories with their .tst files.
+/// </summary>
+std::vector<fs::path> findScripts(const std::vector<fs::path>& inputPaths)
+{
+    std::vector<fs::path> paths;
+    for (const auto& inputPath : inputPaths)
+    {
+        if (!fs::is_directory(inputPath))
+        {
+            paths.push_back(inputPath);
+            continue;
+        }
+
+        std::vector<fs::path> directoryPaths;
+        for (const auto& entry : fs::directory_iterator(inputPath))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".tst")
+            {
+                directoryPaths.push_back(entry.path());
+            }
+        }
+        std::sort(directoryPaths.begin(), directoryPaths.end());
+        paths.insert(paths.end(), directoryPaths.begin(), directoryPaths.end());
+    }
+    return paths;
+}
+
+bool runScripts(const std::vector<fs::path>& scriptPaths, bool isLoopBatching)
+{
+    int passedCount = 0;
+    int failedCount = 0;
+    int skippedCount = 0;
+    long long totalCycleCount = 0;
+    double totalMilliseconds = 0;
+    for (const auto& path : scriptPaths)
+    {
+        auto result = ETestResult::FAILED;
+        std::string message;
+        int outputCount = 0;
+        long long cycleCount = 0;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            auto script = CpuTestScript(path);
+            script.setLoopBatching(isLoopBatching);
+            result = script.run();
+            message = script.getMessage();
+            outputCount = script.getOutputCount();
+            cycleCount = script.getCycleCount();
+        }
+        catch (const TestScriptError& error)
+        {
+            message = error.what();
+        }
+        catch (const CPUEmulatorError& error)
+        {
+            message = error.what();
+        }
+        catch (const assembler::HackAssemblerError& error)
+        {
+            message = error.what();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        std::cout << std::left << std::setw(8) << getResultName(result) << path.string();
+        if (result == ETestResult::SKIPPED)
+        {
+            std::cout << " (not a CPU test)\n";
+            skippedCount++;
+            continue;
+        }
+        std::cout << ": " << outputCount << " outputs, ";
+        printSpeed(cycleCount, milliseconds);
+        if (!message.empty())
+        {
+            std::cout << "\t" << message << "\n";
+        }
+
+        passedCount += result == ETestResult::PASSED;
+        failedCount += result != ETestResult::PASSED;
+        totalCycleCount += cycleCount;
+        totalMilliseconds += milliseconds;
+    }
+
+    std::cout << "\nPassed " << passedCount << ", failed " << failedCount << ", skipped " << skippedCount << " scripts.\nExecuted ";
+    printSpeed(totalCycleCount, totalMilliseconds);
+    return failedCount == 0;
+}
+
+const char* getResultName(ETestResult result)
+{
+    switch (result)
+    {
+    case ETestResult::PASSED:
+        return "PASSED";
+    case ETestResult::SKIPPED:
+        return "SKIPPED";
+    default:
+        return "FAILED";
+    }
+}
+
+void printSpeed(long long cycleCount, double milliseconds)
+{
+    std::cout << cycleCount << " clock cycles in " << std::fixed << std::setprecision(1) << milliseconds << " ms";
+    if (milliseconds > 0)
+    {
+        std::cout << " (" << std::setprecision(0) << cycleCount / milliseconds * 1000 << " cycles/s)";
+    }
+    std::cout << "\n";
+}
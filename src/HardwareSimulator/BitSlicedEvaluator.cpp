@@ -0,0 +1,118 @@
+#include <algorithm>
+#include "BitSlicedEvaluator.h"
+#include "HardwareSimulatorError.h"
+
+using namespace std;
+
+/// <summary>
+/// Creates BitSlicedEvaluator. May throw HardwareSimulatorError, if the netlist has a part with a state.
+/// </summary>
+BitSlicedEvaluator::BitSlicedEvaluator(const Netlist& netlist)
+    : mNetlist(netlist),
+    mValues(static_cast<size_t>(netlist.wireCount) * WORD_COUNT, 0)
+{
+    for (const auto& component : netlist.components)
+    {
+        if (component.chip->isClocked() || component.chip->getStateSize() > 0)
+        {
+            throw HardwareSimulatorError("Chip " + netlist.chip.name + " is not combinational, it uses " + component.chipName + " part.");
+        }
+    }
+    fill_n(mValues.begin() + Netlist::TRUE_WIRE * WORD_COUNT, WORD_COUNT, ~0ULL);
+}
+
+/// <summary>
+/// Sets values of the input pin in all lanes.
+/// </summary>
+/// <param name="values">LANE_COUNT values</param>
+void BitSlicedEvaluator::setInput(const string& pinName, const uint16_t* values)
+{
+    const auto& wires = mNetlist.pins.at(pinName);
+    for (size_t bit = 0; bit < wires.size(); bit++)
+    {
+        auto* words = &mValues[static_cast<size_t>(wires[bit]) * WORD_COUNT];
+        for (int word = 0; word < WORD_COUNT; word++)
+        {
+            uint64_t value = 0;
+            for (int lane = 0; lane < 64; lane++)
+            {
+                value |= static_cast<uint64_t>((values[word * 64 + lane] >> bit) & 1) << lane;
+            }
+            words[word] = value;
+        }
+    }
+}
+
+/// <summary>
+/// Propagates inputs of all lanes through the netlist.
+/// </summary>
+void BitSlicedEvaluator::evaluate()
+{
+    auto* values = mValues.data();
+    for (const auto& node : mNetlist.order)
+    {
+        if (!node.isGate)
+        {
+            evaluateComponent(mNetlist.components[node.index]);
+            continue;
+        }
+
+        const auto& gate = mNetlist.gates[node.index];
+        const auto* a = values + static_cast<size_t>(gate.a) * WORD_COUNT;
+        const auto* b = values + static_cast<size_t>(gate.b) * WORD_COUNT;
+        auto* out = values + static_cast<size_t>(gate.out) * WORD_COUNT;
+        for (int word = 0; word < WORD_COUNT; word++)
+        {
+            out[word] = ~(a[word] & b[word]);
+        }
+    }
+}
+
+/// <summary>
+/// Reads values of the pin in all lanes.
+/// </summary>
+/// <param name="values">Buffer for LANE_COUNT values</param>
+void BitSlicedEvaluator::getOutput(const string& pinName, uint16_t* values) const
+{
+    const auto& wires = mNetlist.pins.at(pinName);
+    fill_n(values, LANE_COUNT, static_cast<uint16_t>(0));
+    for (size_t bit = 0; bit < wires.size(); bit++)
+    {
+        const auto* words = &mValues[static_cast<size_t>(wires[bit]) * WORD_COUNT];
+        for (int lane = 0; lane < LANE_COUNT; lane++)
+        {
+            values[lane] |= static_cast<uint16_t>(((words[lane / 64] >> (lane % 64)) & 1) << bit);
+        }
+    }
+}
+
+void BitSlicedEvaluator::evaluateComponent(const Netlist::Component& component)
+{
+    vector<uint16_t> inputs(component.inputs.size());
+    vector<uint16_t> outputs(component.outputs.size());
+    for (int lane = 0; lane < LANE_COUNT; lane++)
+    {
+        int word = lane / 64;
+        int shift = lane % 64;
+        for (size_t pin = 0; pin < inputs.size(); pin++)
+        {
+            const auto& wires = component.inputs[pin];
+            inputs[pin] = 0;
+            for (size_t bit = 0; bit < wires.size(); bit++)
+            {
+                inputs[pin] |= static_cast<uint16_t>(((mValues[static_cast<size_t>(wires[bit]) * WORD_COUNT + word] >> shift) & 1) << bit);
+            }
+        }
+
+        component.chip->evaluate(inputs.data(), outputs.data());
+        for (size_t pin = 0; pin < outputs.size(); pin++)
+        {
+            const auto& wires = component.outputs[pin];
+            for (size_t bit = 0; bit < wires.size(); bit++)
+            {
+                auto& value = mValues[static_cast<size_t>(wires[bit]) * WORD_COUNT + word];
+                value = (value & ~(1ULL << shift)) | (static_cast<uint64_t>((outputs[pin] >> bit) & 1) << shift);
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Netlist.h"
+
+/// <summary>
+/// BitSlicedEvaluator evaluates a combinational netlist for many independent input vectors at once.
+/// <para/> Every wire holds one bit of LANE_COUNT vectors in WORD_COUNT 64-bit words, so a Nand gate computes
+///     all vectors by a few word operations. The loop over the words of a wire is vectorized by the compiler.
+/// <para/> Built-in components are evaluated separately for every vector.
+/// </summary>
+class BitSlicedEvaluator
+{
+public:
+    static constexpr int WORD_COUNT = 4;
+    static constexpr int LANE_COUNT = 64 * WORD_COUNT;
+
+    /// <summary>
+    /// Creates BitSlicedEvaluator. May throw HardwareSimulatorError, if the netlist has a part with a state.
+    /// </summary>
+    explicit BitSlicedEvaluator(const Netlist& netlist);
+
+    /// <summary>
+    /// Sets values of the input pin in all lanes.
+    /// </summary>
+    /// <param name="values">LANE_COUNT values</param>
+    void setInput(const std::string& pinName, const uint16_t* values);
+    /// <summary>
+    /// Propagates inputs of all lanes through the netlist.
+    /// </summary>
+    void evaluate();
+    /// <summary>
+    /// Reads values of the pin in all lanes.
+    /// </summary>
+    /// <param name="values">Buffer for LANE_COUNT values</param>
+    void getOutput(const std::string& pinName, uint16_t* values) const;
+
+private:
+    void evaluateComponent(const Netlist::Component& component);
+
+    const Netlist& mNetlist;
+    // WORD_COUNT words of every wire
+    std::vector<uint64_t> mValues;
+};
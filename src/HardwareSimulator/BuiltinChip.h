@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+
+/// <summary>
+/// Chip implemented by the simulator. Values of pins are passed in the order of the declaration.
+/// <para/> Clocked chips read their inputs at the rising edge of the clock (tick) and change the state
+///     and the outputs at the falling edge (tock).
+/// </summary>
+class BuiltinChip
+{
+public:
+    virtual ~BuiltinChip() = default;
+
+    /// <summary>
+    /// Computes the outputs from the inputs and the state.
+    /// </summary>
+    virtual void evaluate(const uint16_t* inputs, uint16_t* outputs) = 0;
+    virtual bool isClocked() const
+    {
+        return false;
+    }
+    /// <summary>
+    /// Reads the inputs at the rising edge of the clock.
+    /// </summary>
+    virtual void clockUp(const uint16_t* /*inputs*/)
+    {
+    }
+    /// <summary>
+    /// Changes the state at the falling edge of the clock. Returns whether the outputs may have changed.
+    /// </summary>
+    virtual bool clockDown()
+    {
+        return false;
+    }
+    /// <summary>
+    /// Returns whether a clock cycle with the same inputs as the previous one keeps the state.
+    /// <para/> The event-driven simulation does not clock such chips until their inputs or state change.
+    /// </summary>
+    virtual bool keepsStateForSameInputs() const
+    {
+        return false;
+    }
+
+    /// <summary>
+    /// Count of the words of the state, test scripts access them as "Name[index]" and the first one also as "Name[]".
+    /// </summary>
+    virtual int getStateSize() const
+    {
+        return 0;
+    }
+    virtual int16_t getState(int /*index*/) const
+    {
+        return 0;
+    }
+    virtual void setState(int /*index*/, int16_t /*value*/)
+    {
+    }
+    /// <summary>
+    /// Loads the contents of the chip from the file, e.g. "ROM32K load Max.hack". May throw HardwareSimulatorError.
+    /// </summary>
+    virtual void load(const std::filesystem::path& path);
+};
@@ -0,0 +1,424 @@
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include "BuiltinChips.h"
+#include "HardwareSimulatorError.h"
+#include "HdlParser.h"
+
+using namespace std;
+
+// the same declarations as in tools/builtInChips
+const char* const BUILTIN_CHIPS_HDL[] = {
+    "CHIP Nand { IN a, b; OUT out; BUILTIN Nand; }",
+    "CHIP Not { IN in; OUT out; BUILTIN Not; }",
+    "CHIP And { IN a, b; OUT out; BUILTIN And; }",
+    "CHIP Or { IN a, b; OUT out; BUILTIN Or; }",
+    "CHIP Xor { IN a, b; OUT out; BUILTIN Xor; }",
+    "CHIP Mux { IN a, b, sel; OUT out; BUILTIN Mux; }",
+    "CHIP DMux { IN in, sel; OUT a, b; BUILTIN DMux; }",
+    "CHIP Not16 { IN in[16]; OUT out[16]; BUILTIN Not16; }",
+    "CHIP And16 { IN a[16], b[16]; OUT out[16]; BUILTIN And; }",
+    "CHIP Or16 { IN a[16], b[16]; OUT out[16]; BUILTIN Or; }",
+    "CHIP Mux16 { IN a[16], b[16], sel; OUT out[16]; BUILTIN Mux; }",
+    "CHIP Or8Way { IN in[8]; OUT out; BUILTIN Or8Way; }",
+    "CHIP Mux4Way16 { IN a[16], b[16], c[16], d[16], sel[2]; OUT out[16]; BUILTIN Mux4Way16; }",
+    "CHIP Mux8Way16 { IN a[16], b[16], c[16], d[16], e[16], f[16], g[16], h[16], sel[3]; OUT out[16]; BUILTIN Mux8Way16; }",
+    "CHIP DMux4Way { IN in, sel[2]; OUT a, b, c, d; BUILTIN DMux4Way; }",
+    "CHIP DMux8Way { IN in, sel[3]; OUT a, b, c, d, e, f, g, h; BUILTIN DMux8Way; }",
+    "CHIP HalfAdder { IN a, b; OUT sum, carry; BUILTIN HalfAdder; }",
+    "CHIP FullAdder { IN a, b, c; OUT sum, carry; BUILTIN FullAdder; }",
+    "CHIP Add16 { IN a[16], b[16]; OUT out[16]; BUILTIN Add16; }",
+    "CHIP Inc16 { IN in[16]; OUT out[16]; BUILTIN Inc16; }",
+    "CHIP ALU { IN x[16], y[16], zx, nx, zy, ny, f, no; OUT out[16], zr, ng; BUILTIN ALU; }",
+    "CHIP DFF { IN in; OUT out; BUILTIN DFF; CLOCKED in; }",
+    "CHIP Bit { IN in, load; OUT out; BUILTIN Bit; CLOCKED in, load; }",
+    "CHIP Register { IN in[16], load; OUT out[16]; BUILTIN Register; CLOCKED in, load; }",
+    "CHIP ARegister { IN in[16], load; OUT out[16]; BUILTIN ARegister; CLOCKED in, load; }",
+    "CHIP DRegister { IN in[16], load; OUT out[16]; BUILTIN DRegister; CLOCKED in, load; }",
+    "CHIP PC { IN in[16], load, inc, reset; OUT out[16]; BUILTIN PC; CLOCKED in, load, inc, reset; }",
+    "CHIP RAM8 { IN in[16], load, address[3]; OUT out[16]; BUILTIN RAM8; CLOCKED in, load; }",
+    "CHIP RAM64 { IN in[16], load, address[6]; OUT out[16]; BUILTIN RAM64; CLOCKED in, load; }",
+    "CHIP RAM512 { IN in[16], load, address[9]; OUT out[16]; BUILTIN RAM512; CLOCKED in, load; }",
+    "CHIP RAM4K { IN in[16], load, address[12]; OUT out[16]; BUILTIN RAM4K; CLOCKED in, load; }",
+    "CHIP RAM16K { IN in[16], load, address[14]; OUT out[16]; BUILTIN RAM16K; CLOCKED in, load; }",
+    "CHIP Screen { IN in[16], load, address[13]; OUT out[16]; BUILTIN Screen; CLOCKED in, load; }",
+    "CHIP Keyboard { OUT out[16]; BUILTIN Keyboard; }",
+    "CHIP ROM32K { IN address[15]; OUT out[16]; BUILTIN ROM32K; }",
+};
+
+#pragma region Implementations
+/// <summary>
+/// Combinational chip computing the outputs by a function.
+/// </summary>
+class LogicChip : public BuiltinChip
+{
+public:
+    using Function = void (*)(const uint16_t* inputs, uint16_t* outputs);
+
+    explicit LogicChip(Function function)
+        : mFunction(function)
+    {
+    }
+
+    void evaluate(const uint16_t* inputs, uint16_t* outputs) override
+    {
+        mFunction(inputs, outputs);
+    }
+
+private:
+    Function mFunction;
+};
+
+/// <summary>
+/// DFF, Bit, Register, ARegister and DRegister. DFF has no load input.
+/// </summary>
+class RegisterChip : public BuiltinChip
+{
+public:
+    explicit RegisterChip(bool hasLoad)
+        : mHasLoad(hasLoad)
+    {
+    }
+
+    void evaluate(const uint16_t* /*inputs*/, uint16_t* outputs) override
+    {
+        outputs[0] = mValue;
+    }
+    bool isClocked() const override
+    {
+        return true;
+    }
+    void clockUp(const uint16_t* inputs) override
+    {
+        mNextValue = !mHasLoad || inputs[1] ? inputs[0] : mValue;
+    }
+    bool keepsStateForSameInputs() const override
+    {
+        return true;
+    }
+    bool clockDown() override
+    {
+        bool isChanged = mValue != mNextValue;
+        mValue = mNextValue;
+        return isChanged;
+    }
+
+    int getStateSize() const override
+    {
+        return 1;
+    }
+    int16_t getState(int /*index*/) const override
+    {
+        // the state changes at the rising edge, the output follows at the falling edge
+        return static_cast<int16_t>(mNextValue);
+    }
+    void setState(int /*index*/, int16_t value) override
+    {
+        mValue = static_cast<uint16_t>(value);
+        mNextValue = mValue;
+    }
+
+private:
+    bool mHasLoad;
+    uint16_t mValue = 0;
+    uint16_t mNextValue = 0;
+};
+
+class PCChip : public BuiltinChip
+{
+public:
+    void evaluate(const uint16_t* /*inputs*/, uint16_t* outputs) override
+    {
+        outputs[0] = mValue;
+    }
+    bool isClocked() const override
+    {
+        return true;
+    }
+    void clockUp(const uint16_t* inputs) override
+    {
+        // in, load, inc, reset
+        if (inputs[3])
+        {
+            mNextValue = 0;
+        }
+        else if (inputs[1])
+        {
+            mNextValue = inputs[0];
+        }
+        else if (inputs[2])
+        {
+            mNextValue = static_cast<uint16_t>(mValue + 1);
+        }
+        else
+        {
+            mNextValue = mValue;
+        }
+    }
+    bool clockDown() override
+    {
+        bool isChanged = mValue != mNextValue;
+        mValue = mNextValue;
+        return isChanged;
+    }
+
+    int getStateSize() const override
+    {
+        return 1;
+    }
+    int16_t getState(int /*index*/) const override
+    {
+        return static_cast<int16_t>(mNextValue);
+    }
+    void setState(int /*index*/, int16_t value) override
+    {
+        mValue = static_cast<uint16_t>(value);
+        mNextValue = mValue;
+    }
+
+private:
+    uint16_t mValue = 0;
+    uint16_t mNextValue = 0;
+};
+
+/// <summary>
+/// RAM8 - RAM16K and Screen. The output is read combinationally, the memory is written at the falling edge.
+/// </summary>
+class MemoryChip : public BuiltinChip
+{
+public:
+    explicit MemoryChip(int size)
+        : mMemory(size)
+    {
+    }
+
+    void evaluate(const uint16_t* inputs, uint16_t* outputs) override
+    {
+        // in, load, address
+        outputs[0] = mMemory[inputs[2]];
+    }
+    bool isClocked() const override
+    {
+        return true;
+    }
+    void clockUp(const uint16_t* inputs) override
+    {
+        mIsWritePending = inputs[1] != 0;
+        mPendingValue = inputs[0];
+        mPendingAddress = inputs[2];
+    }
+    bool clockDown() override
+    {
+        if (!mIsWritePending)
+        {
+            return false;
+        }
+        bool isChanged = mMemory[mPendingAddress] != mPendingValue;
+        mMemory[mPendingAddress] = mPendingValue;
+        mIsWritePending = false;
+        return isChanged;
+    }
+    bool keepsStateForSameInputs() const override
+    {
+        return true;
+    }
+
+    int getStateSize() const override
+    {
+        return static_cast<int>(mMemory.size());
+    }
+    int16_t getState(int index) const override
+    {
+        return static_cast<int16_t>(mMemory[index]);
+    }
+    void setState(int index, int16_t value) override
+    {
+        mMemory[index] = static_cast<uint16_t>(value);
+    }
+
+private:
+    vector<uint16_t> mMemory;
+    bool mIsWritePending = false;
+    uint16_t mPendingValue = 0;
+    uint16_t mPendingAddress = 0;
+};
+
+class ROMChip : public BuiltinChip
+{
+public:
+    ROMChip()
+        : mMemory(32768)
+    {
+    }
+
+    void evaluate(const uint16_t* inputs, uint16_t* outputs) override
+    {
+        outputs[0] = mMemory[inputs[0]];
+    }
+
+    int getStateSize() const override
+    {
+        return static_cast<int>(mMemory.size());
+    }
+    int16_t getState(int index) const override
+    {
+        return static_cast<int16_t>(mMemory[index]);
+    }
+    void setState(int index, int16_t value) override
+    {
+        mMemory[index] = static_cast<uint16_t>(value);
+    }
+    void load(const filesystem::path& path) override
+    {
+        ifstream file(path);
+        if (!file.is_open())
+        {
+            throw HardwareSimulatorError("Cannot open " + path.string() + " file.");
+        }
+
+        fill(mMemory.begin(), mMemory.end(), static_cast<uint16_t>(0));
+        size_t address = 0;
+        string line;
+        while (getline(file, line))
+        {
+            while (!line.empty() && isspace(static_cast<unsigned char>(line.back())))
+            {
+                line.pop_back();
+            }
+            if (line.empty())
+            {
+                continue;
+            }
+            if (line.size() != 16 || line.find_first_not_of("01") != string::npos || address >= mMemory.size())
+            {
+                throw HardwareSimulatorError("Invalid instruction '" + line + "' in " + path.string() + " file.");
+            }
+            mMemory[address++] = static_cast<uint16_t>(stoi(line, nullptr, 2));
+        }
+    }
+
+private:
+    vector<uint16_t> mMemory;
+};
+
+class KeyboardChip : public BuiltinChip
+{
+public:
+    void evaluate(const uint16_t* /*inputs*/, uint16_t* outputs) override
+    {
+        outputs[0] = mKey;
+    }
+
+    int getStateSize() const override
+    {
+        return 1;
+    }
+    int16_t getState(int /*index*/) const override
+    {
+        return static_cast<int16_t>(mKey);
+    }
+    void setState(int /*index*/, int16_t value) override
+    {
+        mKey = static_cast<uint16_t>(value);
+    }
+
+private:
+    uint16_t mKey = 0;
+};
+
+uint16_t computeALU(const uint16_t* inputs)
+{
+    // x, y, zx, nx, zy, ny, f, no
+    uint16_t x = inputs[2] ? 0 : inputs[0];
+    x = inputs[3] ? ~x : x;
+    uint16_t y = inputs[4] ? 0 : inputs[1];
+    y = inputs[5] ? ~y : y;
+    uint16_t out = inputs[6] ? x + y : x & y;
+    return inputs[7] ? ~out : out;
+}
+
+const unordered_map<string, LogicChip::Function> LOGIC_FUNCTIONS = {
+    { "Nand", [](const uint16_t* in, uint16_t* out) { out[0] = ~(in[0] & in[1]); } },
+    { "Not", [](const uint16_t* in, uint16_t* out) { out[0] = ~in[0]; } },
+    { "Not16", [](const uint16_t* in, uint16_t* out) { out[0] = ~in[0]; } },
+    { "And", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] & in[1]; } },
+    { "Or", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] | in[1]; } },
+    { "Xor", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] ^ in[1]; } },
+    { "Mux", [](const uint16_t* in, uint16_t* out) { out[0] = in[2] ? in[1] : in[0]; } },
+    { "DMux", [](const uint16_t* in, uint16_t* out) { out[0] = in[1] ? 0 : in[0]; out[1] = in[1] ? in[0] : 0; } },
+    { "Or8Way", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] != 0; } },
+    { "Mux4Way16", [](const uint16_t* in, uint16_t* out) { out[0] = in[in[4] & 3]; } },
+    { "Mux8Way16", [](const uint16_t* in, uint16_t* out) { out[0] = in[in[8] & 7]; } },
+    { "DMux4Way", [](const uint16_t* in, uint16_t* out) { for (int i = 0; i < 4; i++) out[i] = (in[1] & 3) == i ? in[0] : 0; } },
+    { "DMux8Way", [](const uint16_t* in, uint16_t* out) { for (int i = 0; i < 8; i++) out[i] = (in[1] & 7) == i ? in[0] : 0; } },
+    { "HalfAdder", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] ^ in[1]; out[1] = in[0] & in[1]; } },
+    { "FullAdder", [](const uint16_t* in, uint16_t* out) { int sum = in[0] + in[1] + in[2]; out[0] = sum & 1; out[1] = sum >> 1; } },
+    { "Add16", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] + in[1]; } },
+    { "Inc16", [](const uint16_t* in, uint16_t* out) { out[0] = in[0] + 1; } },
+    { "ALU", [](const uint16_t* in, uint16_t* out) { out[0] = computeALU(in); out[1] = out[0] == 0; out[2] = out[0] >> 15; } },
+};
+#pragma endregion
+
+void BuiltinChip::load(const filesystem::path& path)
+{
+    throw HardwareSimulatorError("Chip cannot load " + path.string() + " file.");
+}
+
+/// <summary>
+/// Returns the declaration of the built-in chip or nullptr, if there is no such chip.
+/// </summary>
+const ChipDeclaration* BuiltinChips::findDeclaration(const string& chipName)
+{
+    static const auto declarations = []
+    {
+        unordered_map<string, ChipDeclaration> chips;
+        for (const char* hdl : BUILTIN_CHIPS_HDL)
+        {
+            istringstream stream(hdl);
+            auto chip = HdlParser::parse(stream, "<built-in>");
+            chips.emplace(chip.name, std::move(chip));
+        }
+        return chips;
+    }();
+
+    auto it = declarations.find(chipName);
+    return it == declarations.end() ? nullptr : &it->second;
+}
+
+/// <summary>
+/// Creates the implementation named by the BUILTIN statement of the declaration. May throw HardwareSimulatorError.
+/// </summary>
+unique_ptr<BuiltinChip> BuiltinChips::create(const ChipDeclaration& declaration)
+{
+    const auto& name = declaration.builtinName;
+    if (auto it = LOGIC_FUNCTIONS.find(name); it != LOGIC_FUNCTIONS.end())
+    {
+        return make_unique<LogicChip>(it->second);
+    }
+    if (name == "DFF" || name == "Bit" || name == "Register" || name == "ARegister" || name == "DRegister")
+    {
+        return make_unique<RegisterChip>(name != "DFF");
+    }
+    if (name == "PC")
+    {
+        return make_unique<PCChip>();
+    }
+
+    static const unordered_map<string, int> MEMORY_SIZES = {
+        { "RAM8", 8 }, { "RAM64", 64 }, { "RAM512", 512 }, { "RAM4K", 4096 }, { "RAM16K", 16384 }, { "Screen", 8192 }
+    };
+    if (auto it = MEMORY_SIZES.find(name); it != MEMORY_SIZES.end())
+    {
+        return make_unique<MemoryChip>(it->second);
+    }
+    if (name == "ROM32K")
+    {
+        return make_unique<ROMChip>();
+    }
+    if (name == "Keyboard")
+    {
+        return make_unique<KeyboardChip>();
+    }
+    throw HardwareSimulatorError("Chip " + declaration.name + " uses unknown built-in implementation " + name + ".");
+}
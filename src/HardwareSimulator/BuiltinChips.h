@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "BuiltinChip.h"
+#include "ChipDeclaration.h"
+
+/// <summary>
+/// Built-in chips of the simulator, they have the same pins as the chips in tools/builtInChips.
+/// </summary>
+class BuiltinChips
+{
+public:
+    /// <summary>
+    /// Returns the declaration of the built-in chip or nullptr, if there is no such chip.
+    /// </summary>
+    static const ChipDeclaration* findDeclaration(const std::string& chipName);
+    /// <summary>
+    /// Creates the implementation named by the BUILTIN statement of the declaration. May throw HardwareSimulatorError.
+    /// </summary>
+    static std::unique_ptr<BuiltinChip> create(const ChipDeclaration& declaration);
+};
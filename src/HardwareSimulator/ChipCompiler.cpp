@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <sstream>
+#include "ChipCompiler.h"
+#include "CompiledChips.h"
+
+using namespace std;
+
+string getMask(size_t width)
+{
+    ostringstream mask;
+    mask << "0x" << hex << uppercase << ((1U << width) - 1);
+    return mask.str();
+}
+
+/// <summary>
+/// Writes a .cpp file with the evaluate function and the registration of every netlist.
+/// </summary>
+void ChipCompiler::write(const vector<Netlist>& netlists, ostream& stream)
+{
+    stream << "// Generated by \"HardwareSimulator --compile\" from the chips below, do not edit.\n"
+        << "// Linked into the HardwareSimulator, the code replaces the interpretation of chips with the same netlist.\n"
+        << "#include <cstdint>\n"
+        << "#include \"BuiltinChip.h\"\n"
+        << "#include \"CompiledChips.h\"\n\n"
+        << "namespace\n{\n";
+
+    for (const auto& netlist : netlists)
+    {
+        auto compiler = ChipCompiler(netlist);
+        compiler.writeFunction(stream);
+
+        stream << "const CompiledChips::Registration " << netlist.chip.name << "Registration(\"" << netlist.chip.name << "\", 0x"
+            << hex << uppercase << CompiledChips::getFingerprint(netlist) << dec << "ULL, evaluate" << netlist.chip.name << ");\n\n";
+    }
+    stream << "}\n";
+}
+
+ChipCompiler::ChipCompiler(const Netlist& netlist)
+    : mNetlist(netlist),
+    mWireExpressions(netlist.wireCount),
+    mBusBits(netlist.wireCount),
+    mIsWireRead(netlist.wireCount, false)
+{
+    // gates and outputs of components are declared only if they are read. Pins and chips called through
+    //     BuiltinChip read their wires always, clocked inputs may come from later nodes of the evaluation order.
+    //     Gates and combinational chips read their inputs only if their outputs are read, so they are followed backwards.
+    auto markRead = [this](const vector<int>& wires)
+    {
+        for (auto wire : wires)
+        {
+            mIsWireRead[wire] = true;
+        }
+    };
+    for (const auto& [name, wires] : netlist.pins)
+    {
+        markRead(wires);
+    }
+    for (size_t i = 0; i < netlist.components.size(); i++)
+    {
+        if (getOutputExpressions(static_cast<int>(i)).empty())
+        {
+            for_each(netlist.components[i].inputs.begin(), netlist.components[i].inputs.end(), markRead);
+        }
+    }
+    for (auto node = netlist.order.rbegin(); node != netlist.order.rend(); node++)
+    {
+        if (node->isGate)
+        {
+            const auto& gate = netlist.gates[node->index];
+            mIsWireRead[gate.a] = mIsWireRead[gate.a] || mIsWireRead[gate.out];
+            mIsWireRead[gate.b] = mIsWireRead[gate.b] || mIsWireRead[gate.out];
+        }
+        else if (isComponentRead(node->index))
+        {
+            const auto& inputs = netlist.components[node->index].inputs;
+            for_each(inputs.begin(), inputs.end(), markRead);
+        }
+    }
+
+    mWireExpressions[Netlist::FALSE_WIRE] = "0";
+    mWireExpressions[Netlist::TRUE_WIRE] = "1";
+    for (const auto& pin : netlist.chip.inputs)
+    {
+        for (auto wire : netlist.pins.at(pin.name))
+        {
+            mWireExpressions[wire] = "w[" + to_string(wire) + "]";
+        }
+    }
+}
+
+void ChipCompiler::writeFunction(ostream& stream)
+{
+    stream << "// " << mNetlist.chip.fileName << ": " << mNetlist.gates.size() << " gates, " << mNetlist.components.size() << " components\n"
+        << "void evaluate" << mNetlist.chip.name << "(uint8_t* w, [[maybe_unused]] BuiltinChip* const* c, bool isTick)\n{\n";
+    for (const auto& node : mNetlist.order)
+    {
+        if (node.isGate)
+        {
+            writeGate(stream, mNetlist.gates[node.index]);
+        }
+        else
+        {
+            writeComponent(stream, node.index);
+        }
+    }
+
+    // pins are read by scripts
+    for (const auto& [name, wires] : mNetlist.pins)
+    {
+        if (mNetlist.chip.findInput(name))
+        {
+            continue;
+        }
+        for (auto wire : wires)
+        {
+            if (wire > Netlist::TRUE_WIRE)
+            {
+                stream << "    w[" << wire << "] = " << mWireExpressions[wire] << ";\n";
+            }
+        }
+    }
+
+    // clocked components read all inputs after the evaluation
+    stream << "    if (!isTick)\n    {\n        return;\n    }\n";
+    for (size_t i = 0; i < mNetlist.components.size(); i++)
+    {
+        const auto& component = mNetlist.components[i];
+        if (!component.chip->isClocked())
+        {
+            continue;
+        }
+        stream << "    {\n        const uint16_t in[] = { ";
+        for (size_t pin = 0; pin < component.inputs.size(); pin++)
+        {
+            stream << (pin == 0 ? "" : ", ") << getBusExpression(component.inputs[pin]);
+        }
+        stream << " };\n        c[" << i << "]->clockUp(in);\n    }\n";
+    }
+    stream << "}\n";
+}
+
+void ChipCompiler::writeGate(ostream& stream, const Netlist::NandGate& gate)
+{
+    if (!mIsWireRead[gate.out])
+    {
+        return;
+    }
+    const auto& a = mWireExpressions[gate.a];
+    const auto& b = mWireExpressions[gate.b];
+    auto& out = mWireExpressions[gate.out];
+
+    // constant inputs are folded
+    if (a == "0" || b == "0")
+    {
+        out = "1";
+        return;
+    }
+    out = "n" + to_string(gate.out);
+    stream << "    const uint8_t " << out << " = ";
+    if (a == b || b == "1")
+    {
+        stream << "!" << a << ";\n";
+    }
+    else if (a == "1")
+    {
+        stream << "!" << b << ";\n";
+    }
+    else
+    {
+        stream << "!(" << a << " & " << b << ");\n";
+    }
+}
+
+void ChipCompiler::writeComponent(ostream& stream, int index)
+{
+    const auto& component = mNetlist.components[index];
+    auto prefix = "c" + to_string(index);
+    if (!isComponentRead(index))
+    {
+        return;
+    }
+
+    for (size_t pin = 0; pin < component.inputs.size(); pin++)
+    {
+        // clocked inputs are read only by clockUp, their sources may be evaluated later
+        auto value = component.isInputClocked[pin] ? "0" : getBusExpression(component.inputs[pin]);
+        stream << "    const uint16_t " << prefix << "i" << pin << " = " << value << ";\n";
+    }
+
+    auto expressions = getOutputExpressions(index);
+    if (expressions.empty())
+    {
+        auto inputCount = max<size_t>(component.inputs.size(), 1);
+        stream << "    const uint16_t " << prefix << "i[" << inputCount << "] = { ";
+        for (size_t pin = 0; pin < component.inputs.size(); pin++)
+        {
+            stream << (pin == 0 ? "" : ", ") << prefix << "i" << pin;
+        }
+        stream << " };\n    uint16_t " << prefix << "o[" << component.outputs.size() << "];\n"
+            << "    c[" << index << "]->evaluate(" << prefix << "i, " << prefix << "o);\n";
+        for (size_t pin = 0; pin < component.outputs.size(); pin++)
+        {
+            expressions.push_back(prefix + "o[" + to_string(pin) + "]");
+        }
+    }
+
+    for (size_t pin = 0; pin < component.outputs.size(); pin++)
+    {
+        const auto& wires = component.outputs[pin];
+        if (!isPinRead(wires))
+        {
+            continue;
+        }
+        auto name = prefix + "o" + to_string(pin);
+        stream << "    const uint16_t " << name << " = static_cast<uint16_t>((" << expressions[pin] << ") & " << getMask(wires.size()) << ");\n";
+        for (size_t bit = 0; bit < wires.size(); bit++)
+        {
+            mBusBits[wires[bit]] = { index, static_cast<int>(pin), static_cast<int>(bit) };
+            mWireExpressions[wires[bit]] = wires.size() == 1 ? name : "((" + name + " >> " + to_string(bit) + ") & 1)";
+        }
+    }
+}
+
+bool ChipCompiler::isPinRead(const vector<int>& wires) const
+{
+    return any_of(wires.begin(), wires.end(), [this](int wire) { return mIsWireRead[wire]; });
+}
+
+/// <summary>
+/// Returns whether the component is evaluated, combinational chips without read outputs are left out.
+/// </summary>
+bool ChipCompiler::isComponentRead(int index) const
+{
+    const auto& outputs = mNetlist.components[index].outputs;
+    return getOutputExpressions(index).empty() || any_of(outputs.begin(), outputs.end(), [this](const vector<int>& wires) { return isPinRead(wires); });
+}
+
+/// <summary>
+/// Returns expressions of the outputs of the combinational built-in chip, inputs are named "cNiM".
+/// Returns no expressions for other chips.
+/// </summary>
+vector<string> ChipCompiler::getOutputExpressions(int index) const
+{
+    const auto& component = mNetlist.components[index];
+    if (component.chip->isClocked() || component.chip->getStateSize() > 0)
+    {
+        return {};
+    }
+
+    vector<string> in;
+    for (size_t pin = 0; pin < component.inputs.size(); pin++)
+    {
+        in.push_back("c" + to_string(index) + "i" + to_string(pin));
+    }
+    const auto& name = component.builtinName;
+    if (name == "Nand")
+    {
+        return { "~(" + in[0] + " & " + in[1] + ")" };
+    }
+    if (name == "Not" || name == "Not16")
+    {
+        return { "~" + in[0] };
+    }
+    if (name == "And" || name == "Or" || name == "Xor")
+    {
+        auto operation = name == "And" ? " & " : name == "Or" ? " | " : " ^ ";
+        return { in[0] + operation + in[1] };
+    }
+    if (name == "Mux" || name == "Mux4Way16" || name == "Mux8Way16")
+    {
+        const auto& sel = in.back();
+        string expression = in[0];
+        for (size_t i = 1; i + 1 < in.size(); i++)
+        {
+            expression = sel + " == " + to_string(i) + " ? " + in[i] + " : " + expression;
+        }
+        return { expression };
+    }
+    if (name == "DMux" || name == "DMux4Way" || name == "DMux8Way")
+    {
+        vector<string> expressions;
+        for (size_t i = 0; i < component.outputs.size(); i++)
+        {
+            expressions.push_back(in[1] + " == " + to_string(i) + " ? " + in[0] + " : 0");
+        }
+        return expressions;
+    }
+    if (name == "Or8Way")
+    {
+        return { in[0] + " != 0" };
+    }
+    if (name == "HalfAdder")
+    {
+        return { in[0] + " ^ " + in[1], in[0] + " & " + in[1] };
+    }
+    if (name == "FullAdder")
+    {
+        return { in[0] + " ^ " + in[1] + " ^ " + in[2], "(" + in[0] + " + " + in[1] + " + " + in[2] + ") >> 1" };
+    }
+    if (name == "Add16")
+    {
+        return { in[0] + " + " + in[1] };
+    }
+    if (name == "Inc16")
+    {
+        return { in[0] + " + 1" };
+    }
+    if (name == "ALU")
+    {
+        // x, y, zx, nx, zy, ny, f, no
+        auto x = "((" + in[2] + " ? 0 : " + in[0] + ") ^ (" + in[3] + " ? 0xFFFF : 0))";
+        auto y = "((" + in[4] + " ? 0 : " + in[1] + ") ^ (" + in[5] + " ? 0xFFFF : 0))";
+        auto out = "(static_cast<uint16_t>(" + in[6] + " ? " + x + " + " + y + " : " + x + " & " + y + ") ^ (" + in[7] + " ? 0xFFFF : 0))";
+        return { out, "(" + out + " & 0xFFFF) == 0", "(" + out + " >> 15) & 1" };
+    }
+    return {};
+}
+
+/// <summary>
+/// Returns the value of the wires as a 16-bit expression, consecutive bits of a component output are shifted at once.
+/// </summary>
+string ChipCompiler::getBusExpression(const vector<int>& wires) const
+{
+    const auto& first = mBusBits[wires[0]];
+    bool isSlice = first.component >= 0;
+    for (size_t i = 1; i < wires.size() && isSlice; i++)
+    {
+        const auto& busBit = mBusBits[wires[i]];
+        isSlice = busBit.component == first.component && busBit.pin == first.pin && busBit.bit == first.bit + static_cast<int>(i);
+    }
+    if (isSlice)
+    {
+        auto name = "c" + to_string(first.component) + "o" + to_string(first.pin);
+        const auto& source = mNetlist.components[first.component].outputs[first.pin];
+        if (first.bit == 0 && wires.size() == source.size())
+        {
+            return name;
+        }
+        auto shifted = first.bit == 0 ? name : "(" + name + " >> " + to_string(first.bit) + ")";
+        return "static_cast<uint16_t>(" + shifted + " & " + getMask(wires.size()) + ")";
+    }
+
+    string expression;
+    for (size_t i = 0; i < wires.size(); i++)
+    {
+        const auto& bit = mWireExpressions[wires[i]];
+        if (bit == "0")
+        {
+            continue;
+        }
+        expression += (expression.empty() ? "" : " | ") + (i == 0 ? bit : "(" + bit + " << " + to_string(i) + ")");
+    }
+    return expression.empty() ? "0" : "static_cast<uint16_t>(" + expression + ")";
+}
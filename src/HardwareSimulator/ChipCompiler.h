@@ -0,0 +1,44 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Netlist.h"
+
+/// <summary>
+/// ChipCompiler translates netlists into straight-line C++ code registered in CompiledChips.
+/// <para/> Gates become local variables, buses of built-in components are kept as 16-bit values
+///     and combinational built-in chips are written as expressions. Clocked and memory chips are called
+///     through BuiltinChip, so scripts can still access their state.
+/// </summary>
+class ChipCompiler
+{
+public:
+    /// <summary>
+    /// Writes a .cpp file with the evaluate function and the registration of every netlist.
+    /// </summary>
+    static void write(const std::vector<Netlist>& netlists, std::ostream& stream);
+
+private:
+    // bit of a 16-bit output of a component
+    struct BusBit
+    {
+        int component = -1;
+        int pin = 0;
+        int bit = 0;
+    };
+
+    explicit ChipCompiler(const Netlist& netlist);
+
+    void writeFunction(std::ostream& stream);
+    void writeGate(std::ostream& stream, const Netlist::NandGate& gate);
+    void writeComponent(std::ostream& stream, int index);
+    bool isPinRead(const std::vector<int>& wires) const;
+    bool isComponentRead(int index) const;
+    std::vector<std::string> getOutputExpressions(int index) const;
+    std::string getBusExpression(const std::vector<int>& wires) const;
+
+    const Netlist& mNetlist;
+    std::vector<std::string> mWireExpressions;
+    std::vector<BusBit> mBusBits;
+    std::vector<bool> mIsWireRead;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct PinDeclaration
+{
+    std::string name;
+    int width = 1;
+};
+
+/// <summary>
+/// Pin or its sub bus used in a connection, e.g. "out[0..7]". Without the range the whole pin is used.
+/// </summary>
+struct PinReference
+{
+    std::string name;
+    int from = -1;
+    int to = -1;
+
+    bool hasRange() const
+    {
+        return from >= 0;
+    }
+};
+
+/// <summary>
+/// Connection "part=chip" of a part pin to a pin of the chip, or to true or false.
+/// </summary>
+struct Connection
+{
+    PinReference part;
+    PinReference chip;
+};
+
+struct PartDeclaration
+{
+    std::string chipName;
+    std::vector<Connection> connections;
+    int line = 0;
+};
+
+/// <summary>
+/// Chip parsed from a .hdl file or declared by the simulator as a built-in chip.
+/// </summary>
+struct ChipDeclaration
+{
+    std::string name;
+    std::string fileName;
+    std::vector<PinDeclaration> inputs;
+    std::vector<PinDeclaration> outputs;
+    std::vector<PartDeclaration> parts;
+    /// <summary>
+    /// Name of the implementation of the built-in chip, empty for chips made of parts.
+    /// </summary>
+    std::string builtinName;
+    /// <summary>
+    /// Inputs read only at the clock edges, they do not change the outputs of the built-in chip immediately.
+    /// </summary>
+    std::vector<std::string> clockedPins;
+
+    const PinDeclaration* findInput(const std::string& pinName) const
+    {
+        for (const auto& pin : inputs)
+        {
+            if (pin.name == pinName)
+            {
+                return &pin;
+            }
+        }
+        return nullptr;
+    }
+
+    const PinDeclaration* findOutput(const std::string& pinName) const
+    {
+        for (const auto& pin : outputs)
+        {
+            if (pin.name == pinName)
+            {
+                return &pin;
+            }
+        }
+        return nullptr;
+    }
+};
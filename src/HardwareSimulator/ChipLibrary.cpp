@@ -0,0 +1,45 @@
+#include "BuiltinChips.h"
+#include "ChipLibrary.h"
+#include "HardwareSimulatorError.h"
+#include "HdlParser.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Creates ChipLibrary of the directory.
+/// </summary>
+/// <param name="builtinChipNames">Chips used as built-in chips, even if the directory contains their .hdl files</param>
+ChipLibrary::ChipLibrary(const fs::path& directory, unordered_set<string> builtinChipNames)
+    : mDirectory(directory),
+    mBuiltinChipNames(std::move(builtinChipNames))
+{
+}
+
+/// <summary>
+/// Returns the declaration of the chip. May throw HardwareSimulatorError.
+/// </summary>
+const ChipDeclaration& ChipLibrary::find(const string& chipName)
+{
+    if (auto it = mChips.find(chipName); it != mChips.end())
+    {
+        return it->second;
+    }
+
+    auto path = mDirectory / (chipName + ".hdl");
+    if (!mBuiltinChipNames.count(chipName) && fs::is_regular_file(path))
+    {
+        auto chip = HdlParser::parse(path);
+        if (chip.name != chipName)
+        {
+            throw HardwareSimulatorError("File " + path.string() + " declares chip " + chip.name + " instead of " + chipName + ".");
+        }
+        return mChips.emplace(chipName, std::move(chip)).first->second;
+    }
+
+    if (const auto* builtinChip = BuiltinChips::findDeclaration(chipName))
+    {
+        return mChips.emplace(chipName, *builtinChip).first->second;
+    }
+    throw HardwareSimulatorError("Chip " + chipName + " is not found in " + mDirectory.string() + " directory nor among built-in chips.");
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "ChipDeclaration.h"
+
+/// <summary>
+/// ChipLibrary resolves chip names used by scripts and parts.
+/// <para/> A chip is read from the "Name.hdl" file in the directory of the script, chips without the file
+///     are the built-in chips of the simulator.
+/// <para/> Selected chips are always built-in, so higher level chips can be tested with fast memories and registers.
+/// </summary>
+class ChipLibrary
+{
+public:
+    /// <summary>
+    /// Creates ChipLibrary of the directory.
+    /// </summary>
+    /// <param name="builtinChipNames">Chips used as built-in chips, even if the directory contains their .hdl files</param>
+    explicit ChipLibrary(const std::filesystem::path& directory, std::unordered_set<std::string> builtinChipNames = {});
+
+    /// <summary>
+    /// Returns the declaration of the chip. May throw HardwareSimulatorError.
+    /// </summary>
+    const ChipDeclaration& find(const std::string& chipName);
+
+private:
+    std::filesystem::path mDirectory;
+    std::unordered_set<std::string> mBuiltinChipNames;
+    std::unordered_map<std::string, ChipDeclaration> mChips;
+};
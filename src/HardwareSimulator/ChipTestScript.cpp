@@ -0,0 +1,248 @@
+#include "ChipLibrary.h"
+#include "ChipTestScript.h"
+#include "NetlistBuilder.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Parses the .tst file. May throw TestScriptError.
+/// </summary>
+ChipTestScript::ChipTestScript(const fs::path& path)
+    : TestScript(path)
+{
+}
+
+/// <summary>
+/// Sets keys held on the Keyboard chip, every while loop of the script presses the next key.
+/// </summary>
+void ChipTestScript::setKeys(const string& keys)
+{
+    mKeys = keys;
+}
+
+/// <summary>
+/// Selects the event-driven simulation or the evaluation of the whole chip, the event-driven one is the default.
+/// </summary>
+void ChipTestScript::setEventDriven(bool isEventDriven)
+{
+    mIsEventDriven = isEventDriven;
+}
+
+/// <summary>
+/// Sets chips used as built-in chips, even if the directory of the script contains their .hdl files.
+/// </summary>
+void ChipTestScript::setBuiltinChips(unordered_set<string> chipNames)
+{
+    mBuiltinChipNames = std::move(chipNames);
+}
+
+/// <summary>
+/// Selects the Value Change Dump file written for the loaded chip.
+/// </summary>
+void ChipTestScript::setWaveformOptions(const WaveformOptions& options)
+{
+    mWaveformOptions = options;
+}
+
+/// <summary>
+/// Returns whether a loaded chip was evaluated by code compiled into the simulator.
+/// </summary>
+bool ChipTestScript::isCompiled() const
+{
+    return mIsCompiled;
+}
+
+long long ChipTestScript::getEvaluationCount() const
+{
+    return mEvaluationCount + (mSimulator ? mSimulator->getEvaluationCount() : 0);
+}
+
+/// <summary>
+/// Returns the count of evaluated gates and components.
+/// </summary>
+long long ChipTestScript::getNodeEvaluationCount() const
+{
+    return mNodeEvaluationCount + (mSimulator ? mSimulator->getNodeEvaluationCount() : 0);
+}
+
+bool ChipTestScript::load(const Command& command)
+{
+    // the script is meant for the CPUEmulator or the VMEmulator
+    if (command.words.size() != 2 || fs::path(command.words[1]).extension() != ".hdl")
+    {
+        return false;
+    }
+
+    if (mSimulator)
+    {
+        mEvaluationCount += mSimulator->getEvaluationCount();
+        mNodeEvaluationCount += mSimulator->getNodeEvaluationCount();
+    }
+
+    // the writer reads the replaced simulator
+    mVcdWriter.reset();
+    auto chipName = fs::path(command.words[1]).stem().string();
+    ChipLibrary library(mPath.parent_path(), mBuiltinChipNames);
+    mSimulator = make_unique<Simulator>(NetlistBuilder(library).build(chipName), mIsEventDriven);
+    mIsCompiled = mIsCompiled || mSimulator->isCompiled();
+
+    if (mWaveformOptions.writeVcd)
+    {
+        auto path = mPath;
+        mVcdWriter = make_unique<VcdWriter>(path.replace_extension(".vcd"), *mSimulator, mWaveformOptions);
+    }
+    return true;
+}
+
+bool ChipTestScript::executeSimulatorCommand(const Command& command)
+{
+    const auto& name = command.words[0];
+    auto argumentCount = command.words.size() - 1;
+    if (name == "eval" && argumentCount == 0)
+    {
+        getSimulator(command).evaluate();
+    }
+    else if (name == "tick" && argumentCount == 0)
+    {
+        getSimulator(command).tick();
+    }
+    else if (name == "tock" && argumentCount == 0)
+    {
+        getSimulator(command).tock();
+    }
+    else if (argumentCount == 2 && command.words[1] == "load")
+    {
+        // e.g. "ROM32K load Max.hack"
+        int index = 0;
+        auto& chip = findState(command, command.words[0] + "[]", index);
+        chip.load(mPath.parent_path() / command.words[2]);
+        mSimulator->markStateChanged(chip);
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+    sampleWaveform();
+    return true;
+}
+
+/// <summary>
+/// Reads the pin of the chip or the state of a built-in part "Name[index]".
+/// 16-bit values are signed, narrower pins are unsigned.
+/// </summary>
+int ChipTestScript::readValue(const Command& command, const string& name, bool& isSigned) const
+{
+    if (name.find('[') != string::npos)
+    {
+        int index = 0;
+        const auto& chip = findState(command, name, index);
+        isSigned = true;
+        return chip.getState(index);
+    }
+
+    auto& simulator = getSimulator(command);
+    if (!simulator.hasPin(name))
+    {
+        fail(command, "Chip " + simulator.getNetlist().chip.name + " has no pin " + name);
+    }
+    auto value = simulator.getPin(name);
+    isSigned = simulator.getPinWidth(name) == 16;
+    return isSigned ? static_cast<int16_t>(value) : value;
+}
+
+void ChipTestScript::writeValue(const Command& command, const string& name, int value)
+{
+    if (name.find('[') != string::npos)
+    {
+        int index = 0;
+        auto& chip = findState(command, name, index);
+        chip.setState(index, static_cast<int16_t>(value));
+        mSimulator->markStateChanged(chip);
+        sampleWaveform();
+        return;
+    }
+
+    auto& simulator = getSimulator(command);
+    if (!simulator.getNetlist().chip.findInput(name))
+    {
+        fail(command, "Chip " + simulator.getNetlist().chip.name + " has no input pin " + name);
+    }
+    simulator.setPin(name, static_cast<uint16_t>(value));
+    sampleWaveform();
+}
+
+string ChipTestScript::getTime(const Command& command) const
+{
+    return getSimulator(command).getTime();
+}
+
+void ChipTestScript::beginWhileLoop(const Command& command)
+{
+    if (mNextKey < mKeys.size())
+    {
+        int index = 0;
+        auto& keyboard = findState(command, "Keyboard[]", index);
+        keyboard.setState(0, static_cast<int16_t>(mKeys[mNextKey++]));
+        mSimulator->markStateChanged(keyboard);
+    }
+}
+
+void ChipTestScript::finish()
+{
+    if (mVcdWriter)
+    {
+        mVcdWriter->close();
+        mVcdWriter.reset();
+    }
+    if (mSimulator)
+    {
+        mEvaluationCount += mSimulator->getEvaluationCount();
+        mNodeEvaluationCount += mSimulator->getNodeEvaluationCount();
+        mSimulator.reset();
+    }
+}
+
+void ChipTestScript::sampleWaveform()
+{
+    if (mVcdWriter)
+    {
+        mVcdWriter->sample();
+    }
+}
+
+/// <summary>
+/// Finds the built-in part of "Name[index]", "Name[]" is the first word of the state.
+/// </summary>
+BuiltinChip& ChipTestScript::findState(const Command& command, const string& name, int& index) const
+{
+    auto bracket = name.find('[');
+    if (bracket == string::npos || name.back() != ']')
+    {
+        fail(command, "Expected 'Name[index]', found '" + name + "'");
+    }
+    auto chipName = name.substr(0, bracket);
+    auto indexText = name.substr(bracket + 1, name.size() - bracket - 2);
+    index = indexText.empty() ? 0 : parseNumber(command, indexText);
+
+    auto* chip = getSimulator(command).findBuiltinChip(chipName);
+    if (!chip)
+    {
+        fail(command, "Chip " + getSimulator(command).getNetlist().chip.name + " has no built-in part " + chipName);
+    }
+    if (index < 0 || index >= chip->getStateSize())
+    {
+        fail(command, "Index of " + name + " is out of range");
+    }
+    return *chip;
+}
+
+Simulator& ChipTestScript::getSimulator(const Command& command) const
+{
+    if (!mSimulator)
+    {
+        fail(command, "No chip is loaded");
+    }
+    return *mSimulator;
+}
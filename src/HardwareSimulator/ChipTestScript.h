@@ -0,0 +1,76 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include "Simulator.h"
+#include "TestScript.h"
+#include "VcdWriter.h"
+#include "WaveformOptions.h"
+
+/// <summary>
+/// ChipTestScript executes a .tst script of the HardwareSimulator, scripts of other simulators are skipped.
+/// <para/> The Keyboard chip is controlled by the keys given to the script.
+/// </summary>
+class ChipTestScript : public TestScript
+{
+public:
+    /// <summary>
+    /// Parses the .tst file. May throw TestScriptError.
+    /// </summary>
+    explicit ChipTestScript(const std::filesystem::path& path);
+
+    /// <summary>
+    /// Sets keys held on the Keyboard chip, every while loop of the script presses the next key.
+    /// </summary>
+    void setKeys(const std::string& keys);
+    /// <summary>
+    /// Selects the event-driven simulation or the evaluation of the whole chip, the event-driven one is the default.
+    /// </summary>
+    void setEventDriven(bool isEventDriven);
+    /// <summary>
+    /// Sets chips used as built-in chips, even if the directory of the script contains their .hdl files.
+    /// </summary>
+    void setBuiltinChips(std::unordered_set<std::string> chipNames);
+    /// <summary>
+    /// Selects the Value Change Dump file written for the loaded chip.
+    /// </summary>
+    void setWaveformOptions(const WaveformOptions& options);
+
+    /// <summary>
+    /// Returns whether a loaded chip was evaluated by code compiled into the simulator.
+    /// </summary>
+    bool isCompiled() const;
+    long long getEvaluationCount() const;
+    /// <summary>
+    /// Returns the count of evaluated gates and components.
+    /// </summary>
+    long long getNodeEvaluationCount() const;
+
+private:
+    bool load(const Command& command) override;
+    bool executeSimulatorCommand(const Command& command) override;
+    int readValue(const Command& command, const std::string& name, bool& isSigned) const override;
+    void writeValue(const Command& command, const std::string& name, int value) override;
+    std::string getTime(const Command& command) const override;
+    void beginWhileLoop(const Command& command) override;
+    void finish() override;
+
+    void sampleWaveform();
+    BuiltinChip& findState(const Command& command, const std::string& name, int& index) const;
+    Simulator& getSimulator(const Command& command) const;
+
+    std::string mKeys;
+    size_t mNextKey = 0;
+    bool mIsEventDriven = true;
+    std::unordered_set<std::string> mBuiltinChipNames;
+
+    WaveformOptions mWaveformOptions;
+
+    std::unique_ptr<Simulator> mSimulator;
+    // declared after the simulator, it is destroyed first
+    std::unique_ptr<VcdWriter> mVcdWriter;
+    bool mIsCompiled = false;
+    long long mEvaluationCount = 0;
+    long long mNodeEvaluationCount = 0;
+};
@@ -0,0 +1,143 @@
+#include <random>
+#include <sstream>
+#include <vector>
+#include "BitSlicedEvaluator.h"
+#include "BuiltinChips.h"
+#include "ChipVerifier.h"
+#include "HardwareSimulatorError.h"
+
+using namespace std;
+
+bool hasSamePins(const vector<PinDeclaration>& pins, const vector<PinDeclaration>& referencePins)
+{
+    if (pins.size() != referencePins.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < pins.size(); i++)
+    {
+        if (pins[i].name != referencePins[i].name || pins[i].width != referencePins[i].width)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Creates ChipVerifier.
+/// </summary>
+/// <param name="randomVectorCount">Count of random vectors for chips with too many input bits</param>
+ChipVerifier::ChipVerifier(long long randomVectorCount, unsigned seed)
+    : mRandomVectorCount(randomVectorCount),
+    mSeed(seed)
+{
+}
+
+/// <summary>
+/// Returns the declaration of the combinational built-in chip used as the reference or nullptr.
+/// </summary>
+const ChipDeclaration* ChipVerifier::findReference(const string& chipName)
+{
+    const auto* reference = BuiltinChips::findDeclaration(chipName);
+    if (!reference)
+    {
+        return nullptr;
+    }
+    auto chip = BuiltinChips::create(*reference);
+    return chip->isClocked() || chip->getStateSize() > 0 ? nullptr : reference;
+}
+
+/// <summary>
+/// Verifies the netlist against the reference built-in chip. May throw HardwareSimulatorError,
+///     if the chip is not combinational or its pins differ from the reference.
+/// </summary>
+ChipVerifier::Result ChipVerifier::verify(const Netlist& netlist, const ChipDeclaration& reference) const
+{
+    const auto& chip = netlist.chip;
+    if (!hasSamePins(chip.inputs, reference.inputs) || !hasSamePins(chip.outputs, reference.outputs))
+    {
+        throw HardwareSimulatorError("Pins of chip " + chip.name + " differ from the built-in chip.");
+    }
+
+    auto evaluator = BitSlicedEvaluator(netlist);
+    auto referenceChip = BuiltinChips::create(reference);
+
+    int inputBitCount = 0;
+    for (const auto& pin : chip.inputs)
+    {
+        inputBitCount += pin.width;
+    }
+
+    Result result;
+    result.isExhaustive = inputBitCount <= MAX_EXHAUSTIVE_INPUT_BITS;
+    long long totalCount = result.isExhaustive ? 1LL << inputBitCount : mRandomVectorCount;
+    mt19937_64 random(mSeed);
+
+    constexpr int LANE_COUNT = BitSlicedEvaluator::LANE_COUNT;
+    // values of pins in the lanes, [pin][lane]
+    vector<vector<uint16_t>> inputs(chip.inputs.size(), vector<uint16_t>(LANE_COUNT));
+    vector<vector<uint16_t>> outputs(chip.outputs.size(), vector<uint16_t>(LANE_COUNT));
+    vector<uint16_t> referenceInputs(chip.inputs.size());
+    vector<uint16_t> referenceOutputs(chip.outputs.size());
+
+    for (long long first = 0; first < totalCount; first += LANE_COUNT)
+    {
+        // the last batch repeats the first vector in unused lanes
+        for (int lane = 0; lane < LANE_COUNT; lane++)
+        {
+            auto index = first + lane < totalCount ? first + lane : first;
+            uint64_t bits = result.isExhaustive ? static_cast<uint64_t>(index) : 0;
+            for (size_t pin = 0; pin < chip.inputs.size(); pin++)
+            {
+                int width = chip.inputs[pin].width;
+                auto value = result.isExhaustive ? bits : random();
+                inputs[pin][lane] = static_cast<uint16_t>(value & ((1ULL << width) - 1));
+                bits >>= width;
+            }
+        }
+        for (size_t pin = 0; pin < chip.inputs.size(); pin++)
+        {
+            evaluator.setInput(chip.inputs[pin].name, inputs[pin].data());
+        }
+        evaluator.evaluate();
+        for (size_t pin = 0; pin < chip.outputs.size(); pin++)
+        {
+            evaluator.getOutput(chip.outputs[pin].name, outputs[pin].data());
+        }
+
+        int laneCount = static_cast<int>(min<long long>(LANE_COUNT, totalCount - first));
+        for (int lane = 0; lane < laneCount; lane++)
+        {
+            for (size_t pin = 0; pin < chip.inputs.size(); pin++)
+            {
+                referenceInputs[pin] = inputs[pin][lane];
+            }
+            referenceChip->evaluate(referenceInputs.data(), referenceOutputs.data());
+
+            for (size_t pin = 0; pin < chip.outputs.size(); pin++)
+            {
+                auto mask = static_cast<uint16_t>((1U << chip.outputs[pin].width) - 1);
+                auto expected = static_cast<uint16_t>(referenceOutputs[pin] & mask);
+                if (outputs[pin][lane] == expected)
+                {
+                    continue;
+                }
+
+                ostringstream message;
+                message << "Output " << chip.outputs[pin].name << " is " << outputs[pin][lane] << " instead of " << expected << " for";
+                for (size_t input = 0; input < chip.inputs.size(); input++)
+                {
+                    message << (input == 0 ? " " : ", ") << chip.inputs[input].name << "=" << inputs[input][lane];
+                }
+                result.vectorCount = first + lane + 1;
+                result.message = message.str();
+                return result;
+            }
+        }
+        result.vectorCount = first + laneCount;
+    }
+
+    result.isPassed = true;
+    return result;
+}
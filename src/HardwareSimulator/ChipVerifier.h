@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "ChipDeclaration.h"
+#include "Netlist.h"
+
+/// <summary>
+/// ChipVerifier compares a combinational chip with the built-in chip of the same name.
+/// <para/> Chips with at most MAX_EXHAUSTIVE_INPUT_BITS input bits are tested by all input vectors,
+///     other chips by random vectors. Vectors are evaluated by the BitSlicedEvaluator.
+/// </summary>
+class ChipVerifier
+{
+public:
+    static constexpr int MAX_EXHAUSTIVE_INPUT_BITS = 24;
+
+    struct Result
+    {
+        bool isPassed = false;
+        bool isExhaustive = false;
+        long long vectorCount = 0;
+        // the first different output, empty for passed chips
+        std::string message;
+    };
+
+    /// <summary>
+    /// Creates ChipVerifier.
+    /// </summary>
+    /// <param name="randomVectorCount">Count of random vectors for chips with too many input bits</param>
+    ChipVerifier(long long randomVectorCount, unsigned seed);
+
+    /// <summary>
+    /// Returns the declaration of the combinational built-in chip used as the reference or nullptr.
+    /// </summary>
+    static const ChipDeclaration* findReference(const std::string& chipName);
+
+    /// <summary>
+    /// Verifies the netlist against the reference built-in chip. May throw HardwareSimulatorError,
+    ///     if the chip is not combinational or its pins differ from the reference.
+    /// </summary>
+    Result verify(const Netlist& netlist, const ChipDeclaration& reference) const;
+
+private:
+    long long mRandomVectorCount;
+    unsigned mSeed;
+};
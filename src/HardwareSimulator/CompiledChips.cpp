@@ -0,0 +1,109 @@
+#include <unordered_map>
+#include "CompiledChips.h"
+
+using namespace std;
+
+struct CompiledChip
+{
+    uint64_t fingerprint = 0;
+    CompiledChips::EvaluateFunction function = nullptr;
+};
+
+// constructed on the first use, registrations are static objects of other files
+unordered_multimap<string, CompiledChip>& getRegistry()
+{
+    static unordered_multimap<string, CompiledChip> registry;
+    return registry;
+}
+
+/// <summary>
+/// Registers the compiled chip, generated code creates a static instance.
+/// </summary>
+CompiledChips::Registration::Registration(const char* chipName, uint64_t fingerprint, EvaluateFunction function)
+{
+    getRegistry().emplace(chipName, CompiledChip{ fingerprint, function });
+}
+
+/// <summary>
+/// Returns the compiled function of the netlist or nullptr.
+/// </summary>
+CompiledChips::EvaluateFunction CompiledChips::find(const Netlist& netlist)
+{
+    auto range = getRegistry().equal_range(netlist.chip.name);
+    if (range.first == range.second)
+    {
+        return nullptr;
+    }
+
+    auto fingerprint = getFingerprint(netlist);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.fingerprint == fingerprint)
+        {
+            return it->second.function;
+        }
+    }
+    return nullptr;
+}
+
+/// <summary>
+/// Returns the hash of wires, gates, components and their evaluation order.
+/// </summary>
+uint64_t CompiledChips::getFingerprint(const Netlist& netlist)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](uint64_t value)
+    {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+    auto addText = [&add](const string& text)
+    {
+        for (char character : text)
+        {
+            add(static_cast<unsigned char>(character));
+        }
+        add(0);
+    };
+    auto addWires = [&add](const vector<int>& wires)
+    {
+        add(wires.size());
+        for (auto wire : wires)
+        {
+            add(static_cast<uint64_t>(wire));
+        }
+    };
+
+    add(static_cast<uint64_t>(netlist.wireCount));
+    for (const auto& gate : netlist.gates)
+    {
+        addWires({ gate.a, gate.b, gate.out });
+    }
+    for (const auto& component : netlist.components)
+    {
+        addText(component.chipName);
+        addText(component.builtinName);
+        for (const auto& wires : component.inputs)
+        {
+            addWires(wires);
+        }
+        for (const auto& wires : component.outputs)
+        {
+            addWires(wires);
+        }
+    }
+    for (const auto& node : netlist.order)
+    {
+        add(node.isGate);
+        add(static_cast<uint64_t>(node.index));
+    }
+    for (const auto* pins : { &netlist.chip.inputs, &netlist.chip.outputs })
+    {
+        for (const auto& pin : *pins)
+        {
+            addText(pin.name);
+            addWires(netlist.pins.at(pin.name));
+        }
+    }
+    return hash;
+}
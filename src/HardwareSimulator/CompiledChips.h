@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "BuiltinChip.h"
+#include "Netlist.h"
+
+/// <summary>
+/// Registry of chips compiled into C++ by "HardwareSimulator --compile" and linked into the simulator.
+/// <para/> A compiled chip is used only for the netlist with the same fingerprint, so a chip changed
+///     after the compilation is interpreted again.
+/// </summary>
+class CompiledChips
+{
+public:
+    /// <summary>
+    /// Evaluates the netlist, the tick additionally calls clockUp of clocked components.
+    /// </summary>
+    /// <param name="values">Values of the wires, the inputs of the chip are read and its pins are written</param>
+    /// <param name="components">Built-in chips of the netlist components</param>
+    using EvaluateFunction = void (*)(uint8_t* values, BuiltinChip* const* components, bool isTick);
+
+    /// <summary>
+    /// Registers the compiled chip, generated code creates a static instance.
+    /// </summary>
+    struct Registration
+    {
+        Registration(const char* chipName, uint64_t fingerprint, EvaluateFunction function);
+    };
+
+    /// <summary>
+    /// Returns the compiled function of the netlist or nullptr.
+    /// </summary>
+    static EvaluateFunction find(const Netlist& netlist);
+    /// <summary>
+    /// Returns the hash of wires, gates, components and their evaluation order.
+    /// </summary>
+    static uint64_t getFingerprint(const Netlist& netlist);
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+enum class ETestResult
+{
+    UNDEFINED = 0,
+    PASSED = 1,
+    FAILED = 2,
+    // the script does not test a chip, e.g. it loads an .asm file into the CPUEmulator
+    SKIPPED = 3
+};
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include "HdlParser.h"
+#include "HardwareSimulatorError.h"
+
+using namespace std;
+
+/// <summary>
+/// Parses the .hdl file. May throw HardwareSimulatorError.
+/// </summary>
+ChipDeclaration HdlParser::parse(const filesystem::path& path)
+{
+    ifstream file(path);
+    if (!file.is_open())
+    {
+        throw HardwareSimulatorError("Cannot open " + path.string() + " file.");
+    }
+    return parse(file, path.string());
+}
+
+/// <summary>
+/// Parses HDL code from the stream. May throw HardwareSimulatorError.
+/// </summary>
+/// <param name="fileName">Name of the file used in error messages</param>
+ChipDeclaration HdlParser::parse(istream& stream, const string& fileName)
+{
+    HdlParser parser(stream, fileName);
+    auto chip = parser.parseChip();
+    chip.fileName = fileName;
+    return chip;
+}
+
+HdlParser::HdlParser(istream& stream, const string& fileName)
+    : mFileName(fileName)
+{
+    ostringstream content;
+    content << stream.rdbuf();
+    auto code = content.str();
+
+    int line = 1;
+    size_t i = 0;
+    while (i < code.size())
+    {
+        char c = code[i];
+        if (c == '\n')
+        {
+            line++;
+            i++;
+        }
+        else if (isspace(static_cast<unsigned char>(c)))
+        {
+            i++;
+        }
+        else if (code.compare(i, 2, "//") == 0)
+        {
+            i = code.find('\n', i);
+            i = i == string::npos ? code.size() : i;
+        }
+        else if (code.compare(i, 2, "/*") == 0)
+        {
+            auto end = code.find("*/", i + 2);
+            end = end == string::npos ? code.size() : end + 2;
+            for (; i < end; i++)
+            {
+                line += code[i] == '\n';
+            }
+        }
+        else if (isalnum(static_cast<unsigned char>(c)) || c == '_')
+        {
+            auto begin = i;
+            while (i < code.size() && (isalnum(static_cast<unsigned char>(code[i])) || code[i] == '_'))
+            {
+                i++;
+            }
+            mTokens.push_back({ code.substr(begin, i - begin), line });
+        }
+        else if (code.compare(i, 2, "..") == 0)
+        {
+            mTokens.push_back({ "..", line });
+            i += 2;
+        }
+        else
+        {
+            mTokens.push_back({ string(1, c), line });
+            i++;
+        }
+    }
+    mTokens.push_back({ "", line });
+}
+
+ChipDeclaration HdlParser::parseChip()
+{
+    ChipDeclaration chip;
+    expect("CHIP");
+    chip.name = next().text;
+    if (!isIdentifier(chip.name))
+    {
+        fail("Expected chip name");
+    }
+    expect("{");
+
+    while (peek().text != "}")
+    {
+        auto keyword = next().text;
+        if (keyword == "IN")
+        {
+            chip.inputs = parsePinDeclarations();
+        }
+        else if (keyword == "OUT")
+        {
+            chip.outputs = parsePinDeclarations();
+        }
+        else if (keyword == "BUILTIN")
+        {
+            chip.builtinName = next().text;
+            expect(";");
+        }
+        else if (keyword == "CLOCKED")
+        {
+            chip.clockedPins = parseNames();
+        }
+        else if (keyword == "PARTS")
+        {
+            expect(":");
+            while (peek().text != "}" && !peek().text.empty())
+            {
+                chip.parts.push_back(parsePart());
+            }
+        }
+        else
+        {
+            mPosition--;
+            fail("Expected IN, OUT, PARTS, BUILTIN or CLOCKED");
+        }
+    }
+    expect("}");
+    return chip;
+}
+
+vector<PinDeclaration> HdlParser::parsePinDeclarations()
+{
+    vector<PinDeclaration> pins;
+    do
+    {
+        PinDeclaration pin;
+        pin.name = next().text;
+        if (!isIdentifier(pin.name))
+        {
+            mPosition--;
+            fail("Expected pin name");
+        }
+        if (peek().text == "[")
+        {
+            next();
+            pin.width = parseNumber();
+            expect("]");
+        }
+        if (pin.width < 1 || pin.width > 16)
+        {
+            fail("Width of the pin " + pin.name + " must be between 1 and 16");
+        }
+        pins.push_back(pin);
+    } while (next().text == ",");
+
+    mPosition--;
+    expect(";");
+    return pins;
+}
+
+PartDeclaration HdlParser::parsePart()
+{
+    PartDeclaration part;
+    part.line = peek().line;
+    part.chipName = next().text;
+    if (!isIdentifier(part.chipName))
+    {
+        mPosition--;
+        fail("Expected part name");
+    }
+    expect("(");
+    do
+    {
+        Connection connection;
+        connection.part = parsePinReference();
+        expect("=");
+        connection.chip = parsePinReference();
+        part.connections.push_back(connection);
+    } while (next().text == ",");
+
+    mPosition--;
+    expect(")");
+    expect(";");
+    return part;
+}
+
+PinReference HdlParser::parsePinReference()
+{
+    PinReference pin;
+    pin.name = next().text;
+    if (!isIdentifier(pin.name))
+    {
+        mPosition--;
+        fail("Expected pin name");
+    }
+    if (peek().text == "[")
+    {
+        next();
+        pin.from = parseNumber();
+        pin.to = pin.from;
+        if (peek().text == "..")
+        {
+            next();
+            pin.to = parseNumber();
+        }
+        expect("]");
+        if (pin.to < pin.from || pin.to > 15)
+        {
+            fail("Invalid sub bus of the pin " + pin.name);
+        }
+    }
+    return pin;
+}
+
+vector<string> HdlParser::parseNames()
+{
+    vector<string> names;
+    do
+    {
+        names.push_back(next().text);
+    } while (next().text == ",");
+
+    mPosition--;
+    expect(";");
+    return names;
+}
+
+int HdlParser::parseNumber()
+{
+    const auto& token = next();
+    if (token.text.empty() || token.text.find_first_not_of("0123456789") != string::npos || token.text.size() > 5)
+    {
+        mPosition--;
+        fail("Expected number");
+    }
+    return stoi(token.text);
+}
+
+// the last token is empty and marks the end of the file
+const HdlParser::Token& HdlParser::peek() const
+{
+    return mTokens[min(mPosition, mTokens.size() - 1)];
+}
+
+const HdlParser::Token& HdlParser::next()
+{
+    const auto& token = peek();
+    mPosition++;
+    return token;
+}
+
+void HdlParser::expect(const string& text)
+{
+    if (next().text != text)
+    {
+        mPosition--;
+        fail("Expected '" + text + "'");
+    }
+}
+
+bool HdlParser::isIdentifier(const string& text) const
+{
+    return !text.empty() && (isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_');
+}
+
+void HdlParser::fail(const string& message) const
+{
+    const auto& token = peek();
+    throw HardwareSimulatorError(mFileName + ":" + to_string(token.line) + ": " + message
+        + (token.text.empty() ? " at the end of the file." : ", found '" + token.text + "'."));
+}
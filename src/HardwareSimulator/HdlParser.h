@@ -0,0 +1,50 @@
+#pragma once
+#include <filesystem>
+#include <istream>
+#include <string>
+#include <vector>
+#include "ChipDeclaration.h"
+
+/// <summary>
+/// The module parses a chip definition from a .hdl file.
+/// <para/> Both chips made of parts and built-in chips declared by "BUILTIN Name;" and "CLOCKED pins;" are supported.
+/// </summary>
+class HdlParser
+{
+public:
+    /// <summary>
+    /// Parses the .hdl file. May throw HardwareSimulatorError.
+    /// </summary>
+    static ChipDeclaration parse(const std::filesystem::path& path);
+    /// <summary>
+    /// Parses HDL code from the stream. May throw HardwareSimulatorError.
+    /// </summary>
+    /// <param name="fileName">Name of the file used in error messages</param>
+    static ChipDeclaration parse(std::istream& stream, const std::string& fileName);
+
+private:
+    struct Token
+    {
+        std::string text;
+        int line = 0;
+    };
+
+    HdlParser(std::istream& stream, const std::string& fileName);
+
+    ChipDeclaration parseChip();
+    std::vector<PinDeclaration> parsePinDeclarations();
+    PartDeclaration parsePart();
+    PinReference parsePinReference();
+    std::vector<std::string> parseNames();
+    int parseNumber();
+
+    const Token& peek() const;
+    const Token& next();
+    void expect(const std::string& text);
+    bool isIdentifier(const std::string& text) const;
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::string mFileName;
+    std::vector<Token> mTokens;
+    size_t mPosition = 0;
+};
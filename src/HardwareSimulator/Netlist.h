@@ -0,0 +1,53 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BuiltinChip.h"
+#include "ChipDeclaration.h"
+
+/// <summary>
+/// Chip flattened into Nand gates and built-in components connected by single bit wires.
+/// </summary>
+struct Netlist
+{
+    static constexpr int FALSE_WIRE = 0;
+    static constexpr int TRUE_WIRE = 1;
+
+    struct NandGate
+    {
+        int a = FALSE_WIRE;
+        int b = FALSE_WIRE;
+        int out = FALSE_WIRE;
+    };
+
+    struct Component
+    {
+        std::string chipName;
+        std::string builtinName;
+        std::unique_ptr<BuiltinChip> chip;
+        // wires of the pins in the order of the declaration, the least significant bit first
+        std::vector<std::vector<int>> inputs;
+        std::vector<std::vector<int>> outputs;
+        std::vector<bool> isInputClocked;
+    };
+
+    /// <summary>
+    /// Gate or component, whose inputs are computed by the preceding nodes of the evaluation order.
+    /// </summary>
+    struct Node
+    {
+        bool isGate = true;
+        int index = 0;
+    };
+
+    ChipDeclaration chip;
+    int wireCount = 2;
+    std::vector<NandGate> gates;
+    std::vector<Component> components;
+    std::vector<Node> order;
+    /// <summary>
+    /// Wires of the inputs, outputs and internal pins of the chip.
+    /// </summary>
+    std::unordered_map<std::string, std::vector<int>> pins;
+};
@@ -0,0 +1,602 @@
+#include <algorithm>
+#include "BuiltinChips.h"
+#include "HardwareSimulatorError.h"
+#include "NetlistBuilder.h"
+
+using namespace std;
+
+bool isConstant(const string& pinName)
+{
+    return pinName == "true" || pinName == "false";
+}
+
+NetlistBuilder::NetlistBuilder(ChipLibrary& library, bool expandBuiltinChips)
+    : mLibrary(library),
+    mExpandBuiltinChips(expandBuiltinChips)
+{
+}
+
+/// <summary>
+/// Builds the netlist of the chip. May throw HardwareSimulatorError.
+/// </summary>
+Netlist NetlistBuilder::build(const string& chipName)
+{
+    mNetlist = Netlist();
+    mParents = { Netlist::FALSE_WIRE, Netlist::TRUE_WIRE };
+    mChipStack.clear();
+
+    const auto& chip = mLibrary.find(chipName);
+    mNetlist.chip = chip;
+
+    PinWires pins;
+    vector<int> inputWires;
+    for (const auto& pin : chip.inputs)
+    {
+        auto& wires = pins[pin.name];
+        for (int i = 0; i < pin.width; i++)
+        {
+            wires.push_back(createWire());
+            inputWires.push_back(wires.back());
+        }
+    }
+    for (const auto& pin : chip.outputs)
+    {
+        auto& wires = pins[pin.name];
+        for (int i = 0; i < pin.width; i++)
+        {
+            wires.push_back(createWire());
+        }
+    }
+
+    instantiate(chip, pins);
+    mNetlist.pins = std::move(pins);
+    compactWires(inputWires);
+    levelize();
+    return std::move(mNetlist);
+}
+
+/// <summary>
+/// Adds gates and components of the chip. Internal pins of the chip are added to the pins.
+/// </summary>
+void NetlistBuilder::instantiate(const ChipDeclaration& chip, PinWires& pins)
+{
+    if (chip.builtinName == "Nand")
+    {
+        mNetlist.gates.push_back({ pins[chip.inputs[0].name][0], pins[chip.inputs[1].name][0], pins[chip.outputs[0].name][0] });
+        return;
+    }
+
+    if (!chip.builtinName.empty() && mExpandBuiltinChips && expandBuiltinChip(chip, pins))
+    {
+        return;
+    }
+    if (!chip.builtinName.empty())
+    {
+        Netlist::Component component;
+        component.chipName = chip.name;
+        component.builtinName = chip.builtinName;
+        component.chip = BuiltinChips::create(chip);
+        for (const auto& pin : chip.inputs)
+        {
+            component.inputs.push_back(pins[pin.name]);
+            auto isClocked = find(chip.clockedPins.begin(), chip.clockedPins.end(), pin.name) != chip.clockedPins.end();
+            component.isInputClocked.push_back(isClocked && component.chip->isClocked());
+        }
+        for (const auto& pin : chip.outputs)
+        {
+            component.outputs.push_back(pins[pin.name]);
+        }
+        mNetlist.components.push_back(std::move(component));
+        return;
+    }
+
+    if (find(mChipStack.begin(), mChipStack.end(), chip.name) != mChipStack.end())
+    {
+        throw HardwareSimulatorError("Chip " + chip.name + " is used as its own part.");
+    }
+    mChipStack.push_back(chip.name);
+
+    createInternalPins(chip, pins);
+    // bits of the outputs and internal pins, which already have a source
+    unordered_map<string, vector<bool>> assignedBits;
+    for (const auto& part : chip.parts)
+    {
+        connectPart(chip, part, pins, assignedBits);
+    }
+
+    mChipStack.pop_back();
+}
+
+/// <summary>
+/// Replaces the combinational built-in chip by Nand gates. Returns false for other chips.
+/// </summary>
+bool NetlistBuilder::expandBuiltinChip(const ChipDeclaration& chip, PinWires& pins)
+{
+    auto nand = [this](int a, int b) { return addNand(a, b); };
+    auto negate = [this](int a) { return addNand(a, a); };
+    auto conjunct = [&](int a, int b) { return negate(nand(a, b)); };
+    auto disjunct = [&](int a, int b) { return nand(negate(a), negate(b)); };
+    auto exclude = [&](int a, int b)
+    {
+        int both = nand(a, b);
+        return nand(nand(a, both), nand(b, both));
+    };
+    auto select = [&](int a, int b, int sel) { return nand(nand(a, negate(sel)), nand(b, sel)); };
+    // sum and carry
+    auto addBits = [&](int a, int b, int carry)
+    {
+        int halfSum = exclude(a, b);
+        return pair<int, int>(exclude(halfSum, carry), disjunct(conjunct(a, b), conjunct(halfSum, carry)));
+    };
+    auto add = [&](const vector<int>& a, const vector<int>& b)
+    {
+        vector<int> sum(a.size());
+        int carry = Netlist::FALSE_WIRE;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            tie(sum[i], carry) = addBits(a[i], b[i], carry);
+        }
+        return sum;
+    };
+    auto bitwise = [](const vector<int>& a, const vector<int>& b, const auto& function)
+    {
+        vector<int> result(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            result[i] = function(a[i], b[i]);
+        }
+        return result;
+    };
+    // selects one of the inputs by the sel bits, the first input for sel 0
+    auto multiplex = [&](vector<vector<int>> inputs, const vector<int>& sel)
+    {
+        for (size_t bit = 0; inputs.size() > 1; bit++)
+        {
+            vector<vector<int>> selected;
+            for (size_t i = 0; i < inputs.size(); i += 2)
+            {
+                selected.push_back(bitwise(inputs[i], inputs[i + 1], [&](int a, int b) { return select(a, b, sel[bit]); }));
+            }
+            inputs = std::move(selected);
+        }
+        return inputs[0];
+    };
+    auto demultiplex = [&](int in, const vector<int>& sel)
+    {
+        vector<int> outputs(size_t(1) << sel.size(), in);
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            for (size_t bit = 0; bit < sel.size(); bit++)
+            {
+                outputs[i] = conjunct(outputs[i], (i >> bit) & 1 ? sel[bit] : negate(sel[bit]));
+            }
+        }
+        return outputs;
+    };
+
+    auto input = [&](size_t index) { return pins[chip.inputs[index].name]; };
+    auto output = [&](size_t index, const vector<int>& wires)
+    {
+        // the output pin is merged with the wires computing it
+        const auto& outputWires = pins[chip.outputs[index].name];
+        for (size_t i = 0; i < outputWires.size(); i++)
+        {
+            mParents[findRoot(outputWires[i])] = findRoot(wires[i]);
+        }
+    };
+
+    const auto& name = chip.builtinName;
+    if (name == "Not" || name == "Not16")
+    {
+        output(0, bitwise(input(0), input(0), [&](int a, int) { return negate(a); }));
+    }
+    else if (name == "And")
+    {
+        output(0, bitwise(input(0), input(1), conjunct));
+    }
+    else if (name == "Or")
+    {
+        output(0, bitwise(input(0), input(1), disjunct));
+    }
+    else if (name == "Xor")
+    {
+        output(0, bitwise(input(0), input(1), exclude));
+    }
+    else if (name == "Mux")
+    {
+        output(0, multiplex({ input(0), input(1) }, input(2)));
+    }
+    else if (name == "Mux4Way16" || name == "Mux8Way16")
+    {
+        vector<vector<int>> inputs;
+        for (size_t i = 0; i + 1 < chip.inputs.size(); i++)
+        {
+            inputs.push_back(input(i));
+        }
+        output(0, multiplex(inputs, input(chip.inputs.size() - 1)));
+    }
+    else if (name == "DMux" || name == "DMux4Way" || name == "DMux8Way")
+    {
+        auto outputs = demultiplex(input(0)[0], input(1));
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            output(i, { outputs[i] });
+        }
+    }
+    else if (name == "Or8Way")
+    {
+        auto in = input(0);
+        int result = in[0];
+        for (size_t i = 1; i < in.size(); i++)
+        {
+            result = disjunct(result, in[i]);
+        }
+        output(0, { result });
+    }
+    else if (name == "HalfAdder" || name == "FullAdder")
+    {
+        auto carryIn = name == "FullAdder" ? input(2)[0] : Netlist::FALSE_WIRE;
+        auto [sum, carry] = addBits(input(0)[0], input(1)[0], carryIn);
+        output(0, { sum });
+        output(1, { carry });
+    }
+    else if (name == "Add16")
+    {
+        output(0, add(input(0), input(1)));
+    }
+    else if (name == "Inc16")
+    {
+        vector<int> one(16, Netlist::FALSE_WIRE);
+        one[0] = Netlist::TRUE_WIRE;
+        output(0, add(input(0), one));
+    }
+    else if (name == "ALU")
+    {
+        // x, y, zx, nx, zy, ny, f, no
+        auto prepare = [&](const vector<int>& in, int zero, int negation)
+        {
+            return bitwise(in, in, [&](int a, int) { return exclude(conjunct(a, negate(zero)), negation); });
+        };
+        auto x = prepare(input(0), input(2)[0], input(3)[0]);
+        auto y = prepare(input(1), input(4)[0], input(5)[0]);
+        auto result = multiplex({ bitwise(x, y, conjunct), add(x, y) }, input(6));
+        result = bitwise(result, result, [&](int a, int) { return exclude(a, input(7)[0]); });
+
+        int isNonZero = result[0];
+        for (size_t i = 1; i < result.size(); i++)
+        {
+            isNonZero = disjunct(isNonZero, result[i]);
+        }
+        output(0, result);
+        output(1, { negate(isNonZero) });
+        output(2, { result[15] });
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void NetlistBuilder::createInternalPins(const ChipDeclaration& chip, PinWires& pins)
+{
+    for (const auto& part : chip.parts)
+    {
+        const auto& partChip = mLibrary.find(part.chipName);
+        for (const auto& connection : part.connections)
+        {
+            const auto* output = partChip.findOutput(connection.part.name);
+            const auto& pinName = connection.chip.name;
+            if (!output || isConstant(pinName) || chip.findInput(pinName) || chip.findOutput(pinName))
+            {
+                continue;
+            }
+            if (connection.chip.hasRange())
+            {
+                fail(chip, part.line, "Sub bus of internal pin " + pinName + " cannot be used");
+            }
+
+            // the width is given by the first source, other sources are reported by connectPart
+            auto& wires = pins[pinName];
+            int width = connection.part.hasRange() ? connection.part.to - connection.part.from + 1 : output->width;
+            for (int i = wires.empty() ? 0 : width; i < width; i++)
+            {
+                wires.push_back(createWire());
+            }
+        }
+    }
+}
+
+void NetlistBuilder::connectPart(const ChipDeclaration& chip, const PartDeclaration& part, PinWires& pins,
+    unordered_map<string, vector<bool>>& assignedBits)
+{
+    const auto& partChip = mLibrary.find(part.chipName);
+    PinWires partPins;
+    for (const auto& pin : partChip.inputs)
+    {
+        partPins[pin.name].assign(pin.width, Netlist::FALSE_WIRE);
+    }
+    for (const auto& pin : partChip.outputs)
+    {
+        auto& wires = partPins[pin.name];
+        for (int i = 0; i < pin.width; i++)
+        {
+            wires.push_back(createWire());
+        }
+    }
+
+    for (const auto& connection : part.connections)
+    {
+        const auto& partPinName = connection.part.name;
+        const auto& chipPinName = connection.chip.name;
+        const auto* input = partChip.findInput(partPinName);
+        const auto* output = partChip.findOutput(partPinName);
+        if (!input && !output)
+        {
+            fail(chip, part.line, "Chip " + partChip.name + " has no pin " + partPinName);
+        }
+        auto& partWires = partPins[partPinName];
+        int from = connection.part.hasRange() ? connection.part.from : 0;
+        int to = connection.part.hasRange() ? connection.part.to : static_cast<int>(partWires.size()) - 1;
+        if (from > to || to >= static_cast<int>(partWires.size()))
+        {
+            fail(chip, part.line, "Sub bus of pin " + partPinName + " is out of its range");
+        }
+        int width = to - from + 1;
+
+        if (input)
+        {
+            if (isConstant(chipPinName))
+            {
+                fill(partWires.begin() + from, partWires.begin() + to + 1, chipPinName == "true" ? Netlist::TRUE_WIRE : Netlist::FALSE_WIRE);
+                continue;
+            }
+            if (chip.findOutput(chipPinName))
+            {
+                fail(chip, part.line, "Output pin " + chipPinName + " cannot be used as an input of a part");
+            }
+            auto it = pins.find(chipPinName);
+            if (it == pins.end())
+            {
+                fail(chip, part.line, "Pin " + chipPinName + " has no source");
+            }
+            auto chipWires = selectWires(chip, part, connection.chip, it->second, !chip.findInput(chipPinName));
+            if (static_cast<int>(chipWires.size()) != width)
+            {
+                fail(chip, part.line, "Width of pin " + chipPinName + " differs from the width of pin " + partPinName);
+            }
+            copy(chipWires.begin(), chipWires.end(), partWires.begin() + from);
+            continue;
+        }
+
+        if (isConstant(chipPinName) || chip.findInput(chipPinName))
+        {
+            fail(chip, part.line, "Output pin " + partPinName + " cannot be connected to " + chipPinName);
+        }
+        auto chipWires = selectWires(chip, part, connection.chip, pins[chipPinName], !chip.findOutput(chipPinName));
+        if (static_cast<int>(chipWires.size()) != width)
+        {
+            fail(chip, part.line, "Width of pin " + chipPinName + " differs from the width of pin " + partPinName);
+        }
+
+        // sub bus of the output pin selects the assigned bits
+        auto& assigned = assignedBits[chipPinName];
+        assigned.resize(pins[chipPinName].size());
+        int offset = connection.chip.hasRange() ? connection.chip.from : 0;
+        for (int i = 0; i < width; i++)
+        {
+            if (assigned[offset + i])
+            {
+                fail(chip, part.line, "Pin " + chipPinName + " has more than one source");
+            }
+            assigned[offset + i] = true;
+
+            auto partRoot = findRoot(partWires[from + i]);
+            mParents[partRoot] = findRoot(chipWires[i]);
+        }
+    }
+
+    instantiate(partChip, partPins);
+}
+
+vector<int> NetlistBuilder::selectWires(const ChipDeclaration& chip, const PartDeclaration& part, const PinReference& reference,
+    const vector<int>& wires, bool isInternal) const
+{
+    if (!reference.hasRange())
+    {
+        return wires;
+    }
+    if (isInternal)
+    {
+        fail(chip, part.line, "Sub bus of internal pin " + reference.name + " cannot be used");
+    }
+    if (reference.from > reference.to || reference.to >= static_cast<int>(wires.size()))
+    {
+        fail(chip, part.line, "Sub bus of pin " + reference.name + " is out of its range");
+    }
+    return vector<int>(wires.begin() + reference.from, wires.begin() + reference.to + 1);
+}
+
+int NetlistBuilder::createWire()
+{
+    mParents.push_back(static_cast<int>(mParents.size()));
+    return mParents.back();
+}
+
+int NetlistBuilder::addNand(int a, int b)
+{
+    int out = createWire();
+    mNetlist.gates.push_back({ a, b, out });
+    return out;
+}
+
+int NetlistBuilder::findRoot(int wire)
+{
+    while (mParents[wire] != wire)
+    {
+        mParents[wire] = mParents[mParents[wire]];
+        wire = mParents[wire];
+    }
+    return wire;
+}
+
+/// <summary>
+/// Replaces merged wires by their roots and numbers them from 0. Wires without a source become false.
+/// </summary>
+void NetlistBuilder::compactWires(const vector<int>& inputWires)
+{
+    vector<bool> isDriven(mParents.size(), false);
+    isDriven[Netlist::FALSE_WIRE] = true;
+    isDriven[Netlist::TRUE_WIRE] = true;
+    for (auto wire : inputWires)
+    {
+        isDriven[findRoot(wire)] = true;
+    }
+    for (const auto& gate : mNetlist.gates)
+    {
+        isDriven[findRoot(gate.out)] = true;
+    }
+    for (const auto& component : mNetlist.components)
+    {
+        for (const auto& wires : component.outputs)
+        {
+            for (auto wire : wires)
+            {
+                isDriven[findRoot(wire)] = true;
+            }
+        }
+    }
+
+    vector<int> indexes(mParents.size(), -1);
+    int wireCount = 0;
+    auto map = [&](int& wire)
+    {
+        auto root = findRoot(wire);
+        if (!isDriven[root])
+        {
+            wire = Netlist::FALSE_WIRE;
+            return;
+        }
+        if (indexes[root] < 0)
+        {
+            indexes[root] = wireCount++;
+        }
+        wire = indexes[root];
+    };
+
+    // constants keep their indexes
+    int falseWire = Netlist::FALSE_WIRE;
+    int trueWire = Netlist::TRUE_WIRE;
+    map(falseWire);
+    map(trueWire);
+    for (auto& gate : mNetlist.gates)
+    {
+        map(gate.a);
+        map(gate.b);
+        map(gate.out);
+    }
+    for (auto& component : mNetlist.components)
+    {
+        for (auto* pins : { &component.inputs, &component.outputs })
+        {
+            for (auto& wires : *pins)
+            {
+                for_each(wires.begin(), wires.end(), map);
+            }
+        }
+    }
+    for (auto& [name, wires] : mNetlist.pins)
+    {
+        for_each(wires.begin(), wires.end(), map);
+    }
+    mNetlist.wireCount = wireCount;
+}
+
+/// <summary>
+/// Orders gates and components, so that every node is evaluated after the sources of its inputs.
+/// Clocked inputs of components do not create dependencies.
+/// </summary>
+void NetlistBuilder::levelize()
+{
+    int gateCount = static_cast<int>(mNetlist.gates.size());
+    int nodeCount = gateCount + static_cast<int>(mNetlist.components.size());
+    vector<int> sources(mNetlist.wireCount, -1);
+    for (int i = 0; i < gateCount; i++)
+    {
+        sources[mNetlist.gates[i].out] = i;
+    }
+    for (int i = gateCount; i < nodeCount; i++)
+    {
+        for (const auto& wires : mNetlist.components[i - gateCount].outputs)
+        {
+            for (auto wire : wires)
+            {
+                sources[wire] = i;
+            }
+        }
+    }
+
+    vector<vector<int>> fanouts(nodeCount);
+    vector<int> inputCounts(nodeCount, 0);
+    auto addInput = [&](int node, int wire)
+    {
+        if (sources[wire] >= 0)
+        {
+            fanouts[sources[wire]].push_back(node);
+            inputCounts[node]++;
+        }
+    };
+    for (int i = 0; i < gateCount; i++)
+    {
+        addInput(i, mNetlist.gates[i].a);
+        addInput(i, mNetlist.gates[i].b);
+    }
+    for (int i = gateCount; i < nodeCount; i++)
+    {
+        const auto& component = mNetlist.components[i - gateCount];
+        for (size_t pin = 0; pin < component.inputs.size(); pin++)
+        {
+            if (component.isInputClocked[pin])
+            {
+                continue;
+            }
+            for (auto wire : component.inputs[pin])
+            {
+                addInput(i, wire);
+            }
+        }
+    }
+
+    vector<int> readyNodes;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if (inputCounts[i] == 0)
+        {
+            readyNodes.push_back(i);
+        }
+    }
+    mNetlist.order.clear();
+    for (size_t i = 0; i < readyNodes.size(); i++)
+    {
+        int node = readyNodes[i];
+        mNetlist.order.push_back(node < gateCount ? Netlist::Node{ true, node } : Netlist::Node{ false, node - gateCount });
+        for (auto fanout : fanouts[node])
+        {
+            if (--inputCounts[fanout] == 0)
+            {
+                readyNodes.push_back(fanout);
+            }
+        }
+    }
+
+    if (static_cast<int>(mNetlist.order.size()) != nodeCount)
+    {
+        throw HardwareSimulatorError("Chip " + mNetlist.chip.name + " has a combinational loop, "
+            "a loop has to go through a clocked part.");
+    }
+}
+
+[[noreturn]] void NetlistBuilder::fail(const ChipDeclaration& chip, int line, const string& message) const
+{
+    throw HardwareSimulatorError(chip.fileName + ":" + to_string(line) + ": " + message + ".");
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ChipLibrary.h"
+#include "Netlist.h"
+
+/// <summary>
+/// NetlistBuilder flattens the chip and its parts into the Netlist.
+/// <para/> Pins connected by parts are merged into single wires, unconnected part inputs and pins without
+///     a source are connected to false. Gates and components are sorted by their combinational dependencies.
+/// <para/> Combinational built-in chips can be expanded into Nand gates, e.g. for the BitSlicedEvaluator.
+/// </summary>
+class NetlistBuilder
+{
+public:
+    explicit NetlistBuilder(ChipLibrary& library, bool expandBuiltinChips = false);
+
+    /// <summary>
+    /// Builds the netlist of the chip. May throw HardwareSimulatorError.
+    /// </summary>
+    Netlist build(const std::string& chipName);
+
+private:
+    using PinWires = std::unordered_map<std::string, std::vector<int>>;
+
+    void instantiate(const ChipDeclaration& chip, PinWires& pins);
+    bool expandBuiltinChip(const ChipDeclaration& chip, PinWires& pins);
+    void createInternalPins(const ChipDeclaration& chip, PinWires& pins);
+    void connectPart(const ChipDeclaration& chip, const PartDeclaration& part, PinWires& pins,
+        std::unordered_map<std::string, std::vector<bool>>& assignedBits);
+    std::vector<int> selectWires(const ChipDeclaration& chip, const PartDeclaration& part, const PinReference& reference,
+        const std::vector<int>& wires, bool isInternal) const;
+
+    int createWire();
+    int addNand(int a, int b);
+    int findRoot(int wire);
+    void compactWires(const std::vector<int>& inputWires);
+    void levelize();
+    [[noreturn]] void fail(const ChipDeclaration& chip, int line, const std::string& message) const;
+
+    ChipLibrary& mLibrary;
+    bool mExpandBuiltinChips;
+    Netlist mNetlist;
+    // union-find of the merged wires
+    std::vector<int> mParents;
+    std::vector<std::string> mChipStack;
+};
@@ -0,0 +1,460 @@
+#include <algorithm>
+#include "HardwareSimulatorError.h"
+#include "Simulator.h"
+
+using namespace std;
+
+/// <summary>
+/// Creates Simulator of the netlist.
+/// </summary>
+/// <param name="isEventDriven">Whether only changed signals are propagated instead of evaluating the whole netlist</param>
+Simulator::Simulator(Netlist netlist, bool isEventDriven)
+    : mNetlist(std::move(netlist)),
+    mValues(mNetlist.wireCount, 0)
+{
+    mValues[Netlist::TRUE_WIRE] = 1;
+    size_t maxPinCount = 0;
+    for (auto& component : mNetlist.components)
+    {
+        if (component.chip->isClocked())
+        {
+            mClockedComponents.push_back(&component);
+        }
+        maxPinCount = max({ maxPinCount, component.inputs.size(), component.outputs.size() });
+        mComponentChips.push_back(component.chip.get());
+    }
+    mCompiledFunction = CompiledChips::find(mNetlist);
+    mInputs.resize(maxPinCount);
+    mOutputs.resize(maxPinCount);
+
+    // the compiled code always evaluates the whole netlist
+    mIsEventDriven = isEventDriven && !mCompiledFunction;
+    if (mIsEventDriven)
+    {
+        buildFanouts();
+    }
+}
+
+/// <summary>
+/// Propagates the inputs through the combinational logic.
+/// </summary>
+void Simulator::evaluate()
+{
+    mEvaluationCount++;
+    if (mCompiledFunction)
+    {
+        mCompiledFunction(mValues.data(), mComponentChips.data(), false);
+        mNodeEvaluationCount += mNetlist.order.size();
+        return;
+    }
+    if (mIsEventDriven)
+    {
+        propagate();
+        return;
+    }
+
+    mNodeEvaluationCount += mNetlist.order.size();
+    auto* values = mValues.data();
+    for (const auto& node : mNetlist.order)
+    {
+        if (node.isGate)
+        {
+            const auto& gate = mNetlist.gates[node.index];
+            values[gate.out] = !(values[gate.a] & values[gate.b]);
+        }
+        else
+        {
+            evaluateComponent(mNetlist.components[node.index]);
+        }
+    }
+}
+
+/// <summary>
+/// Rising edge of the clock, clocked components read their inputs.
+/// </summary>
+void Simulator::tick()
+{
+    mIsTicked = true;
+    if (mCompiledFunction)
+    {
+        mEvaluationCount++;
+        mCompiledFunction(mValues.data(), mComponentChips.data(), true);
+        mNodeEvaluationCount += mNetlist.order.size();
+        return;
+    }
+
+    evaluate();
+    auto clockUp = [this](Netlist::Component& component)
+    {
+        for (size_t i = 0; i < component.inputs.size(); i++)
+        {
+            mInputs[i] = readWires(component.inputs[i]);
+        }
+        component.chip->clockUp(mInputs.data());
+    };
+    if (!mIsEventDriven)
+    {
+        for (auto* component : mClockedComponents)
+        {
+            clockUp(*component);
+        }
+        return;
+    }
+
+    for (int node : mChangedClockedNodes)
+    {
+        clockUp(mNetlist.components[mNetlist.order[node].index]);
+        mIsClockedNodeChanged[node] = false;
+        mTickedNodes.push_back(node);
+    }
+    mChangedClockedNodes.clear();
+    for (int node : mAlwaysClockedNodes)
+    {
+        clockUp(mNetlist.components[mNetlist.order[node].index]);
+        mTickedNodes.push_back(node);
+    }
+}
+
+/// <summary>
+/// Falling edge of the clock, clocked components change their state and outputs.
+/// </summary>
+void Simulator::tock()
+{
+    if (mIsEventDriven)
+    {
+        // other clocked components keep their state
+        for (int node : mTickedNodes)
+        {
+            if (mNetlist.components[mNetlist.order[node].index].chip->clockDown())
+            {
+                schedule(node);
+            }
+        }
+        mTickedNodes.clear();
+    }
+    else
+    {
+        for (auto* component : mClockedComponents)
+        {
+            component->chip->clockDown();
+        }
+    }
+    evaluate();
+    mTime++;
+    mIsTicked = false;
+}
+
+/// <summary>
+/// Returns the time of the clock, "N" after tock and "N+" after tick.
+/// </summary>
+string Simulator::getTime() const
+{
+    return to_string(mTime) + (mIsTicked ? "+" : "");
+}
+
+/// <summary>
+/// Returns the count of clock edges, twice the time after tock.
+/// </summary>
+long long Simulator::getClockEdgeCount() const
+{
+    return 2LL * mTime + (mIsTicked ? 1 : 0);
+}
+
+bool Simulator::hasPin(const string& pinName) const
+{
+    return mNetlist.pins.count(pinName) > 0;
+}
+
+int Simulator::getPinWidth(const string& pinName) const
+{
+    auto it = mNetlist.pins.find(pinName);
+    return it == mNetlist.pins.end() ? 0 : static_cast<int>(it->second.size());
+}
+
+uint16_t Simulator::getPin(const string& pinName) const
+{
+    auto it = mNetlist.pins.find(pinName);
+    if (it == mNetlist.pins.end())
+    {
+        throw HardwareSimulatorError("Chip " + mNetlist.chip.name + " has no pin " + pinName + ".");
+    }
+    return readWires(it->second);
+}
+
+/// <summary>
+/// Sets the input pin of the chip, the change is propagated by the next evaluation. May throw HardwareSimulatorError.
+/// </summary>
+void Simulator::setPin(const string& pinName, uint16_t value)
+{
+    if (!mNetlist.chip.findInput(pinName))
+    {
+        throw HardwareSimulatorError("Chip " + mNetlist.chip.name + " has no input pin " + pinName + ".");
+    }
+    writeWires(mNetlist.pins.at(pinName), value);
+}
+
+/// <summary>
+/// Returns the first component with the given chip name or nullptr.
+/// </summary>
+BuiltinChip* Simulator::findBuiltinChip(const string& chipName) const
+{
+    for (const auto& component : mNetlist.components)
+    {
+        if (component.chipName == chipName)
+        {
+            return component.chip.get();
+        }
+    }
+    return nullptr;
+}
+
+/// <summary>
+/// Schedules the component after its state was changed outside of the clock, e.g. by the test script.
+/// </summary>
+void Simulator::markStateChanged(const BuiltinChip& chip)
+{
+    if (!mIsEventDriven)
+    {
+        return;
+    }
+    for (int node = 0; node < static_cast<int>(mNetlist.order.size()); node++)
+    {
+        const auto& orderNode = mNetlist.order[node];
+        if (!orderNode.isGate && mNetlist.components[orderNode.index].chip.get() == &chip)
+        {
+            schedule(node);
+            if (chip.isClocked())
+            {
+                markClockedNodeChanged(node);
+            }
+            return;
+        }
+    }
+}
+
+const Netlist& Simulator::getNetlist() const
+{
+    return mNetlist;
+}
+
+bool Simulator::isCompiled() const
+{
+    return mCompiledFunction != nullptr;
+}
+
+/// <summary>
+/// Returns the count of evaluations of the combinational logic.
+/// </summary>
+long long Simulator::getEvaluationCount() const
+{
+    return mEvaluationCount;
+}
+
+/// <summary>
+/// Returns the count of evaluated gates and components.
+/// </summary>
+long long Simulator::getNodeEvaluationCount() const
+{
+    return mNodeEvaluationCount;
+}
+
+/// <summary>
+/// Creates fan-out lists of the wires and assigns levels to the nodes, a node is evaluated after its sources.
+/// All nodes are scheduled for the first evaluation.
+/// </summary>
+void Simulator::buildFanouts()
+{
+    const auto& order = mNetlist.order;
+    auto nodeCount = static_cast<int>(order.size());
+    vector<int> drivers(mNetlist.wireCount, -1);
+    vector<vector<Fanout>> wireFanouts(mNetlist.wireCount);
+    mNodeLevels.assign(nodeCount, 0);
+    mIsScheduled.assign(nodeCount, false);
+    mIsClockedNodeChanged.assign(nodeCount, false);
+
+    int maxLevel = 0;
+    for (int node = 0; node < nodeCount; node++)
+    {
+        int level = 0;
+        auto addInput = [&](int wire, bool isEvaluated, bool isClocked)
+        {
+            // constant wires never change
+            if (wire <= Netlist::TRUE_WIRE)
+            {
+                return;
+            }
+            wireFanouts[wire].push_back(Fanout{ node, isEvaluated, isClocked });
+            // sources of the clocked inputs may be evaluated later
+            if (isEvaluated && drivers[wire] >= 0)
+            {
+                level = max(level, mNodeLevels[drivers[wire]] + 1);
+            }
+        };
+
+        if (order[node].isGate)
+        {
+            const auto& gate = mNetlist.gates[order[node].index];
+            addInput(gate.a, true, false);
+            addInput(gate.b, true, false);
+            drivers[gate.out] = node;
+        }
+        else
+        {
+            const auto& component = mNetlist.components[order[node].index];
+            bool isClocked = component.chip->isClocked();
+            for (size_t i = 0; i < component.inputs.size(); i++)
+            {
+                for (int wire : component.inputs[i])
+                {
+                    addInput(wire, !component.isInputClocked[i], isClocked);
+                }
+            }
+            for (const auto& wires : component.outputs)
+            {
+                for (int wire : wires)
+                {
+                    drivers[wire] = node;
+                }
+            }
+
+            if (isClocked && component.chip->keepsStateForSameInputs())
+            {
+                markClockedNodeChanged(node);
+            }
+            else if (isClocked)
+            {
+                // the flag is never cleared, the node is clocked by every tick
+                mIsClockedNodeChanged[node] = true;
+                mAlwaysClockedNodes.push_back(node);
+            }
+        }
+        mNodeLevels[node] = level;
+        maxLevel = max(maxLevel, level);
+    }
+
+    mFanoutBegins.assign(mNetlist.wireCount + 1, 0);
+    for (int wire = 0; wire < mNetlist.wireCount; wire++)
+    {
+        mFanoutBegins[wire + 1] = mFanoutBegins[wire] + static_cast<int>(wireFanouts[wire].size());
+        mFanouts.insert(mFanouts.end(), wireFanouts[wire].begin(), wireFanouts[wire].end());
+    }
+
+    mLevelQueues.resize(maxLevel + 1);
+    for (int node = 0; node < nodeCount; node++)
+    {
+        schedule(node);
+    }
+}
+
+/// <summary>
+/// Evaluates the scheduled nodes level by level. A changed output schedules its fan-outs on the higher levels.
+/// </summary>
+void Simulator::propagate()
+{
+    auto* values = mValues.data();
+    for (auto& queue : mLevelQueues)
+    {
+        for (size_t i = 0; i < queue.size(); i++)
+        {
+            int node = queue[i];
+            mIsScheduled[node] = false;
+            mNodeEvaluationCount++;
+
+            const auto& orderNode = mNetlist.order[node];
+            if (!orderNode.isGate)
+            {
+                evaluateComponent(mNetlist.components[orderNode.index]);
+                continue;
+            }
+            const auto& gate = mNetlist.gates[orderNode.index];
+            uint8_t value = !(values[gate.a] & values[gate.b]);
+            if (values[gate.out] != value)
+            {
+                values[gate.out] = value;
+                scheduleFanouts(gate.out);
+            }
+        }
+        queue.clear();
+    }
+}
+
+void Simulator::schedule(int node)
+{
+    if (!mIsScheduled[node])
+    {
+        mIsScheduled[node] = true;
+        mLevelQueues[mNodeLevels[node]].push_back(node);
+    }
+}
+
+void Simulator::scheduleFanouts(int wire)
+{
+    for (int i = mFanoutBegins[wire]; i < mFanoutBegins[wire + 1]; i++)
+    {
+        const auto& fanout = mFanouts[i];
+        if (fanout.isEvaluated)
+        {
+            schedule(fanout.node);
+        }
+        if (fanout.isClocked)
+        {
+            markClockedNodeChanged(fanout.node);
+        }
+    }
+}
+
+void Simulator::markClockedNodeChanged(int node)
+{
+    if (!mIsClockedNodeChanged[node])
+    {
+        mIsClockedNodeChanged[node] = true;
+        mChangedClockedNodes.push_back(node);
+    }
+}
+
+void Simulator::evaluateComponent(Netlist::Component& component)
+{
+    for (size_t i = 0; i < component.inputs.size(); i++)
+    {
+        mInputs[i] = readWires(component.inputs[i]);
+    }
+    component.chip->evaluate(mInputs.data(), mOutputs.data());
+    for (size_t i = 0; i < component.outputs.size(); i++)
+    {
+        writeWires(component.outputs[i], mOutputs[i]);
+    }
+}
+
+/// <summary>
+/// Returns the value of the wires, the first wire is the least significant bit.
+/// </summary>
+uint16_t Simulator::readWires(const vector<int>& wires) const
+{
+    uint16_t value = 0;
+    for (size_t i = 0; i < wires.size(); i++)
+    {
+        value |= static_cast<uint16_t>(mValues[wires[i]] << i);
+    }
+    return value;
+}
+
+void Simulator::writeWires(const vector<int>& wires, uint16_t value)
+{
+    for (size_t i = 0; i < wires.size(); i++)
+    {
+        // wires without a source are merged into the false wire, it must not be changed
+        if (wires[i] <= Netlist::TRUE_WIRE)
+        {
+            continue;
+        }
+        uint8_t bit = (value >> i) & 1;
+        if (mValues[wires[i]] != bit)
+        {
+            mValues[wires[i]] = bit;
+            if (mIsEventDriven)
+            {
+                scheduleFanouts(wires[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CompiledChips.h"
+#include "Netlist.h"
+
+/// <summary>
+/// Simulator evaluates the netlist in its levelized order and drives the clock of the built-in components.
+/// <para/> The event-driven simulation evaluates only the nodes, whose inputs changed. Changes are propagated
+///     through fan-out lists level by level, registers and memories are clocked only after their inputs changed.
+/// <para/> A netlist compiled into C++ and linked into the simulator is evaluated by the compiled code.
+/// </summary>
+class Simulator
+{
+public:
+    /// <summary>
+    /// Creates Simulator of the netlist.
+    /// </summary>
+    /// <param name="isEventDriven">Whether only changed signals are propagated instead of evaluating the whole netlist</param>
+    explicit Simulator(Netlist netlist, bool isEventDriven = true);
+
+    /// <summary>
+    /// Propagates the inputs through the combinational logic.
+    /// </summary>
+    void evaluate();
+    /// <summary>
+    /// Rising edge of the clock, clocked components read their inputs.
+    /// </summary>
+    void tick();
+    /// <summary>
+    /// Falling edge of the clock, clocked components change their state and outputs.
+    /// </summary>
+    void tock();
+
+    /// <summary>
+    /// Returns the time of the clock, "N" after tock and "N+" after tick.
+    /// </summary>
+    std::string getTime() const;
+    /// <summary>
+    /// Returns the count of clock edges, twice the time after tock.
+    /// </summary>
+    long long getClockEdgeCount() const;
+    bool hasPin(const std::string& pinName) const;
+    int getPinWidth(const std::string& pinName) const;
+    uint16_t getPin(const std::string& pinName) const;
+    /// <summary>
+    /// Returns the value of the wires, the first wire is the least significant bit.
+    /// </summary>
+    uint16_t readWires(const std::vector<int>& wires) const;
+    /// <summary>
+    /// Sets the input pin of the chip, the change is propagated by the next evaluation. May throw HardwareSimulatorError.
+    /// </summary>
+    void setPin(const std::string& pinName, uint16_t value);
+    /// <summary>
+    /// Returns the first component with the given chip name or nullptr.
+    /// </summary>
+    BuiltinChip* findBuiltinChip(const std::string& chipName) const;
+    /// <summary>
+    /// Schedules the component after its state was changed outside of the clock, e.g. by the test script.
+    /// </summary>
+    void markStateChanged(const BuiltinChip& chip);
+    const Netlist& getNetlist() const;
+    bool isCompiled() const;
+    /// <summary>
+    /// Returns the count of evaluations of the combinational logic.
+    /// </summary>
+    long long getEvaluationCount() const;
+    /// <summary>
+    /// Returns the count of evaluated gates and components.
+    /// </summary>
+    long long getNodeEvaluationCount() const;
+
+private:
+    struct Fanout
+    {
+        // position in the evaluation order
+        int node = 0;
+        // clocked inputs do not change the outputs
+        bool isEvaluated = true;
+        // the clocked component is clocked again after the change
+        bool isClocked = false;
+    };
+
+    void buildFanouts();
+    void propagate();
+    void schedule(int node);
+    void scheduleFanouts(int wire);
+    void markClockedNodeChanged(int node);
+    void evaluateComponent(Netlist::Component& component);
+    void writeWires(const std::vector<int>& wires, uint16_t value);
+
+    Netlist mNetlist;
+    std::vector<uint8_t> mValues;
+    std::vector<Netlist::Component*> mClockedComponents;
+    bool mIsEventDriven = false;
+    // fan-outs of the wire are mFanouts[mFanoutBegins[wire]..mFanoutBegins[wire + 1])
+    std::vector<int> mFanoutBegins;
+    std::vector<Fanout> mFanouts;
+    std::vector<int> mNodeLevels;
+    std::vector<std::vector<int>> mLevelQueues;
+    std::vector<uint8_t> mIsScheduled;
+    // clocked nodes, whose inputs or state changed since their last clock cycle
+    std::vector<int> mChangedClockedNodes;
+    std::vector<uint8_t> mIsClockedNodeChanged;
+    // clocked nodes, which do not keep the state for the same inputs
+    std::vector<int> mAlwaysClockedNodes;
+    // nodes clocked by the last tick
+    std::vector<int> mTickedNodes;
+    CompiledChips::EvaluateFunction mCompiledFunction = nullptr;
+    std::vector<BuiltinChip*> mComponentChips;
+    std::vector<uint16_t> mInputs;
+    std::vector<uint16_t> mOutputs;
+    int mTime = 0;
+    bool mIsTicked = false;
+    long long mEvaluationCount = 0;
+    long long mNodeEvaluationCount = 0;
+};
@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include "TestScript.h"
+#include "TestScriptError.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+bool matchesCompareLine(const string& line, const string& compareLine)
+{
+    if (line.size() != compareLine.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        // '*' in the .cmp file matches any character
+        if (compareLine[i] != '*' && compareLine[i] != line[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Parses the .tst file. May throw TestScriptError.
+/// </summary>
+TestScript::TestScript(const fs::path& path)
+    : mPath(path)
+{
+    ifstream file(path);
+    if (!file.is_open())
+    {
+        throw TestScriptError("Cannot open " + path.string() + " file.");
+    }
+    tokenize(file);
+
+    size_t position = 0;
+    mCommands = parseCommands(position, false);
+}
+
+/// <summary>
+/// Executes the script. The script stops at the first line different from the .cmp file.
+/// May throw TestScriptError or the error of the simulator.
+/// </summary>
+ETestResult TestScript::run()
+{
+    mResult = ETestResult::PASSED;
+    execute(mCommands);
+    finish();
+    return mResult;
+}
+
+/// <summary>
+/// Returns the description of the comparison failure.
+/// </summary>
+const string& TestScript::getMessage() const
+{
+    return mMessage;
+}
+
+int TestScript::getOutputCount() const
+{
+    return mOutputCount;
+}
+
+void TestScript::tokenize(istream& stream)
+{
+    string code((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+    int line = 1;
+    size_t i = 0;
+    while (i < code.size())
+    {
+        char character = code[i];
+        if (character == '\n')
+        {
+            line++;
+            i++;
+        }
+        else if (isspace(static_cast<unsigned char>(character)))
+        {
+            i++;
+        }
+        else if (code.compare(i, 2, "//") == 0)
+        {
+            i = code.find('\n', i);
+            i = i == string::npos ? code.size() : i;
+        }
+        else if (code.compare(i, 2, "/*") == 0)
+        {
+            auto end = code.find("*/", i + 2);
+            end = end == string::npos ? code.size() : end + 2;
+            line += static_cast<int>(count(code.begin() + i, code.begin() + end, '\n'));
+            i = end;
+        }
+        else if (character == ',' || character == ';' || character == '{' || character == '}')
+        {
+            mTokens.push_back({ string(1, character), line });
+            i++;
+        }
+        else if (character == '"')
+        {
+            auto end = code.find('"', i + 1);
+            end = end == string::npos ? code.size() : end + 1;
+            mTokens.push_back({ code.substr(i, end - i), line });
+            i = end;
+        }
+        else
+        {
+            auto start = i;
+            while (i < code.size() && !isspace(static_cast<unsigned char>(code[i])) && string(",;{}\"").find(code[i]) == string::npos
+                && code.compare(i, 2, "//") != 0)
+            {
+                i++;
+            }
+            mTokens.push_back({ code.substr(start, i - start), line });
+        }
+    }
+}
+
+vector<TestScript::Command> TestScript::parseCommands(size_t& position, bool isBlock)
+{
+    vector<Command> commands;
+    Command command;
+    while (position < mTokens.size())
+    {
+        const auto& token = mTokens[position++];
+        if (token.text == "," || token.text == ";" || token.text == "{" || token.text == "}")
+        {
+            if (token.text == "{")
+            {
+                command.body = parseCommands(position, true);
+            }
+            if (!command.words.empty())
+            {
+                commands.push_back(std::move(command));
+            }
+            command = Command();
+
+            if (token.text == "}")
+            {
+                if (!isBlock)
+                {
+                    throw TestScriptError(mPath.string() + ":" + to_string(token.line) + ": Unexpected '}'.");
+                }
+                return commands;
+            }
+            continue;
+        }
+
+        if (command.words.empty())
+        {
+            command.line = token.line;
+        }
+        command.words.push_back(token.text);
+    }
+
+    if (isBlock)
+    {
+        throw TestScriptError(mPath.string() + ": Missing '}' at the end of the file.");
+    }
+    if (!command.words.empty())
+    {
+        commands.push_back(std::move(command));
+    }
+    return commands;
+}
+
+bool TestScript::execute(const vector<Command>& commands)
+{
+    for (const auto& command : commands)
+    {
+        if (!executeCommand(command))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TestScript::executeCommand(const Command& command)
+{
+    const auto& name = command.words[0];
+    if (name == "repeat" || name == "while")
+    {
+        return executeLoop(command);
+    }
+    if (!command.body.empty())
+    {
+        fail(command, "Only repeat and while commands have a body");
+    }
+
+    auto argumentCount = command.words.size() - 1;
+    // the VMEmulator loads the directory of the script without the argument
+    if (name == "load" && argumentCount <= 1)
+    {
+        // the script is meant for another simulator
+        if (!load(command))
+        {
+            mResult = ETestResult::SKIPPED;
+            return false;
+        }
+    }
+    else if (name == "output-file" && argumentCount == 1)
+    {
+        auto path = mPath.parent_path() / command.words[1];
+        mOutputFile = ofstream(path);
+        if (!mOutputFile.is_open())
+        {
+            fail(command, "Cannot create or open " + path.string() + " file");
+        }
+    }
+    else if (name == "compare-to" && argumentCount == 1)
+    {
+        auto path = mPath.parent_path() / command.words[1];
+        ifstream file(path);
+        if (!file.is_open())
+        {
+            fail(command, "Cannot open " + path.string() + " file");
+        }
+        mCompareLines.clear();
+        string line;
+        while (getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            mCompareLines.push_back(line);
+        }
+    }
+    else if (name == "output-list")
+    {
+        setOutputList(command);
+    }
+    else if (name == "set" && argumentCount == 2)
+    {
+        writeValue(command, command.words[1], parseNumber(command, command.words[2]));
+    }
+    else if (name == "output" && argumentCount == 0)
+    {
+        ostringstream line;
+        for (const auto& column : mOutputList)
+        {
+            line << formatColumn(command, column);
+        }
+        line << "|";
+        mOutputCount++;
+        return writeOutputLine(line.str());
+    }
+    else if (name == "echo" || name == "clear-echo" || name == "breakpoint" || name == "clear-breakpoints")
+    {
+        // the simulator has no user interface
+    }
+    else if (!executeSimulatorCommand(command))
+    {
+        fail(command, "Unknown command '" + name + "' or wrong count of its arguments");
+    }
+    return true;
+}
+
+bool TestScript::executeLoop(const Command& command)
+{
+    const auto& words = command.words;
+    if (words[0] == "repeat")
+    {
+        if (words.size() > 2)
+        {
+            fail(command, "Expected repeat count");
+        }
+
+        // repeat without the count runs until the loop limit
+        int count = MAX_LOOP_ITERATIONS;
+        if (words.size() == 2)
+        {
+            try
+            {
+                count = stoi(words[1]);
+            }
+            catch (const exception&)
+            {
+                fail(command, "Expected repeat count");
+            }
+        }
+        return repeat(command, count);
+    }
+
+    if (words.size() != 4)
+    {
+        fail(command, "Expected while condition 'left operator right'");
+    }
+    beginWhileLoop(command);
+
+    auto readOperand = [&](const string& operand)
+    {
+        bool isSigned = false;
+        bool isNumber = !operand.empty() && (isdigit(static_cast<unsigned char>(operand[0])) || operand[0] == '-' || operand[0] == '%');
+        return isNumber ? parseNumber(command, operand) : readValue(command, operand, isSigned);
+    };
+
+    for (int iteration = 0;; iteration++)
+    {
+        int left = readOperand(words[1]);
+        int right = readOperand(words[3]);
+        const auto& comparison = words[2];
+        bool isTrue = comparison == "=" ? left == right
+            : comparison == "<>" ? left != right
+            : comparison == "<" ? left < right
+            : comparison == ">" ? left > right
+            : comparison == "<=" ? left <= right
+            : comparison == ">=" ? left >= right
+            : (fail(command, "Unknown operator " + comparison), false);
+        if (!isTrue)
+        {
+            return true;
+        }
+        if (iteration == MAX_LOOP_ITERATIONS)
+        {
+            fail(command, "Loop did not end after " + to_string(MAX_LOOP_ITERATIONS) + " iterations, "
+                "a loop waiting for a key needs the key in --keys option");
+        }
+        if (!execute(command.body))
+        {
+            return false;
+        }
+    }
+}
+
+/// <summary>
+/// Reads columns "name%Fleft.width.right" and writes the header line with centered names.
+/// </summary>
+void TestScript::setOutputList(const Command& command)
+{
+    mOutputList.clear();
+    for (size_t i = 1; i < command.words.size(); i++)
+    {
+        const auto& word = command.words[i];
+        auto formatStart = word.find('%');
+        OutputColumn column;
+        char separators[2] = {};
+        istringstream format(formatStart == string::npos ? "" : word.substr(formatStart + 1));
+        if (formatStart == 0 || !(format >> column.format >> column.left >> separators[0] >> column.width >> separators[1] >> column.right)
+            || string("BXDS").find(column.format) == string::npos || separators[0] != '.' || separators[1] != '.' || !format.eof()
+            || column.left < 0 || column.width < 1 || column.right < 0)
+        {
+            fail(command, "Expected output column 'name%Fleft.width.right', found '" + word + "'");
+        }
+        column.name = word.substr(0, formatStart);
+        mOutputList.push_back(column);
+    }
+
+    ostringstream header;
+    for (const auto& column : mOutputList)
+    {
+        int size = column.left + column.width + column.right;
+        auto name = column.name.substr(0, size);
+        int left = (size - static_cast<int>(name.size())) / 2;
+        header << "|" << string(left, ' ') << name << string(size - name.size() - left, ' ');
+    }
+    header << "|";
+    writeOutputLine(header.str());
+}
+
+bool TestScript::writeOutputLine(const string& line)
+{
+    mLineNumber++;
+    if (mOutputFile.is_open())
+    {
+        mOutputFile << line << "\n";
+    }
+
+    if (!mCompareLines.empty() && (mLineNumber > static_cast<int>(mCompareLines.size())
+        || !matchesCompareLine(line, mCompareLines[mLineNumber - 1])))
+    {
+        mResult = ETestResult::FAILED;
+        mMessage = "Comparison failure at line " + to_string(mLineNumber);
+        return false;
+    }
+    return true;
+}
+
+string TestScript::formatColumn(const Command& command, const OutputColumn& column) const
+{
+    string text;
+    if (column.name == "time")
+    {
+        text = getTime(command);
+    }
+    else
+    {
+        bool isSigned = false;
+        int value = readValue(command, column.name, isSigned);
+        ostringstream stream;
+        switch (column.format)
+        {
+        case 'B':
+            for (int i = column.width - 1; i >= 0; i--)
+            {
+                stream << (i < 16 ? (value >> i) & 1 : 0);
+            }
+            break;
+        case 'X':
+            stream << uppercase << hex << setfill('0') << setw(column.width) << (value & 0xFFFF);
+            break;
+        default:
+            stream << value;
+            break;
+        }
+        text = stream.str();
+    }
+
+    // strings are aligned to the left, numbers to the right
+    int padding = max(column.width - static_cast<int>(text.size()), 0);
+    text = column.format == 'S' ? text + string(padding, ' ') : string(padding, ' ') + text;
+    return "|" + string(column.left, ' ') + text + string(column.right, ' ');
+}
+
+/// <summary>
+/// Parses a decimal number or a number with the format prefix %B, %X or %D.
+/// </summary>
+int TestScript::parseNumber(const Command& command, const string& text) const
+{
+    int base = 10;
+    auto digits = text;
+    if (text.size() > 2 && text[0] == '%')
+    {
+        auto format = string("BXD").find(text[1]);
+        base = format == 0 ? 2 : format == 1 ? 16 : format == 2 ? 10 : 0;
+        digits = text.substr(2);
+    }
+
+    try
+    {
+        size_t length = 0;
+        int value = base == 0 ? 0 : stoi(digits, &length, base);
+        if (base != 0 && length == digits.size() && value >= INT16_MIN && value <= UINT16_MAX)
+        {
+            return value;
+        }
+    }
+    catch (const invalid_argument&)
+    {
+    }
+    catch (const out_of_range&)
+    {
+    }
+    fail(command, "Invalid value " + text);
+}
+
+/// <summary>
+/// Runs the body of the repeat command count times. Simulators may run bodies of known commands natively.
+/// </summary>
+bool TestScript::repeat(const Command& command, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!execute(command.body))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Called before the first iteration of every while loop, e.g. to press a key.
+/// </summary>
+void TestScript::beginWhileLoop(const Command&)
+{
+}
+
+/// <summary>
+/// Called after the script ends.
+/// </summary>
+void TestScript::finish()
+{
+}
+
+[[noreturn]] void TestScript::fail(const Command& command, const string& message) const
+{
+    throw TestScriptError(mPath.filename().string() + ":" + to_string(command.line) + ": " + message + ".");
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ETestResult.h"
+
+/// <summary>
+/// TestScript executes a .tst script and compares its output with the .cmp file.
+/// <para/> Loops, output and comparison commands are common to all tools of the course. Derived scripts load
+///     the tested file and execute commands of their simulator, e.g. ChipTestScript of the HardwareSimulator.
+///     Echo and breakpoint commands are ignored.
+/// </summary>
+class TestScript
+{
+public:
+    /// <summary>
+    /// Maximal count of iterations of a while loop, loops waiting for a key end after it.
+    /// </summary>
+    static constexpr int MAX_LOOP_ITERATIONS = 1000000;
+
+    /// <summary>
+    /// Parses the .tst file. May throw TestScriptError.
+    /// </summary>
+    explicit TestScript(const std::filesystem::path& path);
+    virtual ~TestScript() = default;
+
+    /// <summary>
+    /// Executes the script. The script stops at the first line different from the .cmp file.
+    /// May throw TestScriptError or the error of the simulator.
+    /// </summary>
+    ETestResult run();
+
+    /// <summary>
+    /// Returns the description of the comparison failure.
+    /// </summary>
+    const std::string& getMessage() const;
+    int getOutputCount() const;
+
+protected:
+    struct Command
+    {
+        std::vector<std::string> words;
+        int line = 0;
+        // commands of repeat and while loops
+        std::vector<Command> body;
+    };
+
+    /// <summary>
+    /// Loads the file of the load command. Returns false, if the file is meant for another simulator.
+    /// </summary>
+    virtual bool load(const Command& command) = 0;
+    /// <summary>
+    /// Executes the command of the simulator, e.g. tick. Returns false for unknown commands.
+    /// </summary>
+    virtual bool executeSimulatorCommand(const Command& command) = 0;
+    /// <summary>
+    /// Reads the variable of the output list or the while condition, isSigned selects the %B and %X output of negative values.
+    /// </summary>
+    virtual int readValue(const Command& command, const std::string& name, bool& isSigned) const = 0;
+    /// <summary>
+    /// Writes the variable of the set command.
+    /// </summary>
+    virtual void writeValue(const Command& command, const std::string& name, int value) = 0;
+    /// <summary>
+    /// Returns the text of the "time" output column.
+    /// </summary>
+    virtual std::string getTime(const Command& command) const = 0;
+    /// <summary>
+    /// Runs the body of the repeat command count times. Simulators may run bodies of known commands natively.
+    /// </summary>
+    virtual bool repeat(const Command& command, int count);
+    /// <summary>
+    /// Called before the first iteration of every while loop, e.g. to press a key.
+    /// </summary>
+    virtual void beginWhileLoop(const Command& command);
+    /// <summary>
+    /// Called after the script ends.
+    /// </summary>
+    virtual void finish();
+
+    bool execute(const std::vector<Command>& commands);
+    /// <summary>
+    /// Parses a decimal number or a number with the format prefix %B, %X or %D.
+    /// </summary>
+    int parseNumber(const Command& command, const std::string& text) const;
+    [[noreturn]] void fail(const Command& command, const std::string& message) const;
+
+    std::filesystem::path mPath;
+
+private:
+    struct Token
+    {
+        std::string text;
+        int line = 0;
+    };
+
+    struct OutputColumn
+    {
+        std::string name;
+        char format = 'B';
+        int left = 1;
+        int width = 1;
+        int right = 1;
+    };
+
+    void tokenize(std::istream& stream);
+    std::vector<Command> parseCommands(size_t& position, bool isBlock);
+
+    bool executeCommand(const Command& command);
+    bool executeLoop(const Command& command);
+    void setOutputList(const Command& command);
+    bool writeOutputLine(const std::string& line);
+    std::string formatColumn(const Command& command, const OutputColumn& column) const;
+
+    std::vector<Token> mTokens;
+    std::vector<Command> mCommands;
+
+    std::ofstream mOutputFile;
+    std::vector<std::string> mCompareLines;
+    std::vector<OutputColumn> mOutputList;
+    int mLineNumber = 0;
+    int mOutputCount = 0;
+    ETestResult mResult = ETestResult::UNDEFINED;
+    std::string mMessage;
+};
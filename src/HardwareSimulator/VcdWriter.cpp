@@ -0,0 +1,283 @@
+#include <algorithm>
+#include "HardwareSimulatorError.h"
+#include "VcdWriter.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Matches the name with the pattern, '*' matches any characters.
+/// </summary>
+bool matchesPattern(const string& name, const string& pattern)
+{
+    size_t nameIndex = 0;
+    size_t patternIndex = 0;
+    size_t starIndex = string::npos;
+    size_t starNameIndex = 0;
+    while (nameIndex < name.size())
+    {
+        if (patternIndex < pattern.size() && pattern[patternIndex] == '*')
+        {
+            starIndex = patternIndex++;
+            starNameIndex = nameIndex;
+        }
+        else if (patternIndex < pattern.size() && pattern[patternIndex] == name[nameIndex])
+        {
+            patternIndex++;
+            nameIndex++;
+        }
+        else if (starIndex != string::npos)
+        {
+            // the last star matches one more character
+            patternIndex = starIndex + 1;
+            nameIndex = ++starNameIndex;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (patternIndex < pattern.size() && pattern[patternIndex] == '*')
+    {
+        patternIndex++;
+    }
+    return patternIndex == pattern.size();
+}
+
+/// <summary>
+/// Creates the file and selects the pins matching the patterns of the options. May throw HardwareSimulatorError.
+/// </summary>
+VcdWriter::VcdWriter(const fs::path& path, const Simulator& simulator, const WaveformOptions& options)
+    : mSimulator(simulator),
+    mFile(path, ios::binary)
+{
+    if (!mFile.is_open())
+    {
+        throw HardwareSimulatorError("Cannot create or open " + path.string() + " file.");
+    }
+    selectSignals(options.signalPatterns);
+    // a clock cycle has two edges
+    mWindowLength = 2LL * options.lastCycleCount;
+    mInitialTime = mSimulator.getClockEdgeCount();
+
+    for (auto& signal : mSignals)
+    {
+        signal.value = mSimulator.readWires(signal.wires);
+        mInitialValues.push_back(signal.value);
+    }
+    if (mWindowLength == 0)
+    {
+        writeHeader();
+        writeInitialValues();
+    }
+}
+
+VcdWriter::~VcdWriter()
+{
+    close();
+}
+
+/// <summary>
+/// Records the pins, which changed since the previous sample. The time is the count of clock edges.
+/// </summary>
+void VcdWriter::sample()
+{
+    auto time = mSimulator.getClockEdgeCount();
+    Step* step = nullptr;
+    for (int i = 0; i < static_cast<int>(mSignals.size()); i++)
+    {
+        auto& signal = mSignals[i];
+        auto value = mSimulator.readWires(signal.wires);
+        if (value == signal.value)
+        {
+            continue;
+        }
+        signal.value = value;
+
+        if (mWindowLength == 0)
+        {
+            writeTime(time);
+            writeChange(signal, value);
+            continue;
+        }
+        if (!step)
+        {
+            if (mSteps.empty() || mSteps.back().time != time)
+            {
+                mSteps.push_back(Step{ time, {} });
+            }
+            step = &mSteps.back();
+        }
+        step->changes.push_back(Change{ i, value });
+    }
+
+    if (mWindowLength == 0)
+    {
+        if (mBuffer.size() >= BUFFER_SIZE)
+        {
+            flushBuffer();
+        }
+        return;
+    }
+    // steps older than the window become the initial values
+    while (!mSteps.empty() && mSteps.front().time <= time - mWindowLength)
+    {
+        for (const auto& change : mSteps.front().changes)
+        {
+            mInitialValues[change.signal] = change.value;
+        }
+        mInitialTime = mSteps.front().time;
+        mSteps.pop_front();
+    }
+}
+
+/// <summary>
+/// Writes the remaining changes and closes the file.
+/// </summary>
+void VcdWriter::close()
+{
+    if (mIsClosed)
+    {
+        return;
+    }
+    mIsClosed = true;
+
+    if (mWindowLength > 0)
+    {
+        writeHeader();
+        writeInitialValues();
+        for (const auto& step : mSteps)
+        {
+            writeTime(step.time);
+            for (const auto& change : step.changes)
+            {
+                writeChange(mSignals[change.signal], change.value);
+            }
+            if (mBuffer.size() >= BUFFER_SIZE)
+            {
+                flushBuffer();
+            }
+        }
+        mSteps.clear();
+    }
+    flushBuffer();
+    mFile.close();
+}
+
+int VcdWriter::getSignalCount() const
+{
+    return static_cast<int>(mSignals.size());
+}
+
+/// <summary>
+/// Selects inputs and outputs in the order of the declaration, then internal pins sorted by the name.
+/// </summary>
+void VcdWriter::selectSignals(const vector<string>& patterns)
+{
+    const auto& netlist = mSimulator.getNetlist();
+    vector<string> names;
+    for (const auto& pin : netlist.chip.inputs)
+    {
+        names.push_back(pin.name);
+    }
+    for (const auto& pin : netlist.chip.outputs)
+    {
+        names.push_back(pin.name);
+    }
+    vector<string> internalNames;
+    for (const auto& [name, wires] : netlist.pins)
+    {
+        if (!netlist.chip.findInput(name) && !netlist.chip.findOutput(name))
+        {
+            internalNames.push_back(name);
+        }
+    }
+    sort(internalNames.begin(), internalNames.end());
+    names.insert(names.end(), internalNames.begin(), internalNames.end());
+
+    for (const auto& name : names)
+    {
+        bool isSelected = patterns.empty() || any_of(patterns.begin(), patterns.end(),
+            [&](const string& pattern) { return matchesPattern(name, pattern); });
+        if (!isSelected)
+        {
+            continue;
+        }
+
+        Signal signal;
+        signal.name = name;
+        signal.wires = netlist.pins.at(name);
+        // identifiers are numbers in base 94 written by printable characters
+        for (auto index = mSignals.size(); signal.identifier.empty() || index > 0; index /= 94)
+        {
+            signal.identifier += static_cast<char>('!' + index % 94);
+        }
+        mSignals.push_back(std::move(signal));
+    }
+}
+
+void VcdWriter::writeHeader()
+{
+    mBuffer += "$version Nand2Tetris HardwareSimulator $end\n";
+    mBuffer += "$comment the time is the count of clock edges, tick and tock $end\n";
+    mBuffer += "$timescale 1ns $end\n";
+    mBuffer += "$scope module " + mSimulator.getNetlist().chip.name + " $end\n";
+    for (const auto& signal : mSignals)
+    {
+        mBuffer += "$var wire " + to_string(signal.wires.size()) + " " + signal.identifier + " " + signal.name + " $end\n";
+    }
+    mBuffer += "$upscope $end\n$enddefinitions $end\n";
+}
+
+void VcdWriter::writeInitialValues()
+{
+    writeTime(mInitialTime);
+    mBuffer += "$dumpvars\n";
+    for (size_t i = 0; i < mSignals.size(); i++)
+    {
+        writeChange(mSignals[i], mInitialValues[i]);
+    }
+    mBuffer += "$end\n";
+}
+
+void VcdWriter::writeChange(const Signal& signal, uint16_t value)
+{
+    if (signal.wires.size() == 1)
+    {
+        mBuffer += static_cast<char>('0' + (value & 1));
+    }
+    else
+    {
+        // leading zeros are omitted
+        mBuffer += 'b';
+        int bit = static_cast<int>(signal.wires.size()) - 1;
+        while (bit > 0 && !((value >> bit) & 1))
+        {
+            bit--;
+        }
+        for (; bit >= 0; bit--)
+        {
+            mBuffer += static_cast<char>('0' + ((value >> bit) & 1));
+        }
+        mBuffer += ' ';
+    }
+    mBuffer += signal.identifier;
+    mBuffer += '\n';
+}
+
+void VcdWriter::writeTime(long long time)
+{
+    if (time != mLastTime)
+    {
+        mBuffer += '#';
+        mBuffer += to_string(time);
+        mBuffer += '\n';
+        mLastTime = time;
+    }
+}
+
+void VcdWriter::flushBuffer()
+{
+    mFile.write(mBuffer.data(), static_cast<streamsize>(mBuffer.size()));
+    mBuffer.clear();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Simulator.h"
+#include "WaveformOptions.h"
+
+/// <summary>
+/// VcdWriter writes pins of the simulated chip into a Value Change Dump file, which is shown by waveform viewers.
+/// <para/> Only changed values are written. They are collected in a buffer, which is written to the file in large blocks.
+/// <para/> With the count of the last cycles the changes are kept in a bounded ring instead, older changes are merged
+///     into the initial values and the file is written by close.
+/// </summary>
+class VcdWriter
+{
+public:
+    /// <summary>
+    /// Size of the buffer written to the file at once.
+    /// </summary>
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    /// <summary>
+    /// Creates the file and selects the pins matching the patterns of the options. May throw HardwareSimulatorError.
+    /// </summary>
+    VcdWriter(const std::filesystem::path& path, const Simulator& simulator, const WaveformOptions& options);
+    ~VcdWriter();
+
+    /// <summary>
+    /// Records the pins, which changed since the previous sample. The time is the count of clock edges.
+    /// </summary>
+    void sample();
+    /// <summary>
+    /// Writes the remaining changes and closes the file.
+    /// </summary>
+    void close();
+
+    int getSignalCount() const;
+
+private:
+    struct Signal
+    {
+        std::string name;
+        std::string identifier;
+        std::vector<int> wires;
+        uint16_t value = 0;
+    };
+
+    struct Change
+    {
+        int signal = 0;
+        uint16_t value = 0;
+    };
+
+    // changes recorded at one time of the ring
+    struct Step
+    {
+        long long time = 0;
+        std::vector<Change> changes;
+    };
+
+    void selectSignals(const std::vector<std::string>& patterns);
+    void writeHeader();
+    void writeInitialValues();
+    void writeChange(const Signal& signal, uint16_t value);
+    void writeTime(long long time);
+    void flushBuffer();
+
+    const Simulator& mSimulator;
+    std::ofstream mFile;
+    std::vector<Signal> mSignals;
+    std::string mBuffer;
+    long long mLastTime = -1;
+    bool mIsClosed = false;
+
+    // count of the clock edges kept in the ring, 0 without the ring
+    long long mWindowLength = 0;
+    std::deque<Step> mSteps;
+    // values before the first step of the ring
+    std::vector<uint16_t> mInitialValues;
+    long long mInitialTime = 0;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Selects the Value Change Dump file written by test scripts. The file is not written by default.
+/// </summary>
+struct WaveformOptions
+{
+    /// <summary>
+    /// Writes "Script.vcd" next to the .out file of the script.
+    /// </summary>
+    bool writeVcd = false;
+    /// <summary>
+    /// Names of the written pins of the loaded chip, '*' matches any characters. All pins are written if it is empty.
+    /// </summary>
+    std::vector<std::string> signalPatterns;
+    /// <summary>
+    /// Count of the last clock cycles kept in memory and written at the end, 0 streams the whole simulation into the file.
+    /// </summary>
+    int lastCycleCount = 0;
+};
@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+#include "BuiltinChips.h"
+#include "ChipCompiler.h"
+#include "ChipLibrary.h"
+#include "ChipTestScript.h"
+#include "ChipVerifier.h"
+#include "HardwareSimulatorError.h"
+#include "NetlistBuilder.h"
+#include "TestScriptError.h"
+
+namespace fs = std::filesystem;
+
+std::vector<fs::path> findFiles(const std::vector<fs::path>& inputPaths, const std::string& extension);
+bool runScripts(const std::vector<fs::path>& scriptPaths, const std::unordered_set<std::string>& builtinChipNames,
+    const std::string& keys, bool isEventDriven, const WaveformOptions& waveformOptions);
+bool verifyChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, long long randomVectorCount);
+bool compileChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, const fs::path& outputPath);
+bool benchmarkChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, long long cycleCount);
+std::vector<uint16_t> simulateCycles(Simulator& simulator, long long cycleCount, const std::vector<uint16_t>& inputValues, double& milliseconds);
+const char* getResultName(ETestResult result);
+void printSpeed(long long vectorCount, double milliseconds);
+
+int main(int argc, char* argv[])
+{
+    std::string keys;
+    bool verify = false;
+    bool benchmark = false;
+    bool isEventDriven = true;
+    fs::path compileOutputPath;
+    long long randomVectorCount = 1 << 20;
+    long long cycleCount = 10000;
+    std::unordered_set<std::string> builtinChipNames;
+    WaveformOptions waveformOptions;
+    std::vector<fs::path> inputPaths;
+    bool validArguments = argc >= 2;
+    for (int i = 1; i < argc && validArguments; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc)
+        {
+            keys = argv[++i];
+        }
+        else if (arg == "--verify")
+        {
+            verify = true;
+        }
+        else if (arg == "--benchmark")
+        {
+            benchmark = true;
+        }
+        else if (arg == "--full-evaluation")
+        {
+            isEventDriven = false;
+        }
+        else if (arg == "--vcd")
+        {
+            waveformOptions.writeVcd = true;
+        }
+        else if (arg == "--signals" && i + 1 < argc)
+        {
+            // e.g. "--signals pc,*Register*"
+            std::istringstream patterns(argv[++i]);
+            std::string pattern;
+            while (std::getline(patterns, pattern, ','))
+            {
+                waveformOptions.signalPatterns.push_back(pattern);
+            }
+        }
+        else if (arg == "--vcd-cycles" && i + 1 < argc)
+        {
+            try
+            {
+                waveformOptions.lastCycleCount = std::stoi(argv[++i]);
+                validArguments = waveformOptions.lastCycleCount > 0;
+            }
+            catch (const std::exception&)
+            {
+                validArguments = false;
+            }
+        }
+        else if (arg.rfind("--builtin=", 0) == 0)
+        {
+            // e.g. "--builtin=RAM16K,Screen"
+            std::istringstream chipNames(arg.substr(10));
+            std::string chipName;
+            while (std::getline(chipNames, chipName, ','))
+            {
+                if (!BuiltinChips::findDeclaration(chipName))
+                {
+                    std::cout << "Chip " << chipName << " is not a built-in chip.\n";
+                    validArguments = false;
+                }
+                builtinChipNames.insert(chipName);
+            }
+            validArguments = validArguments && !builtinChipNames.empty();
+        }
+        else if (arg == "--compile" && i + 1 < argc)
+        {
+            compileOutputPath = argv[++i];
+        }
+        else if (arg == "--vectors" && i + 1 < argc)
+        {
+            try
+            {
+                randomVectorCount = std::stoll(argv[++i]);
+                validArguments = randomVectorCount > 0;
+            }
+            catch (const std::exception&)
+            {
+                validArguments = false;
+            }
+        }
+        else if (arg == "--cycles" && i + 1 < argc)
+        {
+            try
+            {
+                cycleCount = std::stoll(argv[++i]);
+                validArguments = cycleCount > 0;
+            }
+            catch (const std::exception&)
+            {
+                validArguments = false;
+            }
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            validArguments = false;
+        }
+        else
+        {
+            inputPaths.emplace_back(arg);
+        }
+    }
+
+    if (!validArguments || inputPaths.empty())
+    {
+        std::cout << "Usage: \n"
+            << "\tHardwareSimulator Script.tst|Directory... [--keys Keys] [--full-evaluation] [--builtin=Chip,...]\n"
+            << "\t\t[--vcd [--signals Pattern,...] [--vcd-cycles N]]\n"
+            << "\tHardwareSimulator --verify Chip.hdl|Directory... [--vectors N] [--builtin=Chip,...]\n"
+            << "\tHardwareSimulator --compile OutputFile.cpp Chip.hdl... [--builtin=Chip,...]\n"
+            << "\tHardwareSimulator --benchmark Chip.hdl|Directory... [--cycles N] [--builtin=Chip,...]\n"
+            << "\t--keys: keys held on the Keyboard, every while loop of a script presses the next key\n"
+            << "\t--builtin: chips used as built-in chips, even if the directory contains their .hdl files\n"
+            << "\t--vcd: writes changes of the pins matching the patterns into Script.vcd, with --vcd-cycles only the last N cycles\n"
+            << "\t--full-evaluation: evaluates the whole chip instead of propagating only changed signals\n"
+            << "\t--verify: compares combinational chips with the built-in chips, N random vectors are used for chips with many inputs\n"
+            << "\t--compile: translates chips into C++ code, which is used by the simulator after it is linked into it\n"
+            << "\t--benchmark: compares the event-driven simulation with the full evaluation in N clock cycles with random inputs\n";
+        return EXIT_FAILURE;
+    }
+
+    bool isPassed = !compileOutputPath.empty() ? compileChips(findFiles(inputPaths, ".hdl"), builtinChipNames, compileOutputPath)
+        : verify ? verifyChips(findFiles(inputPaths, ".hdl"), builtinChipNames, randomVectorCount)
+        : benchmark ? benchmarkChips(findFiles(inputPaths, ".hdl"), builtinChipNames, cycleCount)
+        : runScripts(findFiles(inputPaths, ".tst"), builtinChipNames, keys, isEventDriven, waveformOptions);
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// <summary>
+/// Replaces directories with their files with the extension.
+/// </summary>
+std::vector<fs::path> findFiles(const std::vector<fs::path>& inputPaths, const std::string& extension)
+{
+    std::vector<fs::path> paths;
+    for (const auto& inputPath : inputPaths)
+    {
+        if (!fs::is_directory(inputPath))
+        {
+            paths.push_back(inputPath);
+            continue;
+        }
+
+        std::vector<fs::path> directoryPaths;
+        for (const auto& entry : fs::directory_iterator(inputPath))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == extension)
+            {
+                directoryPaths.push_back(entry.path());
+            }
+        }
+        std::sort(directoryPaths.begin(), directoryPaths.end());
+        paths.insert(paths.end(), directoryPaths.begin(), directoryPaths.end());
+    }
+    return paths;
+}
+
+bool runScripts(const std::vector<fs::path>& scriptPaths, const std::unordered_set<std::string>& builtinChipNames,
+    const std::string& keys, bool isEventDriven, const WaveformOptions& waveformOptions)
+{
+    int passedCount = 0;
+    int failedCount = 0;
+    int skippedCount = 0;
+    long long totalEvaluationCount = 0;
+    double totalMilliseconds = 0;
+    for (const auto& path : scriptPaths)
+    {
+        auto result = ETestResult::FAILED;
+        std::string message;
+        int outputCount = 0;
+        long long evaluationCount = 0;
+        bool isCompiled = false;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            auto script = ChipTestScript(path);
+            script.setKeys(keys);
+            script.setEventDriven(isEventDriven);
+            script.setBuiltinChips(builtinChipNames);
+            script.setWaveformOptions(waveformOptions);
+            result = script.run();
+            message = script.getMessage();
+            outputCount = script.getOutputCount();
+            evaluationCount = script.getEvaluationCount();
+            isCompiled = script.isCompiled();
+        }
+        catch (const HardwareSimulatorError& error)
+        {
+            message = error.what();
+        }
+        catch (const TestScriptError& error)
+        {
+            message = error.what();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        std::cout << std::left << std::setw(8) << getResultName(result) << path.string() << (isCompiled ? " [compiled]" : "");
+        if (result == ETestResult::SKIPPED)
+        {
+            std::cout << " (not a chip test)\n";
+            skippedCount++;
+            continue;
+        }
+        std::cout << ": " << outputCount << " outputs, ";
+        printSpeed(evaluationCount, milliseconds);
+        if (!message.empty())
+        {
+            std::cout << "\t" << message << "\n";
+        }
+
+        passedCount += result == ETestResult::PASSED;
+        failedCount += result != ETestResult::PASSED;
+        totalEvaluationCount += evaluationCount;
+        totalMilliseconds += milliseconds;
+    }
+
+    std::cout << "\nPassed " << passedCount << ", failed " << failedCount << ", skipped " << skippedCount << " scripts.\nSimulated ";
+    printSpeed(totalEvaluationCount, totalMilliseconds);
+    return failedCount == 0;
+}
+
+bool verifyChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, long long randomVectorCount)
+{
+    int passedCount = 0;
+    int failedCount = 0;
+    int skippedCount = 0;
+    long long totalVectorCount = 0;
+    double totalMilliseconds = 0;
+    auto verifier = ChipVerifier(randomVectorCount, 1);
+    for (const auto& path : chipPaths)
+    {
+        auto chipName = path.stem().string();
+        const auto* reference = ChipVerifier::findReference(chipName);
+        if (!reference)
+        {
+            std::cout << std::left << std::setw(8) << getResultName(ETestResult::SKIPPED) << path.string()
+                << " (no combinational built-in chip)\n";
+            skippedCount++;
+            continue;
+        }
+
+        ChipVerifier::Result result;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            auto library = ChipLibrary(path.parent_path(), builtinChipNames);
+            auto netlist = NetlistBuilder(library, true).build(chipName);
+            // only the evaluation is measured
+            startTime = std::chrono::high_resolution_clock::now();
+            result = verifier.verify(netlist, *reference);
+        }
+        catch (const HardwareSimulatorError& error)
+        {
+            result.message = error.what();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        std::cout << std::left << std::setw(8) << getResultName(result.isPassed ? ETestResult::PASSED : ETestResult::FAILED)
+            << path.string() << ": " << (result.isExhaustive ? "all " : "random ");
+        printSpeed(result.vectorCount, milliseconds);
+        if (!result.message.empty())
+        {
+            std::cout << "\t" << result.message << "\n";
+        }
+
+        passedCount += result.isPassed;
+        failedCount += !result.isPassed;
+        totalVectorCount += result.vectorCount;
+        totalMilliseconds += milliseconds;
+    }
+
+    std::cout << "\nPassed " << passedCount << ", failed " << failedCount << ", skipped " << skippedCount << " chips.\nEvaluated ";
+    printSpeed(totalVectorCount, totalMilliseconds);
+    return failedCount == 0;
+}
+
+bool compileChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, const fs::path& outputPath)
+{
+    std::vector<Netlist> netlists;
+    try
+    {
+        for (const auto& path : chipPaths)
+        {
+            auto library = ChipLibrary(path.parent_path(), builtinChipNames);
+            netlists.push_back(NetlistBuilder(library).build(path.stem().string()));
+            const auto& netlist = netlists.back();
+            std::cout << "Compiled " << path.string() << ": " << netlist.gates.size() << " gates, "
+                << netlist.components.size() << " components.\n";
+        }
+
+        std::ofstream outputFile(outputPath);
+        if (!outputFile.is_open())
+        {
+            throw HardwareSimulatorError("Cannot create or open " + outputPath.string() + " file.");
+        }
+        ChipCompiler::write(netlists, outputFile);
+        std::cout << "Created " << outputPath << " file.\n";
+        return true;
+    }
+    catch (const HardwareSimulatorError& error)
+    {
+        std::cout << "Error: " << error.what() << "\n";
+        return false;
+    }
+}
+
+bool benchmarkChips(const std::vector<fs::path>& chipPaths, const std::unordered_set<std::string>& builtinChipNames, long long cycleCount)
+{
+    bool isPassed = true;
+    for (const auto& path : chipPaths)
+    {
+        try
+        {
+            auto library = ChipLibrary(path.parent_path(), builtinChipNames);
+            auto chipName = path.stem().string();
+            auto fullSimulator = Simulator(NetlistBuilder(library).build(chipName), false);
+            auto eventSimulator = Simulator(NetlistBuilder(library).build(chipName), true);
+            const auto& netlist = fullSimulator.getNetlist();
+
+            // both simulators get the same inputs in every cycle
+            std::mt19937 random(1);
+            std::uniform_int_distribution<int> distribution(0, 0xFFFF);
+            std::vector<uint16_t> inputValues(cycleCount * netlist.chip.inputs.size());
+            for (auto& value : inputValues)
+            {
+                value = static_cast<uint16_t>(distribution(random));
+            }
+
+            double fullMilliseconds = 0;
+            double eventMilliseconds = 0;
+            auto fullOutputs = simulateCycles(fullSimulator, cycleCount, inputValues, fullMilliseconds);
+            auto eventOutputs = simulateCycles(eventSimulator, cycleCount, inputValues, eventMilliseconds);
+
+            auto fullCount = static_cast<double>(fullSimulator.getNodeEvaluationCount()) / cycleCount;
+            auto eventCount = static_cast<double>(eventSimulator.getNodeEvaluationCount()) / cycleCount;
+            bool isSame = fullOutputs == eventOutputs;
+            isPassed = isPassed && isSame;
+
+            std::cout << std::left << std::setw(8) << getResultName(isSame ? ETestResult::PASSED : ETestResult::FAILED)
+                << path.string() << ": " << netlist.gates.size() << " gates, " << netlist.components.size() << " components, "
+                << cycleCount << " clock cycles\n" << std::fixed << std::setprecision(1)
+                << "\tfull evaluation: " << fullCount << " nodes per cycle, " << fullMilliseconds << " ms\n"
+                << "\tevent-driven:    " << eventCount << " nodes per cycle, " << eventMilliseconds << " ms";
+            if (eventCount > 0 && eventMilliseconds > 0)
+            {
+                std::cout << " (" << fullCount / eventCount << "x fewer evaluations, "
+                    << fullMilliseconds / eventMilliseconds << "x faster)";
+            }
+            std::cout << "\n";
+            if (!isSame)
+            {
+                std::cout << "\tOutputs of the simulations differ.\n";
+            }
+        }
+        catch (const HardwareSimulatorError& error)
+        {
+            std::cout << std::left << std::setw(8) << getResultName(ETestResult::FAILED) << path.string() << "\n\t" << error.what() << "\n";
+            isPassed = false;
+        }
+    }
+    return isPassed;
+}
+
+/// <summary>
+/// Sets the inputs, ticks and tocks in every cycle. Returns the outputs after every tock.
+/// </summary>
+std::vector<uint16_t> simulateCycles(Simulator& simulator, long long cycleCount, const std::vector<uint16_t>& inputValues, double& milliseconds)
+{
+    const auto& chip = simulator.getNetlist().chip;
+    std::vector<uint16_t> outputValues;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (long long cycle = 0; cycle < cycleCount; cycle++)
+    {
+        for (size_t i = 0; i < chip.inputs.size(); i++)
+        {
+            simulator.setPin(chip.inputs[i].name, inputValues[cycle * chip.inputs.size() + i]);
+        }
+        simulator.tick();
+        simulator.tock();
+        for (const auto& output : chip.outputs)
+        {
+            outputValues.push_back(simulator.getPin(output.name));
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    return outputValues;
+}
+
+const char* getResultName(ETestResult result)
+{
+    switch (result)
+    {
+    case ETestResult::PASSED:
+        return "PASSED";
+    case ETestResult::SKIPPED:
+        return "SKIPPED";
+    default:
+        return "FAILED";
+    }
+}
+
+void printSpeed(long long vectorCount, double milliseconds)
+{
+    std::cout << vectorCount << " test vectors in " << std::fixed << std::setprecision(1) << milliseconds << " ms";
+    if (milliseconds > 0)
+    {
+        std::cout << " (" << std::setprecision(0) << vectorCount / milliseconds * 1000 << " vectors/s)";
+    }
+    std::cout << "\n";
+}
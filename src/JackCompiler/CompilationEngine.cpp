@@ -8,19 +8,29 @@
 using namespace std;
 using namespace std::filesystem;
 
+// XML output is usually 10-25 times bigger than the compiled .jack file
+constexpr uintmax_t XML_BUFFER_FACTOR = 24;
+
 /// <summary>
 /// Opens the output file and gets ready to write into it.
 /// <para/> The next routine called must be compileClass.
 /// </summary>
 /// <param name="filename">Name of the input file</param>
-CompilationEngine::CompilationEngine(const string& filename)
-    : mInputFileName(filename)
+/// <param name="options">Selected outputs</param>
+CompilationEngine::CompilationEngine(const string& filename, const CompilationOptions& options)
+    : mOptions(options),
+    mInputFileName(filename)
 {
     path path = filename;
     string name = path.filename().stem().string();
+    mVMCodeFileName = path.replace_filename(name + ".vm").string();
+
+    if (!options.xmlDirectory.empty())
+    {
+        path = std::filesystem::path(options.xmlDirectory) / path.filename();
+    }
     mXmlSyntaxFileName = path.replace_filename(name + ".xml").string();
     mXmlTokensFileName = path.replace_filename(name + "_Tokens.xml").string();
-    mVMCodeFileName = path.replace_filename(name + ".vm").string();
 }
 
 /// <summary>
@@ -31,20 +41,21 @@ void CompilationEngine::compileFile()
     beforeCompile();
 
     auto classRule = std::make_unique<ClassRule>();
+    classRule->setOptions(mOptions);
     if (!classRule->initialize(std::make_unique<JackTokenizer>(mInputFileName).get()))
     {
         throw JackCompilerError("Failed to initialize class.");
     }
 
-    if (mWriteXmlSyntax)
+    if (mOptions.writeXmlSyntax)
     {
-        classRule->writeXmlSyntax(mXmlSyntaxFile.get(), 0);
+        classRule->writeXmlSyntax(mXmlSyntaxWriter.get(), 0);
     }
-    if (mWriteXmlTokens)
+    if (mOptions.writeXmlTokens)
     {
-        classRule->writeXmlTokens(mXmlTokensFile.get());
+        classRule->writeXmlTokens(mXmlTokensWriter.get());
     }
-    if (mWriteVMCode)
+    if (mVMWriter)
     {
         classRule->compile(mVMWriter.get());
     }
@@ -52,60 +63,67 @@ void CompilationEngine::compileFile()
     afterCompile();
 }
 
+/// <summary>
+/// Compiles a single file, VM code is written into the stream instead of the .vm file.
+/// </summary>
+void CompilationEngine::compileFile(std::ostream& vmStream)
+{
+    mVMWriter = make_unique<VMWriter>(vmStream);
+    compileFile();
+}
+
 void CompilationEngine::beforeCompile()
 {
-    if (mWriteXmlSyntax)
+    size_t bufferSize = 0;
+    if (mOptions.writeXmlSyntax || mOptions.writeXmlTokens)
     {
-        mXmlSyntaxFile = make_unique<ofstream>(mXmlSyntaxFileName);
-        if (!mXmlSyntaxFile->is_open())
-        {
-            throw JackCompilerError("Cannot create or open " + mXmlSyntaxFileName + " file.");
-        }
+        bufferSize = static_cast<size_t>(file_size(mInputFileName) * XML_BUFFER_FACTOR);
+    }
+
+    if (mOptions.writeXmlSyntax)
+    {
+        mXmlSyntaxWriter = make_unique<XmlWriter>(mXmlSyntaxFileName, bufferSize);
     }
     
-    if (mWriteXmlTokens)
+    if (mOptions.writeXmlTokens)
     {
-        mXmlTokensFile = make_unique<ofstream>(mXmlTokensFileName);
-        if (!mXmlSyntaxFile->is_open())
-        {
-            throw JackCompilerError("Cannot create or open " + mXmlTokensFileName + " file.");
-        }
-        *mXmlTokensFile << "<tokens>\n";
+        mXmlTokensWriter = make_unique<XmlWriter>(mXmlTokensFileName, bufferSize);
+        mXmlTokensWriter->write("<tokens>\n");
     }
 
-    if (mWriteVMCode)
+    if (mOptions.writeVMCode && !mVMWriter)
     {
-        mVMCodeFile = make_shared<ofstream>(mVMCodeFileName);
+        mVMCodeFile = make_unique<ofstream>(mVMCodeFileName);
         if (!mVMCodeFile->is_open())
         {
             throw JackCompilerError("Cannot create or open " + mVMCodeFileName + " file.");
         }
-        mVMWriter = make_unique<VMWriter>(mVMCodeFile);
+        mVMWriter = make_unique<VMWriter>(*mVMCodeFile);
     }
 }
 
 void CompilationEngine::afterCompile()
 {
-    if (mWriteXmlSyntax)
+    if (mOptions.writeXmlSyntax)
     {
-        mXmlSyntaxFile->close();
-        mXmlSyntaxFile = nullptr;
+        mXmlSyntaxWriter->close();
+        mXmlSyntaxWriter = nullptr;
         std::cout << "Created " << mXmlSyntaxFileName << " file." << std::endl;
     }
 
-    if (mWriteXmlTokens)
+    if (mOptions.writeXmlTokens)
     {
-        *mXmlTokensFile << "</tokens>\n";
-        mXmlTokensFile->close();
-        mXmlTokensFile = nullptr;
+        mXmlTokensWriter->write("</tokens>\n");
+        mXmlTokensWriter->close();
+        mXmlTokensWriter = nullptr;
         std::cout << "Created " << mXmlTokensFileName << " file." << std::endl;
     }
 
-    if (mWriteVMCode)
+    mVMWriter = nullptr;
+    if (mVMCodeFile)
     {
         mVMCodeFile->close();
         mVMCodeFile = nullptr;
-        mVMWriter = nullptr;
         std::cout << "Created " << mVMCodeFileName << " file." << std::endl;
     }
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 #include <functional>
 #include <string>
+#include "CompilationOptions.h"
 #include "JackTokenizer.h"
 #include "VMWriter.h"
+#include "XmlWriter.h"
 
 /// <summary>
 /// The CompilationEngine is the backbone module of both the syntax analyzer and the full-scale compiler.
@@ -16,29 +18,31 @@ public:
     /// Creates CompilationEngine.
     /// </summary>
     /// <param name="filename">Name of the input file</param>
-    /// <param name="jackTokenizer">Instance of Jack tokenizer</param>
-    explicit CompilationEngine(const std::string& filename);
+    /// <param name="options">Selected outputs</param>
+    CompilationEngine(const std::string& filename, const CompilationOptions& options);
 
     /// <summary>
     /// Compiles a single file.
     /// </summary>
     void compileFile();
+    /// <summary>
+    /// Compiles a single file, VM code is written into the stream instead of the .vm file.
+    /// </summary>
+    void compileFile(std::ostream& vmStream);
 
 private:
     void beforeCompile();
     void afterCompile();
 
-    bool mWriteXmlSyntax = true;
-    bool mWriteXmlTokens = true;
-    bool mWriteVMCode = true;
+    CompilationOptions mOptions;
 
     std::string mInputFileName = "";
     std::string mXmlSyntaxFileName = "";
     std::string mXmlTokensFileName = "";
     std::string mVMCodeFileName = "";
 
-    std::unique_ptr<std::ofstream> mXmlSyntaxFile;
-    std::unique_ptr<std::ofstream> mXmlTokensFile;
-    std::shared_ptr<std::ofstream> mVMCodeFile;
+    std::unique_ptr<XmlWriter> mXmlSyntaxWriter;
+    std::unique_ptr<XmlWriter> mXmlTokensWriter;
+    std::unique_ptr<std::ofstream> mVMCodeFile;
     std::unique_ptr<VMWriter> mVMWriter;
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+/// <summary>
+/// Selects the outputs created by the CompilationEngine and the code generation optimizations.
+/// <para/> Release builds create only .vm files by default, debug builds create also both XML files.
+/// </summary>
+struct CompilationOptions
+{
+#ifdef NDEBUG
+    bool writeXmlSyntax = false;
+    bool writeXmlTokens = false;
+#else
+    bool writeXmlSyntax = true;
+    bool writeXmlTokens = true;
+#endif
+    bool writeVMCode = true;
+    /// <summary>
+    /// Directory for the created XML files, empty string places them next to the .jack file.
+    /// </summary>
+    std::string xmlDirectory;
+
+    /// <summary>
+    /// Folds constant expressions and simplifies arithmetic. When disabled, the generated code
+    ///     is identical with the default Jack compiler.
+    /// </summary>
+    bool optimize = true;
+    /// <summary>
+    /// Creates each string literal once, on the first execution, and stores it in a static variable of the class.
+    /// <para/> Evaluations of the literal return the same String object, so it must not be modified or disposed.
+    /// </summary>
+    bool poolStrings = false;
+};
@@ -11,7 +11,8 @@ namespace fs = std::filesystem;
 /// Validates provided path, creates JackTokenizer and CompilationEngine.
 /// May throw a runtime exception.
 /// </summary>
-JackCompiler::JackCompiler(std::string const& path)
+JackCompiler::JackCompiler(std::string const& path, const CompilationOptions& options)
+    : mOptions(options)
 {
     fs::path filePath = path;
     fs::path inputPath = filePath.is_relative()
@@ -66,7 +67,7 @@ void JackCompiler::parseDirectory() const
 
     for (std::string jackFile : jackFiles)
     {
-        auto compilationEngine = make_unique<CompilationEngine>(jackFile);
+        auto compilationEngine = make_unique<CompilationEngine>(jackFile, mOptions);
         compilationEngine->compileFile();
     }
 }
@@ -81,6 +82,6 @@ void JackCompiler::parseSingleFile() const
         throw JackCompilerError("File " + mInputPath + " doesn't exist.");
     }
 
-    auto compilationEngine = make_unique<CompilationEngine>(mInputPath);
+    auto compilationEngine = make_unique<CompilationEngine>(mInputPath, mOptions);
     compilationEngine->compileFile();
 }
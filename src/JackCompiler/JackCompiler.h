@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include "CompilationOptions.h"
 
 /// <summary>
 /// JackAnalyzer is the main program that drives the overall syntax analysis process, using the services
@@ -12,7 +13,7 @@ public:
     /// Validates provided path, creates JackTokenizer and CompilationEngine.
     /// May throw a runtime exception.
     /// </summary>
-    explicit JackCompiler(std::string const& path);
+    JackCompiler(std::string const& path, const CompilationOptions& options);
     /// <summary>
     /// Releases allocated memory.
     /// </summary>
@@ -34,4 +35,5 @@ public:
 private:
     std::string mInputPath;
     bool mIsDirectoryPath;
+    CompilationOptions mOptions;
 };
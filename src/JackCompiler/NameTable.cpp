@@ -0,0 +1,43 @@
+#include "JackCompilerError.h"
+#include "NameTable.h"
+
+/// <summary>
+/// Returns the id of the given name. Adds the name to the table if it is not there yet.
+/// </summary>
+int NameTable::intern(std::string_view name)
+{
+    if (auto it = mIds.find(name); it != mIds.end())
+    {
+        return it->second;
+    }
+
+    // std::deque does not move stored strings, so views used as keys stay valid
+    const auto& storedName = mNames.emplace_back(name);
+    auto id = static_cast<int>(mNames.size()) - 1;
+    mIds.emplace(storedName, id);
+    return id;
+}
+
+/// <summary>
+/// Returns the id of the given name or -1 if the name has never been interned.
+/// </summary>
+int NameTable::find(std::string_view name) const
+{
+    if (auto it = mIds.find(name); it != mIds.end())
+    {
+        return it->second;
+    }
+    return -1;
+}
+
+/// <summary>
+/// Returns the name with the given id.
+/// </summary>
+const std::string& NameTable::getName(int id) const
+{
+    if (id < 0 || id >= static_cast<int>(mNames.size()))
+    {
+        throw JackCompilerError("Unknown name id " + std::to_string(id) + ".");
+    }
+    return mNames[id];
+}
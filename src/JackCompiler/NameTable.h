@@ -0,0 +1,29 @@
+#pragma once
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/// <summary>
+/// NameTable interns identifiers, so symbols can refer to names and types by integer ids.
+/// </summary>
+class NameTable
+{
+public:
+    /// <summary>
+    /// Returns the id of the given name. Adds the name to the table if it is not there yet.
+    /// </summary>
+    int intern(std::string_view name);
+    /// <summary>
+    /// Returns the id of the given name or -1 if the name has never been interned.
+    /// </summary>
+    int find(std::string_view name) const;
+    /// <summary>
+    /// Returns the name with the given id.
+    /// </summary>
+    const std::string& getName(int id) const;
+
+private:
+    std::deque<std::string> mNames;
+    std::unordered_map<std::string_view, int> mIds;
+};
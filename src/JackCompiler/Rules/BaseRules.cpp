@@ -31,7 +31,7 @@ void Rule::compile(VMWriter* vmWriter)
     }
 }
 
-void Rule::writeXmlSyntax(ofstream* stream, int tabs)
+void Rule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     for (const auto& pRule : mChildRules)
     {
@@ -39,7 +39,7 @@ void Rule::writeXmlSyntax(ofstream* stream, int tabs)
     }
 }
 
-void Rule::writeXmlTokens(ofstream* stream)
+void Rule::writeXmlTokens(XmlWriter* stream)
 {
     for (const auto& pRule : mChildRules)
     {
@@ -97,7 +97,7 @@ bool SequenceRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void SequenceRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void SequenceRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     Rule::writeXmlSyntax(stream, tabs + 1);
 }
@@ -137,7 +137,7 @@ void AlternationRule::compile(VMWriter* vmWriter)
     mPassedRule->compile(vmWriter);
 }
 
-void AlternationRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void AlternationRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     mPassedRule->writeXmlSyntax(stream, tabs);
 }
@@ -174,7 +174,7 @@ bool ZeroOrMoreRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void ZeroOrMoreRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ZeroOrMoreRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     int ruleTabs = tabs;
     if (getChildRules().size() > 0)
@@ -209,7 +209,7 @@ bool ZeroOrOneRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void ZeroOrOneRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ZeroOrOneRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     int ruleTabs = tabs;
     if (getChildRules().size() > 0)
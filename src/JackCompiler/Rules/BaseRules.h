@@ -5,6 +5,7 @@
 #include <vector>
 #include "../JackTokenizer.h"
 #include "../VMWriter.h"
+#include "../XmlWriter.h"
 
 class Rule;
 class SequenceRule;
@@ -16,7 +17,7 @@ class ZeroOrOneRule;
 using RuleVector = std::vector<std::shared_ptr<Rule>>;
 using CreateRuleFunc = std::function<std::shared_ptr<Rule>(void)>;
 
-#define XML_SYNTAX(text) *stream << std::string(tabs * 2, ' ') << text << "\n"
+#define XML_SYNTAX(text) stream->writeLine(tabs * 2, text)
 
 class Rule
 {
@@ -27,8 +28,8 @@ public:
 
     virtual bool initialize(JackTokenizer* pTokenizer);
     virtual void compile(VMWriter* vmWriter);
-    virtual void writeXmlSyntax(std::ofstream* stream, int tabs);
-    virtual void writeXmlTokens(std::ofstream* stream);
+    virtual void writeXmlSyntax(XmlWriter* stream, int tabs);
+    virtual void writeXmlTokens(XmlWriter* stream);
 
     Rule* getParent();
     void setParent(Rule* pRule);
@@ -69,7 +70,7 @@ public:
     ~SequenceRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class AlternationRule : public Rule
@@ -80,7 +81,7 @@ public:
 
     bool initialize(JackTokenizer* pTokenizer) override;
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
     Rule* getTrueRule();
 
@@ -95,7 +96,7 @@ public:
     ~ZeroOrMoreRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
 private:
     CreateRuleFunc onCreateRule;
@@ -108,7 +109,7 @@ public:
     ~ZeroOrOneRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
 private:
     CreateRuleFunc onCreateRule;
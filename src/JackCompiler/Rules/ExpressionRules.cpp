@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <functional>
 #include "BaseRules.h"
 #include "ExpressionRules.h"
@@ -25,6 +26,12 @@ ExpressionRule::ExpressionRule() : SequenceRule(
 
 void ExpressionRule::compile(VMWriter* vmWriter)
 {
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        compilePrefix(vmWriter, getChild(1)->getChildRules().size());
+        return;
+    }
+
     getChild(0)->compile(vmWriter);
 
     for (const auto& rule : getChild(1)->getChildRules())
@@ -34,12 +41,263 @@ void ExpressionRule::compile(VMWriter* vmWriter)
     }
 }
 
-void ExpressionRule::writeXmlSyntax(ofstream* stream, int tabs)
+void ExpressionRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<expression>");
     SequenceRule::writeXmlSyntax(stream, tabs);
     XML_SYNTAX("</expression>");
 }
+
+optional<int> ExpressionRule::getConstantValue()
+{
+    return getPrefixValue(getChild(1)->getChildRules().size());
+}
+
+TermRule* ExpressionRule::getSingleTerm()
+{
+    if (!getChild(1)->getChildRules().empty())
+    {
+        return nullptr;
+    }
+    return getChild(0)->cast<TermRule>();
+}
+
+/// <summary>
+/// Pushes the condition value for if-goto. Redundant operations are skipped, so the value may be negated:
+///     "~(x < y)" pushes "x < y" and "x = 0" pushes "x".
+/// </summary>
+/// <returns>True if the pushed value is not zero exactly when the expression is false</returns>
+bool ExpressionRule::compileCondition(VMWriter* vmWriter)
+{
+    const auto& operations = getChild(1)->getChildRules();
+    if (operations.empty())
+    {
+        return getChild(0)->cast<TermRule>()->compileCondition(vmWriter);
+    }
+
+    auto op = operations.back()->getChild(0)->cast<OpRule>()->getSymbol();
+    auto value = operations.back()->getChild(1)->cast<TermRule>()->getConstantValue();
+    if (op == '=' && value == 0)
+    {
+        compilePrefix(vmWriter, operations.size() - 1);
+        return true;
+    }
+
+    compile(vmWriter);
+    return false;
+}
+
+/// <summary>
+/// Returns true if the expression always evaluates to 0 or -1.
+/// </summary>
+bool ExpressionRule::isBoolean()
+{
+    const auto& operations = getChild(1)->getChildRules();
+    if (operations.empty())
+    {
+        return getChild(0)->cast<TermRule>()->isBoolean();
+    }
+
+    auto op = operations.back()->getChild(0)->cast<OpRule>()->getSymbol();
+    return op == '<' || op == '>' || op == '=';
+}
+
+optional<int> ExpressionRule::getPrefixValue(size_t operationCount)
+{
+    auto value = getChild(0)->cast<TermRule>()->getConstantValue();
+    const auto& operations = getChild(1)->getChildRules();
+
+    for (size_t i = 0; i < operationCount; i++)
+    {
+        if (!value)
+        {
+            return nullopt;
+        }
+
+        auto right = operations[i]->getChild(1)->cast<TermRule>()->getConstantValue();
+        if (!right)
+        {
+            return nullopt;
+        }
+
+        value = RuleUtils::evaluate(operations[i]->getChild(0)->cast<OpRule>()->getSymbol(), *value, *right);
+    }
+
+    return value;
+}
+
+// compiles the first term and the first operationCount operations
+void ExpressionRule::compilePrefix(VMWriter* vmWriter, size_t operationCount)
+{
+    if (auto value = getPrefixValue(operationCount))
+    {
+        RuleUtils::writeConstant(vmWriter, *value);
+        return;
+    }
+
+    // folded value of the constant terms at the beginning, not written yet
+    auto leadingConstant = getChild(0)->cast<TermRule>()->getConstantValue();
+    // constants added to the written operands, "x + 1 - 3" is written as "x; push 2; sub"
+    int pendingAddend = 0;
+
+    if (!leadingConstant)
+    {
+        getChild(0)->compile(vmWriter);
+    }
+
+    const auto& operations = getChild(1)->getChildRules();
+    for (size_t i = 0; i < operationCount; i++)
+    {
+        const auto& rule = operations[i];
+        auto opRule = rule->getChild(0)->cast<OpRule>();
+        auto termRule = rule->getChild(1)->cast<TermRule>();
+        auto op = opRule->getSymbol();
+        auto value = termRule->getConstantValue();
+
+        if (leadingConstant)
+        {
+            if (value)
+            {
+                if (auto result = RuleUtils::evaluate(op, *leadingConstant, *value))
+                {
+                    leadingConstant = result;
+                    continue;
+                }
+            }
+            else if (op == '+')
+            {
+                termRule->compile(vmWriter);
+                pendingAddend = *leadingConstant;
+                leadingConstant.reset();
+                continue;
+            }
+            else if (op == '-' && *leadingConstant == 0)
+            {
+                termRule->compile(vmWriter);
+                vmWriter->writeArithmetic(EArithmetic::NEG);
+                leadingConstant.reset();
+                continue;
+            }
+            else if (op == '*' || op == '&' || op == '|')
+            {
+                // commutative operators, the constant can be moved to the right side
+                termRule->compile(vmWriter);
+                if (!writeConstantOperand(vmWriter, op, *leadingConstant))
+                {
+                    RuleUtils::writeConstant(vmWriter, *leadingConstant);
+                    opRule->compile(vmWriter);
+                }
+                leadingConstant.reset();
+                continue;
+            }
+
+            RuleUtils::writeConstant(vmWriter, *leadingConstant);
+            leadingConstant.reset();
+        }
+        else if (value)
+        {
+            if (op == '+' || op == '-')
+            {
+                pendingAddend = RuleUtils::toInt16(op == '+' ? pendingAddend + *value : pendingAddend - *value);
+                continue;
+            }
+
+            writeAddition(vmWriter, pendingAddend);
+            pendingAddend = 0;
+
+            if (writeConstantOperand(vmWriter, op, *value))
+            {
+                continue;
+            }
+        }
+
+        writeAddition(vmWriter, pendingAddend);
+        pendingAddend = 0;
+
+        termRule->compile(vmWriter);
+        opRule->compile(vmWriter);
+    }
+
+    writeAddition(vmWriter, pendingAddend);
+}
+
+/// <summary>
+/// Writes operation with the constant right operand if it is cheaper than the generic one.
+/// Multiplication by a power of two is replaced with repeated doubling.
+/// </summary>
+/// <returns>False if nothing was written</returns>
+bool ExpressionRule::writeConstantOperand(VMWriter* vmWriter, char op, int value)
+{
+    switch (op)
+    {
+    case '*':
+    {
+        if (value == 0)
+        {
+            // left operand may have side effects, so it must be evaluated anyway
+            vmWriter->writePop(ESegment::TEMP, 0);
+            vmWriter->writePush(ESegment::CONSTANT, 0);
+            return true;
+        }
+
+        auto magnitude = static_cast<uint16_t>(value);
+        bool negate = false;
+        if ((magnitude & (magnitude - 1)) != 0)
+        {
+            magnitude = static_cast<uint16_t>(-value);
+            negate = true;
+        }
+        if ((magnitude & (magnitude - 1)) != 0)
+        {
+            return false;
+        }
+
+        for (; magnitude > 1; magnitude >>= 1)
+        {
+            vmWriter->writePop(ESegment::TEMP, 0);
+            vmWriter->writePush(ESegment::TEMP, 0);
+            vmWriter->writePush(ESegment::TEMP, 0);
+            vmWriter->writeArithmetic(EArithmetic::ADD);
+        }
+        if (negate)
+        {
+            vmWriter->writeArithmetic(EArithmetic::NEG);
+        }
+        return true;
+    }
+    case '/':
+        // division by other powers of two is not reduced, there are no shift commands in the VM
+        if (value == -1)
+        {
+            vmWriter->writeArithmetic(EArithmetic::NEG);
+        }
+        return value == 1 || value == -1;
+    case '&':
+        return value == -1;
+    case '|':
+        return value == 0;
+    default:
+        return false;
+    }
+}
+
+void ExpressionRule::writeAddition(VMWriter* vmWriter, int addend)
+{
+    if (addend == 0)
+    {
+        return;
+    }
+
+    if (addend == -32768)
+    {
+        RuleUtils::writeConstant(vmWriter, addend);
+        vmWriter->writeArithmetic(EArithmetic::ADD);
+        return;
+    }
+
+    vmWriter->writePush(ESegment::CONSTANT, addend > 0 ? addend : -addend);
+    vmWriter->writeArithmetic(addend > 0 ? EArithmetic::ADD : EArithmetic::SUB);
+}
 #pragma endregion
 
 #pragma region TermRule
@@ -92,6 +350,27 @@ bool TermRule::initialize(JackTokenizer* pTokenizer)
 
 void TermRule::compile(VMWriter* vmWriter)
 {
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        if (auto value = getConstantValue())
+        {
+            RuleUtils::writeConstant(vmWriter, *value);
+            return;
+        }
+
+        // -(-x) and ~(~x) are reduced to x
+        char op = 0;
+        char innerOp = 0;
+        if (auto operand = getUnaryOperand(op))
+        {
+            if (auto innerOperand = operand->getUnaryOperand(innerOp); innerOperand && op == innerOp)
+            {
+                innerOperand->compile(vmWriter);
+                return;
+            }
+        }
+    }
+
     if (auto integerRule = getChild(0)->cast<IntegerConstantRule>())
     {
         vmWriter->writePush(ESegment::CONSTANT, integerRule->getValue());
@@ -99,6 +378,12 @@ void TermRule::compile(VMWriter* vmWriter)
     }
     if (auto stringRule = getChild(0)->cast<StringConstantRule>())
     {
+        if (RuleUtils::getOptions(this).poolStrings)
+        {
+            compilePooledString(vmWriter, stringRule);
+            return;
+        }
+
         auto stringValue = stringRule->toString();
         vmWriter->writePush(ESegment::CONSTANT, static_cast<int>(stringValue.length()));
         vmWriter->writeCall("String.new", 1);
@@ -117,7 +402,7 @@ void TermRule::compile(VMWriter* vmWriter)
     }
     if (auto varNameRule = getChild(0)->cast<VarNameRule>())
     {
-        auto symbol = RuleUtils::findSymbol(this, varNameRule->toString());
+        const auto& symbol = RuleUtils::findSymbol(this, varNameRule->toString());
         vmWriter->writePush(symbol.getSegment(), symbol.index);
         return;
     }
@@ -141,7 +426,17 @@ void TermRule::compile(VMWriter* vmWriter)
     }
 
     // arrays
-    auto symbol = RuleUtils::findSymbol(this, sequenceRule->getChild(0)->cast<VarNameRule>()->toString());
+    const auto& symbol = RuleUtils::findSymbol(this, sequenceRule->getChild(0)->cast<VarNameRule>()->toString());
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        if (auto index = sequenceRule->getChild(2)->cast<ExpressionRule>()->getConstantValue(); index && *index >= 0)
+        {
+            vmWriter->writeThatBase(symbol.getSegment(), symbol.index);
+            vmWriter->writePush(ESegment::THAT, *index);
+            return;
+        }
+    }
+
     sequenceRule->getChild(2)->compile(vmWriter);
     vmWriter->writePush(symbol.getSegment(), symbol.index);
     vmWriter->writeArithmetic(EArithmetic::ADD);
@@ -149,7 +444,7 @@ void TermRule::compile(VMWriter* vmWriter)
     vmWriter->writePush(ESegment::THAT, 0);
 }
 
-void TermRule::writeXmlSyntax(ofstream* stream, int tabs)
+void TermRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<term>");
 
@@ -166,6 +461,151 @@ void TermRule::writeXmlSyntax(ofstream* stream, int tabs)
 
     XML_SYNTAX("</term>");
 }
+
+optional<int> TermRule::getConstantValue()
+{
+    if (auto integerRule = getChild(0)->cast<IntegerConstantRule>())
+    {
+        return integerRule->getValue();
+    }
+    if (auto keywordRule = getChild(0)->cast<KeywordConstantRule>())
+    {
+        auto constant = keywordRule->getTrueRule()->cast<KeywordRule>()->toString();
+        if (constant == "this")
+        {
+            return nullopt;
+        }
+        return constant == "true" ? -1 : 0;
+    }
+
+    auto sequenceRule = getChild(0)->cast<SequenceRule>();
+    if (!sequenceRule)
+    {
+        return nullopt;
+    }
+    if (auto unaryOpRule = sequenceRule->getChild(0)->cast<UnaryOpRule>())
+    {
+        auto value = sequenceRule->getChild(1)->cast<TermRule>()->getConstantValue();
+        if (!value)
+        {
+            return nullopt;
+        }
+        return unaryOpRule->getSymbol() == '-' ? RuleUtils::toInt16(-*value) : ~*value;
+    }
+    if (auto expressionRule = sequenceRule->getChild(1)->cast<ExpressionRule>(); expressionRule && sequenceRule->getChild(0)->cast<SymbolRule>())
+    {
+        return expressionRule->getConstantValue();
+    }
+
+    return nullopt;
+}
+
+/// <summary>
+/// Pushes the string literal stored in a static variable of the class.
+/// The string is created when the statement is executed for the first time.
+/// </summary>
+void TermRule::compilePooledString(VMWriter* vmWriter, StringConstantRule* stringRule)
+{
+    auto stringValue = stringRule->toString();
+    auto index = getParentRecursive<ClassRule>()->getPooledStringIndex(stringValue);
+    auto label = "STRING_READY" + to_string(getParentRecursive<SubroutineDecRule>()->getUniqueNumber(stringRule));
+
+    // static variables are 0 until the first execution
+    vmWriter->writePush(ESegment::STATIC, index);
+    vmWriter->writeIf(label);
+
+    vmWriter->writePush(ESegment::CONSTANT, static_cast<int>(stringValue.length()));
+    vmWriter->writeCall("String.new", 1);
+    for (auto character : stringValue)
+    {
+        vmWriter->writePush(ESegment::CONSTANT, character);
+        vmWriter->writeCall("String.appendChar", 2);
+    }
+    vmWriter->writePop(ESegment::STATIC, index);
+
+    vmWriter->writeLabel(label);
+    vmWriter->writePush(ESegment::STATIC, index);
+}
+
+/// <summary>
+/// Pushes the condition value for if-goto, see ExpressionRule::compileCondition.
+/// </summary>
+/// <returns>True if the pushed value is not zero exactly when the term is false</returns>
+bool TermRule::compileCondition(VMWriter* vmWriter)
+{
+    // ~x is zero exactly when x is not zero only for x equal to 0 or -1
+    char op = 0;
+    if (auto operand = getUnaryOperand(op); operand && op == '~' && operand->isBoolean())
+    {
+        return !operand->compileCondition(vmWriter);
+    }
+
+    auto sequenceRule = getChild(0)->cast<SequenceRule>();
+    if (sequenceRule && sequenceRule->getChild(0)->cast<SymbolRule>())
+    {
+        return sequenceRule->getChild(1)->cast<ExpressionRule>()->compileCondition(vmWriter);
+    }
+
+    compile(vmWriter);
+    return false;
+}
+
+/// <summary>
+/// Returns true if the term always evaluates to 0 or -1.
+/// </summary>
+bool TermRule::isBoolean()
+{
+    if (auto value = getConstantValue())
+    {
+        return *value == 0 || *value == -1;
+    }
+
+    auto sequenceRule = getChild(0)->cast<SequenceRule>();
+    if (!sequenceRule)
+    {
+        return false;
+    }
+    if (auto unaryOpRule = sequenceRule->getChild(0)->cast<UnaryOpRule>())
+    {
+        return unaryOpRule->getSymbol() == '~' && sequenceRule->getChild(1)->cast<TermRule>()->isBoolean();
+    }
+    if (sequenceRule->getChild(0)->cast<SymbolRule>())
+    {
+        return sequenceRule->getChild(1)->cast<ExpressionRule>()->isBoolean();
+    }
+    return false;
+}
+
+TermRule* TermRule::getUnaryOperand(char& op)
+{
+    TermRule* termRule = this;
+
+    while (true)
+    {
+        auto sequenceRule = termRule->getChild(0)->cast<SequenceRule>();
+        if (!sequenceRule)
+        {
+            return nullptr;
+        }
+        if (auto unaryOpRule = sequenceRule->getChild(0)->cast<UnaryOpRule>())
+        {
+            op = unaryOpRule->getSymbol();
+            return sequenceRule->getChild(1)->cast<TermRule>();
+        }
+
+        // (expression) with single term
+        auto expressionRule = sequenceRule->getChild(1)->cast<ExpressionRule>();
+        if (!expressionRule || !sequenceRule->getChild(0)->cast<SymbolRule>())
+        {
+            return nullptr;
+        }
+        termRule = expressionRule->getSingleTerm();
+        if (!termRule)
+        {
+            return nullptr;
+        }
+    }
+}
 #pragma endregion
 
 #pragma region SubroutineCallRule
@@ -219,9 +659,9 @@ void SubroutineCallRule::compile(VMWriter* vmWriter)
     auto identifierRule = getTrueRule()->getChild(0)->cast<AlternationRule>()->getTrueRule()->cast<IdentifierRule>();
 
     // varName.subroutineName(expressionList)
-    if (auto symbol = RuleUtils::findSymbol(this, identifierRule->toString()); symbol.kind != ESymbolKind::UNDEFINED)
+    if (const auto& symbol = RuleUtils::findSymbol(this, identifierRule->toString()); symbol.kind != ESymbolKind::UNDEFINED)
     {
-        className = symbol.type;
+        className = RuleUtils::getTypeName(this, symbol);
         subroutineName = getTrueRule()->getChild(2)->cast<SubroutineNameRule>()->toString();
         expressionListRule = getTrueRule()->getChild(4)->cast<ExpressionListRule>();
 
@@ -241,7 +681,7 @@ void SubroutineCallRule::compile(VMWriter* vmWriter)
     vmWriter->writeCall(className + "." + subroutineName, expressionListRule->getExpressionCount());
 }
 
-void SubroutineCallRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void SubroutineCallRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     AlternationRule::writeXmlSyntax(stream, tabs - 1);
 }
@@ -269,7 +709,7 @@ ExpressionListRule::ExpressionListRule() : SequenceRule(
 {
 }
 
-void ExpressionListRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ExpressionListRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<expressionList>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -306,7 +746,7 @@ OpRule::OpRule() : AlternationRule(
 
 void OpRule::compile(VMWriter* vmWriter)
 {
-    auto symbol = getTrueRule()->cast<SymbolRule>()->getValue();
+    auto symbol = getSymbol();
     switch (symbol)
     {
     case '+':
@@ -340,6 +780,11 @@ void OpRule::compile(VMWriter* vmWriter)
         break;
     }
 }
+
+char OpRule::getSymbol()
+{
+    return getTrueRule()->cast<SymbolRule>()->getValue();
+}
 #pragma endregion
 
 #pragma region UnaryOpRule
@@ -353,7 +798,7 @@ UnaryOpRule::UnaryOpRule() : AlternationRule(
 
 void UnaryOpRule::compile(VMWriter* vmWriter)
 {
-    auto symbol = getTrueRule()->cast<SymbolRule>()->getValue();
+    auto symbol = getSymbol();
     switch (symbol)
     {
     case '-':
@@ -366,6 +811,11 @@ void UnaryOpRule::compile(VMWriter* vmWriter)
         break;
     }
 }
+
+char UnaryOpRule::getSymbol()
+{
+    return getTrueRule()->cast<SymbolRule>()->getValue();
+}
 #pragma endregion
 
 #pragma region KeywordConstantRule
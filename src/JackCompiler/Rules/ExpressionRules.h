@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include "BaseRules.h"
 
 class ExpressionRule;
@@ -9,6 +10,7 @@ class ExpressionListRule;
 class OpRule;
 class UnaryOpRule;
 class KeywordConstantRule;
+class StringConstantRule;
 
 
 class ExpressionRule : public SequenceRule
@@ -18,7 +20,32 @@ public:
     ~ExpressionRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
+
+    /// <summary>
+    /// Returns value of the expression if it can be computed at compile time.
+    /// </summary>
+    std::optional<int> getConstantValue();
+    /// <summary>
+    /// Returns the only term of the expression or nullptr if there are operators.
+    /// </summary>
+    TermRule* getSingleTerm();
+    /// <summary>
+    /// Pushes the condition value for if-goto. Redundant operations are skipped, so the value may be negated:
+    ///     "~(x < y)" pushes "x < y" and "x = 0" pushes "x".
+    /// </summary>
+    /// <returns>True if the pushed value is not zero exactly when the expression is false</returns>
+    bool compileCondition(VMWriter* vmWriter);
+    /// <summary>
+    /// Returns true if the expression always evaluates to 0 or -1.
+    /// </summary>
+    bool isBoolean();
+
+private:
+    std::optional<int> getPrefixValue(size_t operationCount);
+    void compilePrefix(VMWriter* vmWriter, size_t operationCount);
+    static bool writeConstantOperand(VMWriter* vmWriter, char op, int value);
+    static void writeAddition(VMWriter* vmWriter, int addend);
 };
 
 class TermRule : public Rule
@@ -29,9 +56,30 @@ public:
 
     bool initialize(JackTokenizer* pTokenizer) override;
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
+
+    /// <summary>
+    /// Returns value of the term if it can be computed at compile time.
+    /// </summary>
+    std::optional<int> getConstantValue();
+    /// <summary>
+    /// Returns the unary operator and its operand if the term, after skipping redundant
+    ///     parentheses, is an unary operation. Otherwise returns nullptr.
+    /// </summary>
+    TermRule* getUnaryOperand(char& op);
+    /// <summary>
+    /// Pushes the condition value for if-goto, see ExpressionRule::compileCondition.
+    /// </summary>
+    /// <returns>True if the pushed value is not zero exactly when the term is false</returns>
+    bool compileCondition(VMWriter* vmWriter);
+    /// <summary>
+    /// Returns true if the term always evaluates to 0 or -1.
+    /// </summary>
+    bool isBoolean();
 
 private:
+    void compilePooledString(VMWriter* vmWriter, StringConstantRule* stringRule);
+
     std::vector<CreateRuleFunc> mCreateRuleFuncs;
 };
 
@@ -42,7 +90,7 @@ public:
     ~SubroutineCallRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class ExpressionListRule : public SequenceRule
@@ -51,7 +99,7 @@ public:
     ExpressionListRule();
     ~ExpressionListRule() override = default;
 
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
     int getExpressionCount();
 };
@@ -63,6 +111,8 @@ public:
     ~OpRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
+
+    char getSymbol();
 };
 
 class UnaryOpRule : public AlternationRule
@@ -72,6 +122,8 @@ public:
     ~UnaryOpRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
+
+    char getSymbol();
 };
 
 class KeywordConstantRule : public AlternationRule
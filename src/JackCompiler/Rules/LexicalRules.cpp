@@ -50,44 +50,14 @@ bool LexicalRule::initialize(JackTokenizer* pTokenizer)
     return result;
 }
 
-void LexicalRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void LexicalRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
-    string toWrite = "<" + getClassName() + ">" + encodeXml(toString()) + "</" + getClassName() + ">";
-    XML_SYNTAX(toWrite);
+    stream->writeElement(tabs * 2, getClassName(), toString());
 }
 
-void LexicalRule::writeXmlTokens(std::ofstream* stream)
+void LexicalRule::writeXmlTokens(XmlWriter* stream)
 {
-    *stream << "<" << getClassName() << ">" << encodeXml(toString()) << "</" << getClassName() << ">\n";
-}
-
-string LexicalRule::encodeXml(const string& text) const
-{
-    string result;
-
-    for (char symbol : text)
-    {
-        switch (symbol)
-        {
-        case '<':
-            result += "&lt;";
-            continue;
-        case '>':
-            result += "&gt;";
-            continue;
-        case '"':
-            result += "&quot;";
-            continue;
-        case '&':
-            result += "&amp;";
-            continue;
-        default:
-            result += symbol;
-            continue;
-        }
-    }
-
-    return result;
+    stream->writeElement(0, getClassName(), toString());
 }
 #pragma endregion
 
@@ -22,17 +22,14 @@ public:
     ~LexicalRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) final;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) final;
-    void writeXmlTokens(std::ofstream* stream) final;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) final;
+    void writeXmlTokens(XmlWriter* stream) final;
 
     virtual std::string toString() = 0;
 
 protected:
     virtual bool isFullfiled(JackTokenizer* pTokenizer) = 0;
     virtual std::string getClassName() = 0;
-
-private:
-    std::string encodeXml(const std::string& text) const;
 };
 
 class KeywordRule : public LexicalRule
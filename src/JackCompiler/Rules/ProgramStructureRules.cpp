@@ -26,7 +26,7 @@ ClassRule::ClassRule() : SequenceRule(
 {
 }
 
-void ClassRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ClassRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<class>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -38,6 +38,26 @@ SymbolTable& ClassRule::getSymbolTable()
     return mSymbolTable;
 }
 
+const CompilationOptions& ClassRule::getOptions() const
+{
+    return mOptions;
+}
+
+void ClassRule::setOptions(const CompilationOptions& options)
+{
+    mOptions = options;
+}
+
+/// <summary>
+/// Returns index of the static variable holding the pooled string literal.
+/// Pooled strings are placed after the declared static variables.
+/// </summary>
+int ClassRule::getPooledStringIndex(const string& value)
+{
+    auto index = mSymbolTable.varCount(ESymbolKind::STATIC) + static_cast<int>(mPooledStrings.size());
+    return mPooledStrings.try_emplace(value, index).first->second;
+}
+
 #pragma endregion
 
 #pragma region ClassVarDecRule
@@ -88,7 +108,7 @@ bool ClassVarDecRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void ClassVarDecRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ClassVarDecRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<classVarDec>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -133,19 +153,9 @@ SubroutineDecRule::SubroutineDecRule() : SequenceRule(
 
 bool SubroutineDecRule::initialize(JackTokenizer* pTokenizer)
 {
-    if (!SequenceRule::initialize(pTokenizer))
-    {
-        return false;
-    }
-
-    if (auto subroutineType = getChild(0)->cast<AlternationRule>()->getTrueRule()->cast<KeywordRule>()->toString(); subroutineType == "method")
-    {
-        auto classRule = getParentRecursive<ClassRule>();
-        auto className = classRule->getChild(1)->cast<ClassNameRule>()->toString();
-        mSymbolTable.define("this", className, ESymbolKind::ARG, 0);
-    }
+    mSymbolTable.setParent(&getParentRecursive<ClassRule>()->getSymbolTable());
 
-    return true;
+    return SequenceRule::initialize(pTokenizer);
 }
 
 void SubroutineDecRule::compile(VMWriter* vmWriter)
@@ -171,15 +181,9 @@ void SubroutineDecRule::compile(VMWriter* vmWriter)
     }
 
     getChild(6)->compile(vmWriter);
-
-    if (auto keywordRule = getChild(1)->cast<AlternationRule>()->getTrueRule()->cast<KeywordRule>())
-    {
-        vmWriter->writePush(ESegment::CONSTANT, 0);
-        vmWriter->writeReturn();
-    }
 }
 
-void SubroutineDecRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void SubroutineDecRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<subroutineDec>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -191,6 +195,12 @@ SymbolTable& SubroutineDecRule::getSymbolTable()
     return mSymbolTable;
 }
 
+bool SubroutineDecRule::isMethod()
+{
+    auto keywordRule = getChild(0)->cast<AlternationRule>()->getTrueRule()->cast<KeywordRule>();
+    return keywordRule->toString() == "method";
+}
+
 int SubroutineDecRule::getUniqueNumber(Rule* rule)
 {
     if (auto whileRule = rule->cast<WhileStatementRule>())
@@ -201,6 +211,10 @@ int SubroutineDecRule::getUniqueNumber(Rule* rule)
     {
         return ifCounter++;
     }
+    if (auto stringRule = rule->cast<StringConstantRule>())
+    {
+        return stringCounter++;
+    }
     throw JackCompilerError("Unique number is unsupported for rule.");
 }
 #pragma endregion
@@ -230,12 +244,21 @@ bool ParameterListRule::initialize(JackTokenizer* pTokenizer)
 {
     ZeroOrOneRule::initialize(pTokenizer);
 
+    auto subroutineRule = getParentRecursive<SubroutineDecRule>();
+    auto& subroutineTable = subroutineRule->getSymbolTable();
+
+    // 'this' is always the first argument of a method
+    if (subroutineRule->isMethod())
+    {
+        auto className = getParentRecursive<ClassRule>()->getChild(1)->cast<ClassNameRule>()->toString();
+        subroutineTable.define("this", className, ESymbolKind::ARG);
+    }
+
     if (getChildRules().size() == 0)
     {
         return true;
     }
 
-    auto& subroutineTable = getParentRecursive<SubroutineDecRule>()->getSymbolTable();
     auto type = getChild(0)->getChild(0)->cast<TypeRule>()->getTrueRule()->cast<LexicalRule>()->toString();
     auto name = getChild(0)->getChild(1)->cast<VarNameRule>()->toString();
     subroutineTable.define(name, type, ESymbolKind::ARG);
@@ -250,7 +273,7 @@ bool ParameterListRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void ParameterListRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ParameterListRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<parameterList>");
     ZeroOrOneRule::writeXmlSyntax(stream, tabs);
@@ -297,7 +320,7 @@ bool SubroutineBodyRule::initialize(JackTokenizer* pTokenizer)
     return true;
 }
 
-void SubroutineBodyRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void SubroutineBodyRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<subroutineBody>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -324,7 +347,7 @@ VarDecRule::VarDecRule() : SequenceRule(
 {
 }
 
-void VarDecRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void VarDecRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<varDec>");
     SequenceRule::writeXmlSyntax(stream, tabs);
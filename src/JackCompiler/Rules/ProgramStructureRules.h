@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
+#include <string>
 #include "BaseRules.h"
 #include "LexicalRules.h"
+#include "../CompilationOptions.h"
 #include "../SymbolTable.h"
 
 class ClassRule;
@@ -22,12 +25,21 @@ public:
     ClassRule();
     ~ClassRule() override = default;
 
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
     SymbolTable& getSymbolTable();
+    const CompilationOptions& getOptions() const;
+    void setOptions(const CompilationOptions& options);
+    /// <summary>
+    /// Returns index of the static variable holding the pooled string literal.
+    /// Pooled strings are placed after the declared static variables.
+    /// </summary>
+    int getPooledStringIndex(const std::string& value);
 
 private:
     SymbolTable mSymbolTable;
+    CompilationOptions mOptions;
+    std::map<std::string, int> mPooledStrings;
 };
 
 class ClassVarDecRule : public SequenceRule
@@ -37,7 +49,7 @@ public:
     ~ClassVarDecRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class TypeRule : public AlternationRule
@@ -55,15 +67,17 @@ public:
 
     bool initialize(JackTokenizer* pTokenizer) override;
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 
     SymbolTable& getSymbolTable();
     int getUniqueNumber(Rule* rule);
+    bool isMethod();
 
 private:
     SymbolTable mSymbolTable;
     int whileCounter = 0;
     int ifCounter = 0;
+    int stringCounter = 0;
 };
 
 class ParameterListRule : public ZeroOrOneRule
@@ -73,7 +87,7 @@ public:
     ~ParameterListRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class SubroutineBodyRule : public SequenceRule
@@ -83,7 +97,7 @@ public:
     ~SubroutineBodyRule() override = default;
 
     bool initialize(JackTokenizer* pTokenizer) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class VarDecRule : public SequenceRule
@@ -92,7 +106,7 @@ public:
     VarDecRule();
     ~VarDecRule() override = default;
 
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class ClassNameRule : public IdentifierRule
@@ -1,18 +1,110 @@
+#include <cstdint>
+#include <sstream>
 #include "BaseRules.h"
+#include "ExpressionRules.h"
 #include "ProgramStructureRules.h"
 #include "RuleUtils.h"
 #include "../JackCompilerError.h"
+#include "../VMWriter.h"
 
-Symbol RuleUtils::findSymbol(Rule* rule, const std::string& name)
+const Symbol& RuleUtils::findSymbol(Rule* rule, const std::string& name)
 {
-    auto& classTable = rule->getParentRecursive<ClassRule>()->getSymbolTable();
-    auto& subroutineTable = rule->getParentRecursive<SubroutineDecRule>()->getSymbolTable();
+    // subroutine scope is chained to the class scope
+    return rule->getParentRecursive<SubroutineDecRule>()->getSymbolTable().getSymbol(name);
+}
 
-    auto symbol = subroutineTable.getSymbol(name);
-    if (symbol.kind == ESymbolKind::UNDEFINED)
+const std::string& RuleUtils::getTypeName(Rule* rule, const Symbol& symbol)
+{
+    return rule->getParentRecursive<SubroutineDecRule>()->getSymbolTable().getName(symbol.type);
+}
+
+const CompilationOptions& RuleUtils::getOptions(Rule* rule)
+{
+    return rule->getParentRecursive<ClassRule>()->getOptions();
+}
+
+int RuleUtils::toInt16(int value)
+{
+    return static_cast<int16_t>(static_cast<uint16_t>(value));
+}
+
+std::optional<int> RuleUtils::evaluate(char op, int left, int right)
+{
+    switch (op)
+    {
+    case '+':
+        return toInt16(left + right);
+    case '-':
+        return toInt16(left - right);
+    case '*':
+        return toInt16(left * right);
+    case '/':
+        // Math.divide reports division by zero at run time and cannot negate -32768
+        if (right == 0 || left == -32768 || right == -32768)
+        {
+            return std::nullopt;
+        }
+        return toInt16(left / right);
+    case '&':
+        return left & right;
+    case '|':
+        return left | right;
+    case '<':
+        return left < right ? -1 : 0;
+    case '>':
+        return left > right ? -1 : 0;
+    case '=':
+        return left == right ? -1 : 0;
+    default:
+        return std::nullopt;
+    }
+}
+
+void RuleUtils::writeConstant(VMWriter* vmWriter, int value)
+{
+    value = toInt16(value);
+    if (value >= 0)
     {
-        symbol = classTable.getSymbol(name);
+        vmWriter->writePush(ESegment::CONSTANT, value);
+        return;
     }
 
-    return symbol;
+    // ~x is -x-1, so -1 and -32768 are one command shorter with not
+    if (value == -1 || value == -32768)
+    {
+        vmWriter->writePush(ESegment::CONSTANT, -value - 1);
+        vmWriter->writeArithmetic(EArithmetic::NOT);
+        return;
+    }
+
+    vmWriter->writePush(ESegment::CONSTANT, -value);
+    vmWriter->writeArithmetic(EArithmetic::NEG);
+}
+
+void RuleUtils::compileUnreachable(Rule* rule)
+{
+    std::ostringstream discardedStream;
+    VMWriter discardedWriter(discardedStream);
+    rule->compile(&discardedWriter);
+}
+
+bool RuleUtils::containsArrayAccess(Rule* rule)
+{
+    if (auto termRule = rule->cast<TermRule>())
+    {
+        auto sequenceRule = termRule->getChild(0)->cast<SequenceRule>();
+        if (sequenceRule && sequenceRule->getChild(0)->cast<VarNameRule>())
+        {
+            return true;
+        }
+    }
+
+    for (const auto& childRule : rule->getChildRules())
+    {
+        if (containsArrayAccess(childRule.get()))
+        {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -1,9 +1,39 @@
 #pragma once
 
+#include <optional>
+#include <string>
+#include "../CompilationOptions.h"
 #include "../Symbol.h"
 
+class Rule;
+class VMWriter;
+
 class RuleUtils
 {
 public:
-    static Symbol findSymbol(Rule* rule, const std::string& name);
+    static const Symbol& findSymbol(Rule* rule, const std::string& name);
+    static const std::string& getTypeName(Rule* rule, const Symbol& symbol);
+    static const CompilationOptions& getOptions(Rule* rule);
+
+    /// <summary>
+    /// Wraps the value into the 16-bit two's complement range.
+    /// </summary>
+    static int toInt16(int value);
+    /// <summary>
+    /// Evaluates binary operator on constant operands the same way as Hack VM and Math class do.
+    /// Returns std::nullopt if the result must be computed at run time (e.g. division by zero).
+    /// </summary>
+    static std::optional<int> evaluate(char op, int left, int right);
+    /// <summary>
+    /// Pushes any 16-bit constant using the shortest sequence of VM commands.
+    /// </summary>
+    static void writeConstant(VMWriter* vmWriter, int value);
+    /// <summary>
+    /// Compiles the rule without writing any code, so errors in the unreachable code are still reported.
+    /// </summary>
+    static void compileUnreachable(Rule* rule);
+    /// <summary>
+    /// Returns true if the rule contains an array element term, which changes pointer 1.
+    /// </summary>
+    static bool containsArrayAccess(Rule* rule);
 };
\ No newline at end of file
@@ -20,7 +20,7 @@ StatementsRule::StatementsRule() : SequenceRule(
 {
 }
 
-void StatementsRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void StatementsRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<statements>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -65,7 +65,7 @@ LetStatementRule::LetStatementRule() : SequenceRule(
 void LetStatementRule::compile(VMWriter* vmWriter)
 {
     auto variableName = getChild(1)->cast<VarNameRule>()->toString();
-    auto symbol = RuleUtils::findSymbol(this, variableName);
+    const auto& symbol = RuleUtils::findSymbol(this, variableName);
 
     if (getChild(2)->getChildRules().empty())
     {
@@ -74,6 +74,12 @@ void LetStatementRule::compile(VMWriter* vmWriter)
         return;
     }
 
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        compileArrayAssignment(vmWriter, symbol);
+        return;
+    }
+
     getChild(2)->getChild(0)->getChild(1)->compile(vmWriter);
     vmWriter->writePush(symbol.getSegment(), symbol.index);
     vmWriter->writeArithmetic(EArithmetic::ADD);
@@ -86,7 +92,55 @@ void LetStatementRule::compile(VMWriter* vmWriter)
     vmWriter->writePop(ESegment::THAT, 0);
 }
 
-void LetStatementRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+/// <summary>
+/// Writes the array element without saving the value in temp 0, if pointer 1 can be set before the value
+///     is computed. Constant indexes use THAT segment directly, so THAT may be already set by the previous access.
+/// </summary>
+void LetStatementRule::compileArrayAssignment(VMWriter* vmWriter, const Symbol& symbol)
+{
+    auto indexRule = getChild(2)->getChild(0)->getChild(1)->cast<ExpressionRule>();
+    auto valueRule = getChild(4);
+    // functions restore pointer 1 when they return, so only array accesses change it
+    bool isThatPreserved = !RuleUtils::containsArrayAccess(valueRule);
+    // the value cannot change local variables and arguments, so the array may be read after the value
+    bool isLocalArray = symbol.kind == ESymbolKind::VAR || symbol.kind == ESymbolKind::ARG;
+
+    if (auto index = indexRule->getConstantValue(); index && *index >= 0 && (isThatPreserved || isLocalArray))
+    {
+        if (isThatPreserved)
+        {
+            vmWriter->writeThatBase(symbol.getSegment(), symbol.index);
+            valueRule->compile(vmWriter);
+        }
+        else
+        {
+            valueRule->compile(vmWriter);
+            vmWriter->writeThatBase(symbol.getSegment(), symbol.index);
+        }
+        vmWriter->writePop(ESegment::THAT, *index);
+        return;
+    }
+
+    indexRule->compile(vmWriter);
+    vmWriter->writePush(symbol.getSegment(), symbol.index);
+    vmWriter->writeArithmetic(EArithmetic::ADD);
+
+    if (isThatPreserved)
+    {
+        vmWriter->writePop(ESegment::POINTER, 1);
+        valueRule->compile(vmWriter);
+        vmWriter->writePop(ESegment::THAT, 0);
+        return;
+    }
+
+    valueRule->compile(vmWriter);
+    vmWriter->writePop(ESegment::TEMP, 0);
+    vmWriter->writePop(ESegment::POINTER, 1);
+    vmWriter->writePush(ESegment::TEMP, 0);
+    vmWriter->writePop(ESegment::THAT, 0);
+}
+
+void LetStatementRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<letStatement>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -122,6 +176,12 @@ void IfStatementRule::compile(VMWriter* vmWriter)
 {
     auto uniqueNumber = getParentRecursive<SubroutineDecRule>()->getUniqueNumber(this);
 
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        compileOptimized(vmWriter, to_string(uniqueNumber));
+        return;
+    }
+
     getChild(2)->compile(vmWriter);
     vmWriter->writeIf("IF_TRUE" + to_string(uniqueNumber));
     vmWriter->writeGoto("IF_FALSE" + to_string(uniqueNumber));
@@ -144,7 +204,51 @@ void IfStatementRule::compile(VMWriter* vmWriter)
     }
 }
 
-void IfStatementRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+/// <summary>
+/// Jumps over the branch, which is written first, with a single if-goto on the condition value.
+/// <para/> The branch taken on the not zero value is placed after the jump, so the condition is never negated
+///     with an extra 'not' command. Branches of a constant condition are resolved at compile time.
+/// </summary>
+void IfStatementRule::compileOptimized(VMWriter* vmWriter, const string& labelSuffix)
+{
+    auto conditionRule = getChild(2)->cast<ExpressionRule>();
+    auto thenRule = getChild(5);
+    auto elseRule = getChild(7);
+    bool hasElse = elseRule->getChildRules().size() > 0;
+
+    if (auto value = conditionRule->getConstantValue())
+    {
+        if (*value != 0)
+        {
+            thenRule->compile(vmWriter);
+            RuleUtils::compileUnreachable(elseRule);
+        }
+        else
+        {
+            RuleUtils::compileUnreachable(thenRule);
+            elseRule->compile(vmWriter);
+        }
+        return;
+    }
+
+    bool isNegated = conditionRule->compileCondition(vmWriter);
+    auto jumpLabel = (isNegated ? "IF_FALSE" : "IF_TRUE") + labelSuffix;
+    vmWriter->writeIf(jumpLabel);
+
+    (isNegated ? thenRule : elseRule)->compile(vmWriter);
+    if (isNegated && !hasElse)
+    {
+        vmWriter->writeLabel(jumpLabel);
+        return;
+    }
+    vmWriter->writeGoto("IF_END" + labelSuffix);
+
+    vmWriter->writeLabel(jumpLabel);
+    (isNegated ? elseRule : thenRule)->compile(vmWriter);
+    vmWriter->writeLabel("IF_END" + labelSuffix);
+}
+
+void IfStatementRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<ifStatement>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -170,6 +274,12 @@ void WhileStatementRule::compile(VMWriter* vmWriter)
 {
     auto uniqueNumber = getParentRecursive<SubroutineDecRule>()->getUniqueNumber(this);
 
+    if (RuleUtils::getOptions(this).optimize)
+    {
+        compileRotated(vmWriter, to_string(uniqueNumber));
+        return;
+    }
+
     vmWriter->writeLabel("WHILE_EXP" + to_string(uniqueNumber));
     getChild(2)->compile(vmWriter);
     
@@ -182,7 +292,48 @@ void WhileStatementRule::compile(VMWriter* vmWriter)
     vmWriter->writeLabel("WHILE_END" + to_string(uniqueNumber));
 }
 
-void WhileStatementRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+/// <summary>
+/// Writes the loop with the condition at the bottom: "goto WHILE_EXP; label WHILE_START; body;
+///     label WHILE_EXP; condition; if-goto WHILE_START", so an iteration executes a single if-goto.
+///     A negated condition, e.g. "x = 0" pushing x, ends with "if-goto WHILE_END; goto WHILE_START".
+/// </summary>
+void WhileStatementRule::compileRotated(VMWriter* vmWriter, const string& labelSuffix)
+{
+    auto conditionRule = getChild(2)->cast<ExpressionRule>();
+    auto value = conditionRule->getConstantValue();
+    if (value == 0)
+    {
+        RuleUtils::compileUnreachable(getChild(5));
+        return;
+    }
+
+    if (!value)
+    {
+        vmWriter->writeGoto("WHILE_EXP" + labelSuffix);
+    }
+    vmWriter->writeLabel("WHILE_START" + labelSuffix);
+    getChild(5)->compile(vmWriter);
+
+    if (value)
+    {
+        vmWriter->writeGoto("WHILE_START" + labelSuffix);
+        return;
+    }
+
+    vmWriter->writeLabel("WHILE_EXP" + labelSuffix);
+    if (!conditionRule->compileCondition(vmWriter))
+    {
+        vmWriter->writeIf("WHILE_START" + labelSuffix);
+        return;
+    }
+
+    // the pushed value is not zero when the loop ends, not would invert it only for 0 and -1
+    vmWriter->writeIf("WHILE_END" + labelSuffix);
+    vmWriter->writeGoto("WHILE_START" + labelSuffix);
+    vmWriter->writeLabel("WHILE_END" + labelSuffix);
+}
+
+void WhileStatementRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<whileStatement>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -206,7 +357,7 @@ void DoStatementRule::compile(VMWriter* vmWriter)
     vmWriter->writePop(ESegment::TEMP, 0);
 }
 
-void DoStatementRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void DoStatementRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<doStatement>");
     SequenceRule::writeXmlSyntax(stream, tabs);
@@ -229,9 +380,11 @@ ReturnStatementRule::ReturnStatementRule() : SequenceRule(
 
 void ReturnStatementRule::compile(VMWriter* vmWriter)
 {
+    // void subroutines return 0, also from the middle of the body
     if (getChild(1)->getChildRules().empty())
     {
-        // void method are handled by SubroutineDecRule
+        vmWriter->writePush(ESegment::CONSTANT, 0);
+        vmWriter->writeReturn();
         return;
     }
 
@@ -239,7 +392,7 @@ void ReturnStatementRule::compile(VMWriter* vmWriter)
     vmWriter->writeReturn();
 }
 
-void ReturnStatementRule::writeXmlSyntax(std::ofstream* stream, int tabs)
+void ReturnStatementRule::writeXmlSyntax(XmlWriter* stream, int tabs)
 {
     XML_SYNTAX("<returnStatement>");
     SequenceRule::writeXmlSyntax(stream, tabs);
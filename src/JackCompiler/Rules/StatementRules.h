@@ -10,6 +10,7 @@ class IfStatementRule;
 class WhileStatementRule;
 class DoStatementRule;
 class ReturnStatementRule;
+struct Symbol;
 
 
 class StatementsRule : public SequenceRule
@@ -18,7 +19,7 @@ public:
     StatementsRule();
     ~StatementsRule() override = default;
 
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class StatementRule : public AlternationRule
@@ -35,7 +36,10 @@ public:
     ~LetStatementRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
+
+private:
+    void compileArrayAssignment(VMWriter* vmWriter, const Symbol& symbol);
 };
 
 class IfStatementRule : public SequenceRule
@@ -45,7 +49,9 @@ public:
     ~IfStatementRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
+private:
+    void compileOptimized(VMWriter* vmWriter, const std::string& labelSuffix);
 };
 
 class WhileStatementRule : public SequenceRule
@@ -55,7 +61,9 @@ public:
     ~WhileStatementRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
+private:
+    void compileRotated(VMWriter* vmWriter, const std::string& labelSuffix);
 };
 
 class DoStatementRule : public SequenceRule
@@ -65,7 +73,7 @@ public:
     ~DoStatementRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
 
 class ReturnStatementRule : public SequenceRule
@@ -75,5 +83,5 @@ public:
     ~ReturnStatementRule() override = default;
 
     void compile(VMWriter* vmWriter) override;
-    void writeXmlSyntax(std::ofstream* stream, int tabs) override;
+    void writeXmlSyntax(XmlWriter* stream, int tabs) override;
 };
@@ -1,15 +1,17 @@
 #pragma once
 
-#include <string>
 #include "ESegment.h"
 #include "ESymbolKind.h"
 
+/// <summary>
+/// Symbol describes a single variable. Name and type are ids from the NameTable.
+/// </summary>
 struct Symbol
 {
-    std::string name;
-    ESymbolKind kind;
-    std::string type;
-    int index;
+    int name = -1;
+    ESymbolKind kind = ESymbolKind::UNDEFINED;
+    int type = -1;
+    int index = -1;
 
     ESegment getSegment() const
     {
@@ -1,25 +1,51 @@
 #include "JackCompilerError.h"
 #include "SymbolTable.h"
 
+const Symbol undefinedSymbol{};
+
 /// <summary>
-/// Defines (adds to the table) a new variable of the given name, type, and kind.
-/// Assings to it the index value of that kind, and adds 1 to the index.
+/// Creates an empty scope with its own NameTable.
 /// </summary>
-void SymbolTable::define(std::string name, std::string type, ESymbolKind kind)
+SymbolTable::SymbolTable()
+    : mNames(std::make_shared<NameTable>())
 {
-    auto& vector = getVector(kind);
-    vector.emplace_back(name, type);
+}
+
+/// <summary>
+/// Chains this scope to the enclosing one. Symbols not found here are searched in the parent scope.
+/// <para/> Must be called before the first define.
+/// </summary>
+void SymbolTable::setParent(SymbolTable* parent)
+{
+    if (!mSymbols.empty())
+    {
+        throw JackCompilerError("Cannot change enclosing scope of non-empty symbol table.");
+    }
+
+    mParent = parent;
+    mNames = parent->mNames;
 }
 
 /// <summary>
 /// Defines (adds to the table) a new variable of the given name, type, and kind.
-/// Assings to it the specified index, and adds 1 to the index.
+/// Assings to it the index value of that kind, and adds 1 to the index.
 /// </summary>
-void SymbolTable::define(std::string name, std::string type, ESymbolKind kind, int index)
+void SymbolTable::define(std::string_view name, std::string_view type, ESymbolKind kind)
 {
-    auto& vector = getVector(kind);
-    auto position = vector.begin() + index;
-    vector.emplace(position, name, type);
+    if (kind == ESymbolKind::UNDEFINED)
+    {
+        throw JackCompilerError("Cannot define UNDEFINED symbol.");
+    }
+
+    auto nameId = mNames->intern(name);
+    auto& count = mCounts[static_cast<int>(kind)];
+
+    auto [it, inserted] = mSymbols.try_emplace(nameId, Symbol{ nameId, kind, mNames->intern(type), count });
+    if (!inserted)
+    {
+        throw JackCompilerError("Symbol " + std::string(name) + " is already defined.");
+    }
+    count++;
 }
 
 /// <summary>
@@ -27,107 +53,50 @@ void SymbolTable::define(std::string name, std::string type, ESymbolKind kind, i
 /// </summary>
 int SymbolTable::varCount(ESymbolKind kind) const
 {
-    switch (kind)
+    if (kind == ESymbolKind::UNDEFINED)
     {
-    case ESymbolKind::STATIC:
-        return (int)staticSymbols.size();
-    case ESymbolKind::FIELD:
-        return (int)fieldSymbols.size();
-    case ESymbolKind::ARG:
-        return (int)argSymbols.size();
-    case ESymbolKind::VAR:
-        return (int)varSymbols.size();
-    default:
         return -1;
     }
+    return mCounts[static_cast<int>(kind)];
 }
 
 /// <summary>
-/// Retrieves information about a symbol with the given name from the symbol table.
+/// Retrieves information about a symbol with the given name from this scope or enclosing scopes.
 /// If the symbol is not found, returns a Symbol with default values.
 /// </summary>
 /// <param name="name">The name of the symbol to retrieve.</param>
 /// <returns>A Symbol struct containing information about the symbol.</returns>
-Symbol SymbolTable::getSymbol(const std::string& name)
+const Symbol& SymbolTable::getSymbol(std::string_view name) const
 {
-    int index = -1;
-
-    index = findSymbol(varSymbols, name);
-    if (index != -1)
-    {
-        return Symbol
-        {
-            name,
-            ESymbolKind::VAR,
-            varSymbols[index].second,
-            index
-        };
-    }
-
-    index = findSymbol(argSymbols, name);
-    if (index != -1)
+    auto nameId = mNames->find(name);
+    if (nameId == -1)
     {
-        return Symbol
-        {
-            name,
-            ESymbolKind::ARG,
-            argSymbols[index].second,
-            index
-        };
-    }
-
-    index = findSymbol(fieldSymbols, name);
-    if (index != -1)
-    {
-        return Symbol
-        {
-            name,
-            ESymbolKind::FIELD,
-            fieldSymbols[index].second,
-            index
-        };
+        return undefinedSymbol;
     }
 
-    index = findSymbol(staticSymbols, name);
-    if (index != -1)
+    for (auto table = this; table != nullptr; table = table->mParent)
     {
-        return Symbol
+        if (auto symbol = table->findSymbol(nameId))
         {
-            name,
-            ESymbolKind::STATIC,
-            staticSymbols[index].second,
-            index
-        };
+            return *symbol;
+        }
     }
-
-    return Symbol{};
+    return undefinedSymbol;
 }
 
-std::vector<std::pair<std::string, std::string>>& SymbolTable::getVector(ESymbolKind symbolKind)
+/// <summary>
+/// Returns the name or type name with the given id.
+/// </summary>
+const std::string& SymbolTable::getName(int id) const
 {
-    switch (symbolKind)
-    {
-    case ESymbolKind::STATIC:
-        return staticSymbols;
-    case ESymbolKind::FIELD:
-        return fieldSymbols;
-    case ESymbolKind::ARG:
-        return argSymbols;
-    case ESymbolKind::VAR:
-        return varSymbols;
-    default:
-        throw JackCompilerError("Cannot define UNDEFINED symbol.");
-    }
+    return mNames->getName(id);
 }
 
-int SymbolTable::findSymbol(const std::vector<std::pair<std::string, std::string>>& symbols, std::string_view key) const
+const Symbol* SymbolTable::findSymbol(int name) const
 {
-    for (auto i = 0; i < symbols.size(); i++)
+    if (auto it = mSymbols.find(name); it != mSymbols.end())
     {
-        if (symbols[i].first == key)
-        {
-            return i;
-        }
+        return &it->second;
     }
-    return -1;
+    return nullptr;
 }
@@ -1,43 +1,56 @@
 #pragma once
+#include <array>
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
+#include <unordered_map>
 #include "ESymbolKind.h"
+#include "NameTable.h"
 #include "Symbol.h"
 
 /// <summary>
-/// SymbolTable is responsible for building, populating and using symbols.
+/// SymbolTable is responsible for building, populating and using symbols of a single scope.
+/// <para/> Subroutine scopes are chained to the class scope and share its NameTable.
 /// </summary>
 class SymbolTable
 {
 public:
     /// <summary>
-    /// Defines (adds to the table) a new variable of the given name, type, and kind.
-    /// Assings to it the index value of that kind, and adds 1 to the index.
+    /// Creates an empty scope with its own NameTable.
+    /// </summary>
+    SymbolTable();
+
+    /// <summary>
+    /// Chains this scope to the enclosing one. Symbols not found here are searched in the parent scope.
+    /// <para/> Must be called before the first define.
     /// </summary>
-    void define(std::string name, std::string type, ESymbolKind kind);
+    void setParent(SymbolTable* parent);
     /// <summary>
     /// Defines (adds to the table) a new variable of the given name, type, and kind.
-    /// Assings to it the specified index, and adds 1 to the index.
+    /// Assings to it the index value of that kind, and adds 1 to the index.
     /// </summary>
-    void define(std::string name, std::string type, ESymbolKind kind, int index);
+    void define(std::string_view name, std::string_view type, ESymbolKind kind);
     /// <summary>
     /// Returns the number of variables of the given kind already defined in the table.
     /// </summary>
     int varCount(ESymbolKind kind) const;
     /// <summary>
-    /// Retrieves information about a symbol with the given name from the symbol table.
+    /// Retrieves information about a symbol with the given name from this scope or enclosing scopes.
     /// If the symbol is not found, returns a Symbol with default values.
     /// </summary>
     /// <param name="name">The name of the symbol to retrieve.</param>
     /// <returns>A Symbol struct containing information about the symbol.</returns>
-    Symbol getSymbol(const std::string& name);
+    const Symbol& getSymbol(std::string_view name) const;
+    /// <summary>
+    /// Returns the name or type name with the given id.
+    /// </summary>
+    const std::string& getName(int id) const;
 
 private:
-    std::vector<std::pair<std::string, std::string>>& getVector(ESymbolKind symbolKind);
-    int findSymbol(const std::vector<std::pair<std::string, std::string>>& symbols, std::string_view key) const;
+    const Symbol* findSymbol(int name) const;
 
-    std::vector<std::pair<std::string, std::string>> staticSymbols;
-    std::vector<std::pair<std::string, std::string>> fieldSymbols;
-    std::vector<std::pair<std::string, std::string>> argSymbols;
-    std::vector<std::pair<std::string, std::string>> varSymbols;
+    SymbolTable* mParent = nullptr;
+    std::shared_ptr<NameTable> mNames;
+    std::unordered_map<int, Symbol> mSymbols;
+    std::array<int, 5> mCounts = {};
 };
@@ -6,8 +6,8 @@ using namespace std;
 /// <summary>
 /// Creates VMWriter.
 /// </summary>
-VMWriter::VMWriter(shared_ptr<ofstream> outputFile)
-    : mOutputFile(outputFile)
+VMWriter::VMWriter(ostream& outputStream)
+    : mOutputFile(&outputStream)
 {
 }
 
@@ -24,6 +24,20 @@ void VMWriter::writePush(ESegment segment, int index)
 /// </summary>
 void VMWriter::writePop(ESegment segment, int index)
 {
+    if (segment == ESegment::POINTER)
+    {
+        invalidateThatBase(index == 0 ? ESegment::THIS : ESegment::UNDEFINED);
+    }
+    else if (segment == ESegment::THAT)
+    {
+        // the array may overlap static variables or the current object
+        invalidateThatBase(ESegment::STATIC);
+        invalidateThatBase(ESegment::THIS);
+    }
+    else if (mThatBase == make_pair(segment, index))
+    {
+        mThatBase.reset();
+    }
     *mOutputFile << "pop " << segmentToString(segment) << " " << index << "\n";
 }
 
@@ -40,6 +54,8 @@ void VMWriter::writeArithmetic(EArithmetic command)
 /// </summary>
 void VMWriter::writeLabel(const std::string& label)
 {
+    // the label may be reached from a place with different THAT
+    mThatBase.reset();
     *mOutputFile << "label " << label << "\n";
 }
 
@@ -48,6 +64,7 @@ void VMWriter::writeLabel(const std::string& label)
 /// </summary>
 void VMWriter::writeGoto(const std::string& label)
 {
+    mThatBase.reset();
     *mOutputFile << "goto " << label << "\n";
 }
 
@@ -64,6 +81,9 @@ void VMWriter::writeIf(const std::string& label)
 /// </summary>
 void VMWriter::writeCall(const std::string& name, int nArgs)
 {
+    // the called function restores pointer 1, but it may change static variables and fields
+    invalidateThatBase(ESegment::STATIC);
+    invalidateThatBase(ESegment::THIS);
     *mOutputFile << "call " << name << " " << nArgs << "\n";
 }
 
@@ -72,6 +92,7 @@ void VMWriter::writeCall(const std::string& name, int nArgs)
 /// </summary>
 void VMWriter::writeFunction(const std::string& name, int nArgs)
 {
+    mThatBase.reset();
     *mOutputFile << "function " << name << " " << nArgs << "\n";
 }
 
@@ -80,9 +101,35 @@ void VMWriter::writeFunction(const std::string& name, int nArgs)
 /// </summary>
 void VMWriter::writeReturn()
 {
+    mThatBase.reset();
     *mOutputFile << "return\n";
 }
 
+/// <summary>
+/// Points THAT to the array stored in the variable, nothing is written if it already points there.
+/// </summary>
+void VMWriter::writeThatBase(ESegment segment, int index)
+{
+    auto base = make_pair(segment, index);
+    if (mThatBase == base)
+    {
+        return;
+    }
+
+    writePush(segment, index);
+    writePop(ESegment::POINTER, 1);
+    mThatBase = base;
+}
+
+// forgets THAT base stored in the segment, UNDEFINED forgets any base
+void VMWriter::invalidateThatBase(ESegment segment)
+{
+    if (mThatBase && (segment == ESegment::UNDEFINED || mThatBase->first == segment))
+    {
+        mThatBase.reset();
+    }
+}
+
 string VMWriter::segmentToString(ESegment segment) const
 {
     switch (segment)
@@ -1,11 +1,15 @@
 #pragma once
-#include <fstream>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <utility>
 #include "EArithmetic.h"
 #include "ESegment.h"
 
 /// <summary>
 /// VMWriter is responsible for writing VM commands into the output file.
+/// <para/> It also remembers the variable pointed by THAT within straight-line code, so repeated
+///     accesses to the same array with constant indexes do not reload pointer 1.
 /// </summary>
 class VMWriter
 {
@@ -13,7 +17,7 @@ public:
     /// <summary>
     /// Creates VMWriter.
     /// </summary>
-    explicit VMWriter(std::shared_ptr<std::ofstream> outputFile);
+    explicit VMWriter(std::ostream& outputStream);
 
     /// <summary>
     /// Writes a VM push command.
@@ -51,10 +55,18 @@ public:
     /// Writes a VM return command.
     /// </summary>
     void writeReturn();
+    /// <summary>
+    /// Points THAT to the array stored in the variable, nothing is written if it already points there.
+    /// </summary>
+    void writeThatBase(ESegment segment, int index);
 
 private:
+    void invalidateThatBase(ESegment segment);
+
     std::string segmentToString(ESegment segment) const;
     std::string arithmeticToString(EArithmetic segment) const;
     
-    std::shared_ptr<std::ofstream> mOutputFile;
+    std::ostream* mOutputFile;
+    // variable, whose value is in pointer 1
+    std::optional<std::pair<ESegment, int>> mThatBase;
 };
@@ -0,0 +1,89 @@
+#include "JackCompilerError.h"
+#include "XmlWriter.h"
+
+using namespace std;
+
+/// <summary>
+/// Opens the output file and reserves the buffer.
+/// </summary>
+/// <param name="filename">Name of the output file</param>
+/// <param name="capacity">Initial size of the buffer in bytes</param>
+XmlWriter::XmlWriter(const string& filename, size_t capacity)
+    : mOutputFile(filename, ios::binary)
+{
+    if (!mOutputFile.is_open())
+    {
+        throw JackCompilerError("Cannot create or open " + filename + " file.");
+    }
+    mBuffer.reserve(capacity);
+}
+
+/// <summary>
+/// Appends text to the buffer.
+/// </summary>
+void XmlWriter::write(string_view text)
+{
+    mBuffer.append(text);
+}
+
+/// <summary>
+/// Appends indented line to the buffer.
+/// </summary>
+/// <param name="indent">Count of leading spaces</param>
+/// <param name="text">Line content without new line character</param>
+void XmlWriter::writeLine(int indent, string_view text)
+{
+    mBuffer.append(indent > 0 ? indent : 0, ' ');
+    mBuffer.append(text);
+    mBuffer.push_back('\n');
+}
+
+/// <summary>
+/// Appends indented &lt;tag&gt;value&lt;/tag&gt; line, where the value is XML encoded.
+/// </summary>
+void XmlWriter::writeElement(int indent, string_view tag, string_view value)
+{
+    mBuffer.append(indent > 0 ? indent : 0, ' ');
+    mBuffer.push_back('<');
+    mBuffer.append(tag);
+    mBuffer.push_back('>');
+    writeEncoded(value);
+    mBuffer.append("</");
+    mBuffer.append(tag);
+    mBuffer.append(">\n");
+}
+
+/// <summary>
+/// Writes the buffer into the output file and closes it.
+/// </summary>
+void XmlWriter::close()
+{
+    mOutputFile.write(mBuffer.data(), static_cast<streamsize>(mBuffer.size()));
+    mOutputFile.close();
+    mBuffer.clear();
+}
+
+void XmlWriter::writeEncoded(string_view text)
+{
+    for (char symbol : text)
+    {
+        switch (symbol)
+        {
+        case '<':
+            mBuffer.append("&lt;");
+            continue;
+        case '>':
+            mBuffer.append("&gt;");
+            continue;
+        case '"':
+            mBuffer.append("&quot;");
+            continue;
+        case '&':
+            mBuffer.append("&amp;");
+            continue;
+        default:
+            mBuffer.push_back(symbol);
+            continue;
+        }
+    }
+}
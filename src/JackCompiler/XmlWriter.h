@@ -0,0 +1,44 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// XmlWriter collects XML output of the syntax analyzer in a single preallocated buffer
+///     and writes it into the output file at once.
+/// </summary>
+class XmlWriter
+{
+public:
+    /// <summary>
+    /// Opens the output file and reserves the buffer.
+    /// </summary>
+    /// <param name="filename">Name of the output file</param>
+    /// <param name="capacity">Initial size of the buffer in bytes</param>
+    XmlWriter(const std::string& filename, std::size_t capacity);
+
+    /// <summary>
+    /// Appends text to the buffer.
+    /// </summary>
+    void write(std::string_view text);
+    /// <summary>
+    /// Appends indented line to the buffer.
+    /// </summary>
+    /// <param name="indent">Count of leading spaces</param>
+    /// <param name="text">Line content without new line character</param>
+    void writeLine(int indent, std::string_view text);
+    /// <summary>
+    /// Appends indented &lt;tag&gt;value&lt;/tag&gt; line, where the value is XML encoded.
+    /// </summary>
+    void writeElement(int indent, std::string_view tag, std::string_view value);
+    /// <summary>
+    /// Writes the buffer into the output file and closes it.
+    /// </summary>
+    void close();
+
+private:
+    void writeEncoded(std::string_view text);
+
+    std::ofstream mOutputFile;
+    std::string mBuffer;
+};
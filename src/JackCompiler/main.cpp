@@ -1,33 +1,61 @@
 #include <chrono>
 #include <filesystem>
 #include <iostream>
+#include "CompilationOptions.h"
 #include "JackCompiler.h"
 #include "JackCompilerError.h"
 
 int main(int argc, char* argv[])
 {
-    if (argc > 2)
+    std::string path;
+    CompilationOptions options;
+
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "Usage:\n"
-            << "\tJackCompiler InputDirectory\n"
-            << "\tJackCompiler InputFile.jack\n";
-        return EXIT_FAILURE;
+        std::string arg = argv[i];
+        if (arg == "--xml")
+        {
+            options.writeXmlSyntax = true;
+        }
+        else if (arg == "--tokens")
+        {
+            options.writeXmlTokens = true;
+        }
+        else if (arg == "--vm-only")
+        {
+            options.writeXmlSyntax = false;
+            options.writeXmlTokens = false;
+        }
+        else if (arg == "--no-optimize")
+        {
+            options.optimize = false;
+        }
+        else if (arg == "--pool-strings")
+        {
+            options.poolStrings = true;
+        }
+        else if (path.empty() && arg.rfind("--", 0) != 0)
+        {
+            path = arg;
+        }
+        else
+        {
+            std::cout << "Usage:\n"
+                << "\tJackCompiler InputDirectory [--xml] [--tokens] [--vm-only] [--no-optimize] [--pool-strings]\n"
+                << "\tJackCompiler InputFile.jack [--xml] [--tokens] [--vm-only] [--no-optimize] [--pool-strings]\n";
+            return EXIT_FAILURE;
+        }
     }
 
-    std::string path;
-    if (argc == 1)
+    if (path.empty())
     {
         std::cout << "No file or directory specified. Searching for files in current directory.\n";
         path = std::filesystem::current_path().string();
     }
-    else
-    {
-        path = argv[1];
-    }
 
     try
     {
-        auto jackAnalyzer = JackCompiler(path);
+        auto jackAnalyzer = JackCompiler(path, options);
 
         auto startTime = std::chrono::high_resolution_clock::now();
 
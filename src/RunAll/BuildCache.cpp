@@ -0,0 +1,106 @@
+#include <fstream>
+#include <sstream>
+#include "BuildCache.h"
+#include "RunAllError.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Creates the cache directory if it does not exist.
+/// </summary>
+/// <param name="directory">Cache directory</param>
+/// <param name="salt">Identifies the tools, entries created by different tools are never reused</param>
+BuildCache::BuildCache(const fs::path& directory, string_view salt)
+    : mDirectory(directory),
+    mSaltHash(hash(salt))
+{
+    error_code error;
+    fs::create_directories(mDirectory, error);
+    if (error)
+    {
+        throw RunAllError("Cannot create " + mDirectory.string() + " directory.");
+    }
+}
+
+/// <summary>
+/// Returns key of the entry for the stage, input name and input content.
+/// </summary>
+string BuildCache::makeKey(string_view stage, string_view name, string_view content) const
+{
+    // separators keep ("ab", "c") and ("a", "bc") apart
+    auto value = hash(stage, mSaltHash);
+    value = hash(string_view("\0", 1), value);
+    value = hash(name, value);
+    value = hash(string_view("\0", 1), value);
+    value = hash(content, value);
+
+    ostringstream key;
+    key << name << "." << hex << value << "." << stage;
+    return key.str();
+}
+
+/// <summary>
+/// Returns content of the entry or std::nullopt if it is not cached.
+/// </summary>
+optional<string> BuildCache::find(const string& key)
+{
+    ifstream file(mDirectory / key, ios::binary);
+    if (!file.is_open())
+    {
+        return nullopt;
+    }
+
+    ostringstream content;
+    content << file.rdbuf();
+    mUsedKeys.insert(key);
+    return content.str();
+}
+
+/// <summary>
+/// Stores content of the entry.
+/// </summary>
+void BuildCache::store(const string& key, string_view content)
+{
+    // written under temporary name, so an interrupted build never leaves a truncated entry
+    auto temporaryPath = mDirectory / (key + ".tmp");
+    {
+        ofstream file(temporaryPath, ios::binary);
+        if (!file.is_open())
+        {
+            throw RunAllError("Cannot create or open " + temporaryPath.string() + " file.");
+        }
+        file.write(content.data(), static_cast<streamsize>(content.size()));
+    }
+    fs::rename(temporaryPath, mDirectory / key);
+    mUsedKeys.insert(key);
+}
+
+/// <summary>
+/// Removes entries, which were neither found nor stored since the cache was created.
+/// </summary>
+void BuildCache::prune() const
+{
+    for (const auto& entry : fs::directory_iterator(mDirectory))
+    {
+        if (entry.is_regular_file() && !mUsedKeys.count(entry.path().filename().string()))
+        {
+            error_code error;
+            fs::remove(entry.path(), error);
+        }
+    }
+}
+
+/// <summary>
+/// 64-bit FNV-1a hash.
+/// </summary>
+uint64_t BuildCache::hash(string_view data, uint64_t seed)
+{
+    uint64_t value = seed;
+    for (unsigned char byte : data)
+    {
+        value ^= byte;
+        value *= 1099511628211ull;
+    }
+    return value;
+}
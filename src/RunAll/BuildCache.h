@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+
+/// <summary>
+/// BuildCache stores outputs of the build stages in the directory, keyed by a hash of their inputs.
+/// <para/> Entries not used by the last build are removed by prune, so the cache does not grow with every edit.
+/// </summary>
+class BuildCache
+{
+public:
+    /// <summary>
+    /// Creates the cache directory if it does not exist.
+    /// </summary>
+    /// <param name="directory">Cache directory</param>
+    /// <param name="salt">Identifies the tools, entries created by different tools are never reused</param>
+    BuildCache(const std::filesystem::path& directory, std::string_view salt);
+
+    /// <summary>
+    /// Returns key of the entry for the stage, input name and input content.
+    /// </summary>
+    std::string makeKey(std::string_view stage, std::string_view name, std::string_view content) const;
+    /// <summary>
+    /// Returns content of the entry or std::nullopt if it is not cached.
+    /// </summary>
+    std::optional<std::string> find(const std::string& key);
+    /// <summary>
+    /// Stores content of the entry.
+    /// </summary>
+    void store(const std::string& key, std::string_view content);
+    /// <summary>
+    /// Removes entries, which were neither found nor stored since the cache was created.
+    /// </summary>
+    void prune() const;
+
+    /// <summary>
+    /// 64-bit FNV-1a hash.
+    /// </summary>
+    static uint64_t hash(std::string_view data, uint64_t seed = 14695981039346656037ull);
+
+private:
+    std::filesystem::path mDirectory;
+    uint64_t mSaltHash;
+    std::set<std::string> mUsedKeys;
+};
@@ -0,0 +1,354 @@
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "BuildPipeline.h"
+#include "RunAllError.h"
+#include "../Assembler/HackAssembler.h"
+#include "../JackCompiler/CompilationEngine.h"
+#include "../VMTranslator/VMTranslator.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+string readFile(const fs::path& path)
+{
+    ifstream file(path, ios::binary);
+    if (!file.is_open())
+    {
+        throw RunAllError("Cannot open " + path.string() + " file.");
+    }
+
+    ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// first line: "<comparison used> <comparison count> <defined label count> <used label count>", then labels and code
+string serializeFragment(const AssemblyFragment& fragment)
+{
+    ostringstream stream;
+    stream << fragment.isComparisonUsed << " " << fragment.comparisonCount << " "
+        << fragment.definedLabels.size() << " " << fragment.usedLabels.size() << "\n";
+    for (const auto& label : fragment.definedLabels)
+    {
+        stream << label << "\n";
+    }
+    for (const auto& label : fragment.usedLabels)
+    {
+        stream << label << "\n";
+    }
+    stream << fragment.code;
+    return stream.str();
+}
+
+AssemblyFragment deserializeFragment(const string& data)
+{
+    istringstream stream(data);
+    AssemblyFragment fragment;
+    size_t definedCount = 0;
+    size_t usedCount = 0;
+    if (!(stream >> fragment.isComparisonUsed >> fragment.comparisonCount >> definedCount >> usedCount))
+    {
+        throw RunAllError("Corrupted build cache entry.");
+    }
+    stream.ignore();
+
+    string label;
+    for (size_t i = 0; i < definedCount && getline(stream, label); i++)
+    {
+        fragment.definedLabels.insert(label);
+    }
+    for (size_t i = 0; i < usedCount && getline(stream, label); i++)
+    {
+        fragment.usedLabels.insert(label);
+    }
+
+    auto codeStart = stream.tellg();
+    if (codeStart < 0)
+    {
+        throw RunAllError("Corrupted build cache entry.");
+    }
+    fragment.code = data.substr(static_cast<size_t>(codeStart));
+    return fragment;
+}
+
+/// <summary>
+/// Creates BuildPipeline.
+/// </summary>
+/// <param name="outputPath">Existing output directory</param>
+/// <param name="programName">Name of the created .hack file</param>
+/// <param name="writeIntermediates">Whether .xml, .vm and .asm files should be created</param>
+BuildPipeline::BuildPipeline(const fs::path& outputPath, const string& programName, bool writeIntermediates)
+    : mOutputPath(outputPath),
+    mProgramName(programName),
+    mWriteIntermediates(writeIntermediates)
+{
+}
+
+/// <summary>
+/// Adds a single .jack file or all .jack files from the directory.
+/// <para/> A class added later replaces already added class with the same name.
+/// </summary>
+void BuildPipeline::addSourceFiles(const fs::path& inputPath)
+{
+    if (!fs::exists(inputPath))
+    {
+        throw RunAllError("Input path or directory " + inputPath.string() + " does not exist.");
+    }
+
+    if (fs::is_regular_file(inputPath))
+    {
+        if (inputPath.extension() != ".jack")
+        {
+            throw RunAllError("File " + inputPath.string() + " extension is not '.jack'.");
+        }
+        mSourceFiles.insert_or_assign(inputPath.stem().string(), inputPath);
+        return;
+    }
+
+    bool isEmpty = true;
+    for (const auto& entry : fs::directory_iterator(inputPath))
+    {
+        const auto& path = entry.path();
+        if (entry.is_regular_file() && isupper(path.filename().string()[0]) && path.extension() == ".jack")
+        {
+            mSourceFiles.insert_or_assign(path.stem().string(), path);
+            isEmpty = false;
+        }
+    }
+
+    if (isEmpty)
+    {
+        throw RunAllError("Directory " + inputPath.string() + " doesn't contain any file with .jack extension.");
+    }
+}
+
+/// <summary>
+/// Enables the build cache in the .cache subdirectory of the output directory.
+/// </summary>
+/// <param name="toolsVersion">Identifies the build of the tools, other builds do not reuse the entries</param>
+void BuildPipeline::enableCache(string_view toolsVersion)
+{
+    mCache = make_unique<BuildCache>(mOutputPath / ".cache", toolsVersion);
+}
+
+/// <summary>
+/// Sets code generation options of the JackCompiler. XML outputs are selected by writeIntermediates.
+/// </summary>
+void BuildPipeline::setCompilationOptions(const CompilationOptions& options)
+{
+    mCompilationOptions = options;
+}
+
+/// <summary>
+/// Sets optimizations of the VMTranslator. Inlining translates the whole program in the link stage,
+///     so the assembly code of classes is not cached.
+/// </summary>
+void BuildPipeline::setTranslationOptions(const TranslationOptions& options)
+{
+    mTranslationOptions = options;
+}
+
+/// <summary>
+/// Compiles added classes and writes the .hack file.
+/// May throw JackCompilerError, VMTranslatorError, HackAssemblerError or RunAllError.
+/// </summary>
+void BuildPipeline::run()
+{
+    mTimings.clear();
+    auto runStage = [this](const char* name, const function<void(StageTiming&)>& stage)
+    {
+        StageTiming timing;
+        timing.name = name;
+        auto startTime = chrono::high_resolution_clock::now();
+        stage(timing);
+        auto endTime = chrono::high_resolution_clock::now();
+        timing.milliseconds = chrono::duration<double, milli>(endTime - startTime).count();
+        mTimings.push_back(timing);
+    };
+
+    std::cout << "\nCompiling " << mSourceFiles.size() << " classes using JackCompiler...\n";
+    runStage("JackCompiler", [this](StageTiming& timing) { compileClasses(timing); });
+
+    std::cout << "\nTranslating VM code to assembly code...\n";
+    runStage("VMTranslator", [this](StageTiming& timing) { translateVMCode(timing); });
+    runStage("Link", [this](StageTiming&) { link(); });
+
+    std::cout << "\nTranslating assembly code to machine code...\n";
+    runStage("HackAssembler", [this](StageTiming&) { assemble(); });
+
+    if (mCache)
+    {
+        mCache->prune();
+    }
+    printTimings();
+}
+
+void BuildPipeline::compileClasses(StageTiming& timing)
+{
+    auto options = mCompilationOptions;
+    options.writeXmlSyntax = mWriteIntermediates;
+    options.writeXmlTokens = mWriteIntermediates;
+    options.xmlDirectory = (mOutputPath / "xml_files").string();
+
+    // code generation options change the VM code, so they are a part of the key
+    string stage = "vm";
+    stage += options.optimize ? "" : "-reference";
+    stage += options.poolStrings ? "-pooled" : "";
+
+    timing.reusedCount = mCache ? 0 : -1;
+    timing.totalCount = static_cast<int>(mSourceFiles.size());
+
+    mVMCode.clear();
+    for (const auto& [className, path] : mSourceFiles)
+    {
+        string key;
+        optional<string> cachedCode;
+        if (mCache)
+        {
+            key = mCache->makeKey(stage, className, readFile(path));
+            // XML files are created only by the compilation
+            cachedCode = mWriteIntermediates ? nullopt : mCache->find(key);
+        }
+
+        auto& vmCode = mVMCode[className];
+        if (cachedCode)
+        {
+            vmCode = std::move(*cachedCode);
+            timing.reusedCount++;
+        }
+        else
+        {
+            ostringstream vmStream;
+            CompilationEngine(path.string(), options).compileFile(vmStream);
+            vmCode = vmStream.str();
+            if (mCache)
+            {
+                mCache->store(key, vmCode);
+            }
+        }
+
+        if (mWriteIntermediates)
+        {
+            writeFile(mOutputPath / "vm_files" / (className + ".vm"), vmCode);
+        }
+    }
+}
+
+void BuildPipeline::translateVMCode(StageTiming& timing)
+{
+    // comments are useful only in the written .asm file, they slow down the assembler
+    string stage = mWriteIntermediates ? "asm-commented" : "asm";
+    stage += mTranslationOptions.tailCalls ? "-tail" : "";
+    stage += mTranslationOptions.cacheTopOfStack ? "-tos" : "";
+    stage += mTranslationOptions.comparisons == EComparisonMode::INLINE ? "-inline-comparisons" : "";
+    stage += mTranslationOptions.comparisons == EComparisonMode::SHARED ? "-shared-comparisons" : "";
+
+    timing.reusedCount = mCache ? 0 : -1;
+    timing.totalCount = static_cast<int>(mVMCode.size());
+
+    mAssemblyFragments.clear();
+    if (mTranslationOptions.inlineFunctions)
+    {
+        // inlined functions come from other classes, the whole program is translated by the link stage
+        timing.reusedCount = -1;
+        return;
+    }
+    for (const auto& [className, vmCode] : mVMCode)
+    {
+        string key;
+        if (mCache)
+        {
+            key = mCache->makeKey(stage, className, vmCode);
+            if (auto cachedFragment = mCache->find(key))
+            {
+                mAssemblyFragments[className] = deserializeFragment(*cachedFragment);
+                timing.reusedCount++;
+                continue;
+            }
+        }
+
+        istringstream vmStream(vmCode);
+        auto& fragment = mAssemblyFragments[className] = VMTranslator::translateFragment(vmStream, className, mWriteIntermediates, mTranslationOptions);
+        if (mCache)
+        {
+            mCache->store(key, serializeFragment(fragment));
+        }
+    }
+}
+
+void BuildPipeline::link()
+{
+    ostringstream assemblyStream;
+    auto vmTranslator = VMTranslator(assemblyStream, mWriteIntermediates, mTranslationOptions);
+
+    if (mTranslationOptions.inlineFunctions)
+    {
+        for (const auto& [className, vmCode] : mVMCode)
+        {
+            istringstream vmStream(vmCode);
+            vmTranslator.parseStream(vmStream, className);
+        }
+    }
+    for (const auto& [className, fragment] : mAssemblyFragments)
+    {
+        vmTranslator.writeFragment(fragment);
+    }
+    vmTranslator.writeFinalCode();
+
+    if (auto report = vmTranslator.getOptimizationReport(); !report.empty())
+    {
+        std::cout << report << "\n";
+    }
+
+    mAssemblyCode = assemblyStream.str();
+    if (mWriteIntermediates)
+    {
+        writeFile(mOutputPath / "assembler_files" / (mProgramName + ".asm"), mAssemblyCode);
+    }
+}
+
+void BuildPipeline::assemble() const
+{
+    auto hackPath = mOutputPath / (mProgramName + ".hack");
+    ofstream hackFile(hackPath);
+    if (!hackFile.is_open())
+    {
+        throw RunAllError("Cannot create or open " + hackPath.string() + " file.");
+    }
+
+    istringstream assemblyStream(mAssemblyCode);
+    auto hackAssembler = assembler::HackAssembler(assemblyStream, hackFile);
+    hackAssembler.searchSymbols();
+    hackAssembler.assemblerToMachineCode(true);
+
+    std::cout << "Created " << hackPath << " file.\n";
+}
+
+void BuildPipeline::writeFile(const fs::path& path, const string& content) const
+{
+    ofstream file(path);
+    if (!file.is_open())
+    {
+        throw RunAllError("Cannot create or open " + path.string() + " file.");
+    }
+    file.write(content.data(), static_cast<streamsize>(content.size()));
+    std::cout << "Created " << path << " file.\n";
+}
+
+void BuildPipeline::printTimings() const
+{
+    std::cout << "\n" << left << setw(16) << "Stage" << right << setw(12) << "Time [ms]" << setw(10) << "Reused" << "\n";
+    for (const auto& timing : mTimings)
+    {
+        std::cout << left << setw(16) << timing.name << right << setw(12) << fixed << setprecision(1) << timing.milliseconds;
+        if (timing.reusedCount >= 0)
+        {
+            std::cout << setw(10) << (to_string(timing.reusedCount) + "/" + to_string(timing.totalCount));
+        }
+        std::cout << "\n";
+    }
+}
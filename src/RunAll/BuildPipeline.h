@@ -0,0 +1,87 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BuildCache.h"
+#include "../JackCompiler/CompilationOptions.h"
+#include "../VMTranslator/TranslationOptions.h"
+#include "../VMTranslator/AssemblyFragment.h"
+
+/// <summary>
+/// BuildPipeline compiles .jack files into a single .hack file within one process.
+/// <para/> JackCompiler, VMTranslator and HackAssembler are linked as libraries, VM code and assembly code
+///     are passed between them in memory and written to the disk only on request.
+/// <para/> With the cache enabled, VM code and assembly code of unchanged classes are reused,
+///     so usually only the link and assemble stages run.
+/// </summary>
+class BuildPipeline
+{
+public:
+    /// <summary>
+    /// Creates BuildPipeline.
+    /// </summary>
+    /// <param name="outputPath">Existing output directory</param>
+    /// <param name="programName">Name of the created .hack file</param>
+    /// <param name="writeIntermediates">Whether .xml, .vm and .asm files should be created</param>
+    BuildPipeline(const std::filesystem::path& outputPath, const std::string& programName, bool writeIntermediates);
+
+    /// <summary>
+    /// Adds a single .jack file or all .jack files from the directory.
+    /// <para/> A class added later replaces already added class with the same name.
+    /// </summary>
+    void addSourceFiles(const std::filesystem::path& inputPath);
+    /// <summary>
+    /// Enables the build cache in the .cache subdirectory of the output directory.
+    /// </summary>
+    /// <param name="toolsVersion">Identifies the build of the tools, other builds do not reuse the entries</param>
+    void enableCache(std::string_view toolsVersion);
+    /// <summary>
+    /// Sets code generation options of the JackCompiler. XML outputs are selected by writeIntermediates.
+    /// </summary>
+    void setCompilationOptions(const CompilationOptions& options);
+    /// <summary>
+    /// Sets optimizations of the VMTranslator. Inlining translates the whole program in the link stage,
+    ///     so the assembly code of classes is not cached.
+    /// </summary>
+    void setTranslationOptions(const TranslationOptions& options);
+    /// <summary>
+    /// Compiles added classes and writes the .hack file.
+    /// May throw JackCompilerError, VMTranslatorError, HackAssemblerError or RunAllError.
+    /// </summary>
+    void run();
+
+private:
+    struct StageTiming
+    {
+        std::string name;
+        double milliseconds = 0;
+        int reusedCount = -1;
+        int totalCount = 0;
+    };
+
+    void compileClasses(StageTiming& timing);
+    void translateVMCode(StageTiming& timing);
+    void link();
+    void assemble() const;
+
+    void writeFile(const std::filesystem::path& path, const std::string& content) const;
+    void printTimings() const;
+
+    std::filesystem::path mOutputPath;
+    std::string mProgramName;
+    bool mWriteIntermediates;
+    CompilationOptions mCompilationOptions;
+    TranslationOptions mTranslationOptions;
+
+    // class name -> .jack file / VM code
+    std::map<std::string, std::filesystem::path> mSourceFiles;
+    std::map<std::string, std::string> mVMCode;
+    std::map<std::string, AssemblyFragment> mAssemblyFragments;
+    std::string mAssemblyCode;
+
+    std::unique_ptr<BuildCache> mCache;
+    std::vector<StageTiming> mTimings;
+};
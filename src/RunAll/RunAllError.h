@@ -0,0 +1,8 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+class RunAllError : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
@@ -1,29 +1,73 @@
+#include <chrono>
 #include <filesystem>
-#include <functional>
 #include <iostream>
+#include "BuildPipeline.h"
+#include "RunAllError.h"
+#include "../Assembler/HackAssemblerError.h"
+#include "../JackCompiler/JackCompilerError.h"
+#include "../VMTranslator/VMTranslatorError.h"
 
 namespace fs = std::filesystem;
 
-enum class FileOperation
-{
-    COPY,
-    MOVE
-};
-
 fs::path getExecutablePath(char* arg);
+std::string getToolsVersion(char* arg);
 fs::path getOSPath(const fs::path& path);
 bool isDirectoryPath(char* path);
 void ensureDirectoryExist(const fs::path& path);
-void moveFiles(const fs::path& inputPath, const fs::path& outputPath, const char* extension, FileOperation fileOperation);
-void executeConsoleApplication(const fs::path& path, const fs::path& arg, const char* arg2 = "");
 
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    bool writeIntermediates = false;
+    bool useCache = true;
+    CompilationOptions compilationOptions;
+    TranslationOptions translationOptions;
+    bool validArguments = argc >= 3;
+    for (int i = 3; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--write-intermediates")
+        {
+            writeIntermediates = true;
+        }
+        else if (arg == "--no-cache")
+        {
+            useCache = false;
+        }
+        else if (arg == "--pool-strings")
+        {
+            compilationOptions.poolStrings = true;
+        }
+        else if (arg == "--inline")
+        {
+            translationOptions.inlineFunctions = true;
+        }
+        else if (arg == "--tail-calls")
+        {
+            translationOptions.tailCalls = true;
+        }
+        else if (arg == "--cache-tos")
+        {
+            translationOptions.cacheTopOfStack = true;
+        }
+        else if (arg == "--comparisons=inline")
+        {
+            translationOptions.comparisons = EComparisonMode::INLINE;
+        }
+        else if (arg == "--comparisons=shared")
+        {
+            translationOptions.comparisons = EComparisonMode::SHARED;
+        }
+        else
+        {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments)
     {
         std::cout << "Usage: \n"
-            << "\tRunAll InputDirectory OutputDirectory\n"
-            << "\tRunAll InputFile.jack OutputDirectory\n";
+            << "\tRunAll InputDirectory OutputDirectory [--write-intermediates] [--no-cache] [--pool-strings] [--inline] [--tail-calls] [--cache-tos] [--comparisons=inline|shared]\n"
+            << "\tRunAll InputFile.jack OutputDirectory [--write-intermediates] [--no-cache] [--pool-strings] [--inline] [--tail-calls] [--cache-tos] [--comparisons=inline|shared]\n";
         return EXIT_FAILURE;
     }
 
@@ -40,33 +84,54 @@ int main(int argc, char* argv[])
     auto osPath = getOSPath(exePath);
 
     ensureDirectoryExist(outputPath);
-    ensureDirectoryExist(outputPath / "jack_files");
-    ensureDirectoryExist(outputPath / "xml_files");
-    ensureDirectoryExist(outputPath / "vm_files");
-    ensureDirectoryExist(outputPath / "assembler_files");
-
-    std::cout << "\nCopying source files to output directory...\n";
-    moveFiles(osPath, outputPath / "jack_files", ".jack", FileOperation::COPY);
+    if (writeIntermediates)
+    {
+        ensureDirectoryExist(outputPath / "xml_files");
+        ensureDirectoryExist(outputPath / "vm_files");
+        ensureDirectoryExist(outputPath / "assembler_files");
+    }
 
-    std::cout << std::endl;
-    moveFiles(inputPath, outputPath / "jack_files", ".jack", FileOperation::COPY);
+    auto normalPath = fs::absolute(inputPath).lexically_normal();
+    auto programName = (normalPath.has_filename() ? normalPath : normalPath.parent_path()).stem();
 
-    std::cout << "\nCompiling source files using JackCompiler...\n";
-    executeConsoleApplication(exePath / "JackCompiler.exe", outputPath / "jack_files");
+    try
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
 
-    std::cout << "\nMoving created files to suitable directories...\n";
-    moveFiles(outputPath / "jack_files", outputPath / "xml_files", ".xml", FileOperation::MOVE);
-    
-    std::cout << std::endl;
-    moveFiles(outputPath / "jack_files", outputPath / "vm_files", ".vm", FileOperation::MOVE);
+        // classes from the input replace the OS classes with the same name
+        auto buildPipeline = BuildPipeline(outputPath, programName.string(), writeIntermediates);
+        buildPipeline.setCompilationOptions(compilationOptions);
+        buildPipeline.setTranslationOptions(translationOptions);
+        if (useCache)
+        {
+            buildPipeline.enableCache(getToolsVersion(argv[0]));
+        }
+        buildPipeline.addSourceFiles(osPath);
+        buildPipeline.addSourceFiles(inputPath);
+        buildPipeline.run();
 
-    std::cout << "\nTranslating VM code to assembly code...\n";
-    executeConsoleApplication(exePath / "VMTranslator.exe", outputPath / "vm_files");
-    std::cout << "Moving assembly file to suitable directory...\n";
-    fs::rename(outputPath / "vm_files" / "vm_files.asm", outputPath / "assembler_files" / fs::path(inputPath.stem().string() + ".asm"));
+        auto endTime = std::chrono::high_resolution_clock::now();
 
-    std::cout << "\nTranslating assembly code to machine code...\n";
-    executeConsoleApplication(exePath / "HackAssembler.exe", outputPath / "assembler_files" / fs::path(inputPath.stem().string() + ".asm"), "--alowOverflowError");
+        std::cout << "\nFinished in " << (endTime - startTime) / std::chrono::milliseconds(1) << " ms.\n";
+        return EXIT_SUCCESS;
+    }
+    catch (const JackCompilerError& error)
+    {
+        std::cout << "JackCompiler error: " << error.what() << "\n";
+    }
+    catch (const VMTranslatorError& error)
+    {
+        std::cout << "VMTranslator error: " << error.what() << "\n";
+    }
+    catch (const assembler::HackAssemblerError& error)
+    {
+        std::cout << "HackAssembler error: " << error.what() << "\n";
+    }
+    catch (const RunAllError& error)
+    {
+        std::cout << "Error: " << error.what() << " Aborting...\n";
+    }
+    return EXIT_FAILURE;
 }
 
 fs::path getExecutablePath(char* arg)
@@ -74,6 +139,25 @@ fs::path getExecutablePath(char* arg)
     return fs::weakly_canonical(fs::path(arg)).parent_path();
 }
 
+std::string getToolsVersion(char* arg)
+{
+    // rebuilt tools have a different executable, so the cached outputs of the old build are not reused
+    std::error_code error;
+    auto exeFile = fs::weakly_canonical(fs::path(arg), error);
+    if (!fs::is_regular_file(exeFile, error))
+    {
+        exeFile += ".exe";
+    }
+
+    auto size = fs::file_size(exeFile, error);
+    if (error)
+    {
+        return __DATE__ " " __TIME__;
+    }
+    auto time = fs::last_write_time(exeFile, error);
+    return std::to_string(size) + " " + std::to_string(time.time_since_epoch().count());
+}
+
 fs::path getOSPath(const fs::path& exePath)
 {
     fs::path path(exePath);
@@ -110,63 +194,3 @@ void ensureDirectoryExist(const fs::path& path)
     }
     std::cout << "Directory " << path << " exist.\n";
 }
-
-void moveFiles(const fs::path& inputPath, const fs::path& outputPath, const char* extension, FileOperation fileOperation)
-{
-    std::function<void(const fs::path&, const fs::path&)> copyFile = [](const fs::path& input, const fs::path& output)
-        {
-            fs::copy_file(input, output, fs::copy_options::overwrite_existing);
-        };
-    std::function<void(const fs::path&, const fs::path&)> moveFile = [](const fs::path& input, const fs::path& output)
-        {
-            fs::rename(input, output);
-        };
-    auto operationString = fileOperation == FileOperation::COPY ? "Copying " : "Moving ";
-    const auto& performFileOperation = fileOperation == FileOperation::COPY ? copyFile : moveFile;
-
-    if (!fs::exists(inputPath))
-    {
-        std::cerr << "Input path or directory " << inputPath << " does not exist! Aborting...";
-        exit(EXIT_FAILURE);
-    }
-
-    if (fs::is_regular_file(inputPath))
-    {
-        if (inputPath.extension() != extension)
-        {
-            std::cout << "File " << inputPath << " extension is not '" << extension << "'! Aborting...\n";
-            exit(EXIT_FAILURE);
-        }
-
-        std::cout << operationString << inputPath << "...\n";
-        performFileOperation(inputPath, outputPath / inputPath.filename());
-        return;
-    }
-
-    if (auto iterator = fs::directory_iterator(inputPath); iterator == fs::end(iterator))
-    {
-        std::cout << "Input directory " << inputPath << " is empty. Aborting...\n";
-        exit(EXIT_FAILURE);
-    }
-
-    for (const auto& entry : fs::directory_iterator(inputPath))
-    {
-        if (fs::is_regular_file(entry) && entry.path().extension() == extension)
-        {
-            std::cout << operationString << entry << "...\n";
-            performFileOperation(entry.path(), outputPath / entry.path().filename());
-        }
-    }
-}
-
-void executeConsoleApplication(const fs::path& path, const fs::path& arg, const char* arg2)
-{
-    std::string command = path.string() + " " + arg.string() + " " + arg2;
-    auto result = system(command.c_str());
-
-    if (result != 0)
-    {
-        std::cout << "Failed to execute command! Aborting...\n";
-        exit(EXIT_FAILURE);
-    }
-}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <array>
+#include "HackInstruction.h"
+
+using namespace std;
+
+// computations with the A register first, then the same computations with memory
+const array<string, HackInstruction::COMPUTATION_COUNT> COMPUTATIONS = {
+    "0", "1", "-1", "D", "A", "!D", "!A", "-D", "-A", "D+1", "A+1", "D-1", "A-1", "D+A", "D-A", "A-D", "D&A", "D|A",
+    "M", "!M", "-M", "M+1", "M-1", "D+M", "D-M", "M-D", "D&M", "D|M"
+};
+
+/// <summary>
+/// Returns the computation with the given index as written in the assembly code, e.g. "D+M".
+/// </summary>
+const string& HackInstruction::getComputation(int comp)
+{
+    return COMPUTATIONS[comp];
+}
+
+/// <summary>
+/// Returns the index of the computation or -1, if it is not valid. Operands of D+A, D&amp;A, D|A may be swapped.
+/// </summary>
+int HackInstruction::findComputation(const string& computation)
+{
+    string normalized = computation;
+    if (computation.size() == 3 && computation[2] == 'D' && (computation[1] == '+' || computation[1] == '&' || computation[1] == '|'))
+    {
+        normalized = string("D") + computation[1] + computation[0];
+    }
+
+    for (int i = 0; i < COMPUTATION_COUNT; i++)
+    {
+        if (COMPUTATIONS[i] == normalized)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// <summary>
+/// Computes the value of the computation for the D register and the A register or memory operand.
+/// </summary>
+int16_t HackInstruction::compute(int comp, int16_t d, int16_t y)
+{
+    // the ALU wraps around, unsigned arithmetic avoids the undefined signed overflow
+    auto x = static_cast<uint16_t>(d);
+    auto a = static_cast<uint16_t>(y);
+    uint16_t result = 0;
+    switch (comp)
+    {
+    case 0: result = 0; break;
+    case 1: result = 1; break;
+    case 2: result = 0xFFFF; break;
+    case 3: result = x; break;
+    case 4: case 18: result = a; break;
+    case 5: result = ~x; break;
+    case 6: case 19: result = ~a; break;
+    case 7: result = 0 - x; break;
+    case 8: case 20: result = 0 - a; break;
+    case 9: result = x + 1; break;
+    case 10: case 21: result = a + 1; break;
+    case 11: result = x - 1; break;
+    case 12: case 22: result = a - 1; break;
+    case 13: case 23: result = x + a; break;
+    case 14: case 24: result = x - a; break;
+    case 15: case 25: result = a - x; break;
+    case 16: case 26: result = x & a; break;
+    case 17: case 27: result = x | a; break;
+    default: break;
+    }
+    return static_cast<int16_t>(result);
+}
+
+bool HackInstruction::readsA() const
+{
+    return !isAddress && comp < 18 && COMPUTATIONS[comp].find('A') != string::npos;
+}
+
+bool HackInstruction::readsD() const
+{
+    return !isAddress && COMPUTATIONS[comp].find('D') != string::npos;
+}
+
+bool HackInstruction::readsM() const
+{
+    return !isAddress && comp >= 18;
+}
+
+string HackInstruction::toString() const
+{
+    if (isAddress)
+    {
+        return "@" + to_string(address);
+    }
+
+    string destination;
+    destination += dest & DEST_A ? "A" : "";
+    destination += dest & DEST_M ? "M" : "";
+    destination += dest & DEST_D ? "D" : "";
+    return destination.empty() ? COMPUTATIONS[comp] : destination + "=" + COMPUTATIONS[comp];
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// Single Hack instruction without a jump. Symbols of address instructions are resolved by the Superoptimizer.
+/// </summary>
+struct HackInstruction
+{
+    static constexpr int DEST_A = 4;
+    static constexpr int DEST_D = 2;
+    static constexpr int DEST_M = 1;
+    static constexpr int COMPUTATION_COUNT = 28;
+
+    bool isAddress = false;
+    int16_t address = 0;
+    int dest = 0;
+    // index of the computation, see getComputation
+    int comp = 0;
+
+    /// <summary>
+    /// Returns the computation with the given index as written in the assembly code, e.g. "D+M".
+    /// </summary>
+    static const std::string& getComputation(int comp);
+    /// <summary>
+    /// Returns the index of the computation or -1, if it is not valid. Operands of D+A, D&amp;A, D|A may be swapped.
+    /// </summary>
+    static int findComputation(const std::string& computation);
+
+    /// <summary>
+    /// Computes the value of the computation for the D register and the A register or memory operand.
+    /// </summary>
+    static int16_t compute(int comp, int16_t d, int16_t y);
+
+    bool readsA() const;
+    bool readsD() const;
+    bool readsM() const;
+    std::string toString() const;
+};
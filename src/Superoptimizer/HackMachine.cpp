@@ -0,0 +1,120 @@
+#include <array>
+#include "HackMachine.h"
+
+using namespace std;
+
+const array<int16_t, 5> EDGE_VALUES = { 0, 1, -1, 32767, -32768 };
+// THIS and THAT point to the heap between the stack end and this address
+constexpr int HEAP_END = 4000;
+
+int16_t randomValue(mt19937& random)
+{
+    // values at the edges of the range find the most of the incorrect candidates
+    switch (random() % 4)
+    {
+    case 0:
+        return EDGE_VALUES[random() % EDGE_VALUES.size()];
+    case 1:
+        // popped values are often stored to THIS or THAT
+        return static_cast<int16_t>(HackMachine::STACK_END + random() % (HEAP_END - HackMachine::STACK_END));
+    default:
+        return static_cast<int16_t>(random() & 0xFFFF);
+    }
+}
+
+/// <summary>
+/// Creates the machine with a random initial state.
+/// </summary>
+HackMachine::HackMachine(mt19937& random)
+    : mMemory(MEMORY_SIZE),
+    mA(randomValue(random)),
+    mD(randomValue(random))
+{
+    for (auto& word : mMemory)
+    {
+        word = randomValue(random);
+    }
+
+    auto randomAddress = [&random](int begin, int end)
+    {
+        return static_cast<int16_t>(begin + random() % (end - begin));
+    };
+    mMemory[0] = randomAddress(600, 700);
+    mMemory[1] = randomAddress(400, 500);
+    mMemory[2] = randomAddress(300, 380);
+    mMemory[3] = randomAddress(STACK_END, HEAP_END);
+    mMemory[4] = randomAddress(STACK_END, HEAP_END);
+}
+
+/// <summary>
+/// Runs the code from the initial state and collects the memory writes.
+/// </summary>
+/// <returns>False, if the code accessed memory outside of the model</returns>
+bool HackMachine::run(const vector<HackInstruction>& code, MemoryWrites& writes) const
+{
+    writes.clear();
+    int16_t a = mA;
+    int16_t d = mD;
+    auto load = [&]()
+    {
+        for (const auto& [address, value] : writes)
+        {
+            if (address == a)
+            {
+                return value;
+            }
+        }
+        return mMemory[a];
+    };
+
+    for (const auto& instruction : code)
+    {
+        if (instruction.isAddress)
+        {
+            a = instruction.address;
+            continue;
+        }
+
+        bool usesMemory = instruction.readsM() || (instruction.dest & HackInstruction::DEST_M);
+        if (usesMemory && (a < 0 || a >= MEMORY_SIZE))
+        {
+            return false;
+        }
+
+        auto value = HackInstruction::compute(instruction.comp, d, instruction.readsM() ? load() : a);
+        if (instruction.dest & HackInstruction::DEST_M)
+        {
+            // M is written with the old value of A
+            auto it = writes.begin();
+            while (it != writes.end() && it->first != a)
+            {
+                ++it;
+            }
+            if (it == writes.end())
+            {
+                writes.emplace_back(a, value);
+            }
+            else
+            {
+                it->second = value;
+            }
+        }
+        if (instruction.dest & HackInstruction::DEST_A)
+        {
+            a = value;
+        }
+        if (instruction.dest & HackInstruction::DEST_D)
+        {
+            d = value;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// Returns the initial value of the memory word.
+/// </summary>
+int16_t HackMachine::read(int address) const
+{
+    return mMemory[address];
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+#include "HackInstruction.h"
+
+/// <summary>
+/// Model of the Hack computer for the straight-line code of VM commands.
+/// <para/> The state is a random RAM image with stack, segment pointers and data placed like in a running program:
+///     ARG below LCL below SP within the stack and THIS, THAT in the heap. A and D registers start with unknown values.
+/// <para/> Only the first MEMORY_SIZE words are modeled, the code accessing other addresses is invalid.
+/// </summary>
+class HackMachine
+{
+public:
+    static constexpr int MEMORY_SIZE = 4096;
+    static constexpr int STACK_END = 2048;
+
+    /// <summary>
+    /// Final values of the written memory words in the order of the first write.
+    /// </summary>
+    using MemoryWrites = std::vector<std::pair<int, int16_t>>;
+
+    /// <summary>
+    /// Creates the machine with a random initial state.
+    /// </summary>
+    explicit HackMachine(std::mt19937& random);
+
+    /// <summary>
+    /// Runs the code from the initial state and collects the memory writes.
+    /// </summary>
+    /// <returns>False, if the code accessed memory outside of the model</returns>
+    bool run(const std::vector<HackInstruction>& code, MemoryWrites& writes) const;
+    /// <summary>
+    /// Returns the initial value of the memory word.
+    /// </summary>
+    int16_t read(int address) const;
+
+private:
+    std::vector<int16_t> mMemory;
+    int16_t mA;
+    int16_t mD;
+};
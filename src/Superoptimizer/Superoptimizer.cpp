@@ -0,0 +1,595 @@
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include "Superoptimizer.h"
+#include "SuperoptimizerError.h"
+#include "../VMTranslator/CodeWriter.h"
+#include "../VMTranslator/Parser.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// file name of the static variables in the reference code, File.i is placed in RAM[16 + i]
+const string STATIC_FILE_NAME = "File";
+// probability of accepting a stochastic step is exp(-STOCHASTIC_BETA * cost increase)
+constexpr double STOCHASTIC_BETA = 0.3;
+constexpr int MISMATCH_COST = 10;
+
+string toString(const VMCommand& command)
+{
+    if (command.type == ECommandType::C_ARITHMETIC)
+    {
+        return command.arg1;
+    }
+    return (command.type == ECommandType::C_PUSH ? "push " : "pop ") + command.arg1 + " " + to_string(command.arg2);
+}
+
+string toString(const vector<VMCommand>& commands)
+{
+    string name;
+    for (const auto& command : commands)
+    {
+        name += (name.empty() ? "" : "; ") + toString(command);
+    }
+    return name;
+}
+
+bool isStraightLineCommand(const VMCommand& command)
+{
+    if (command.type == ECommandType::C_ARITHMETIC)
+    {
+        return command.arg1 != "eq" && command.arg1 != "gt" && command.arg1 != "lt";
+    }
+    return command.type == ECommandType::C_PUSH || command.type == ECommandType::C_POP;
+}
+
+int16_t findSymbol(const string& symbol)
+{
+    static const map<string, int16_t> PREDEFINED_SYMBOLS = { { "SP", 0 }, { "LCL", 1 }, { "ARG", 2 }, { "THIS", 3 }, { "THAT", 4 } };
+    if (auto it = PREDEFINED_SYMBOLS.find(symbol); it != PREDEFINED_SYMBOLS.end())
+    {
+        return it->second;
+    }
+    if (symbol.size() > 1 && symbol[0] == 'R' && all_of(symbol.begin() + 1, symbol.end(), ::isdigit) && stoi(symbol.substr(1)) < 16)
+    {
+        return static_cast<int16_t>(stoi(symbol.substr(1)));
+    }
+    if (symbol.rfind(STATIC_FILE_NAME + ".", 0) == 0)
+    {
+        return static_cast<int16_t>(16 + stoi(symbol.substr(STATIC_FILE_NAME.size() + 1)));
+    }
+    throw SuperoptimizerError("Unsupported symbol " + symbol + ".");
+}
+
+HackInstruction parseInstruction(const string& line, map<int16_t, string>& symbols)
+{
+    HackInstruction instruction;
+    if (line[0] == '@')
+    {
+        instruction.isAddress = true;
+        auto value = line.substr(1);
+        if (all_of(value.begin(), value.end(), ::isdigit))
+        {
+            instruction.address = static_cast<int16_t>(stoi(value));
+        }
+        else
+        {
+            instruction.address = findSymbol(value);
+            symbols.emplace(instruction.address, value);
+        }
+        return instruction;
+    }
+
+    if (line[0] == '(' || line.find(';') != string::npos)
+    {
+        throw SuperoptimizerError("Jumps are not supported: " + line + ".");
+    }
+
+    auto equalSign = line.find('=');
+    auto dest = equalSign == string::npos ? string() : line.substr(0, equalSign);
+    instruction.comp = HackInstruction::findComputation(equalSign == string::npos ? line : line.substr(equalSign + 1));
+    if (instruction.comp < 0 || dest.find_first_not_of("ADM") != string::npos)
+    {
+        throw SuperoptimizerError("Invalid instruction " + line + ".");
+    }
+    instruction.dest = (dest.find('A') != string::npos ? HackInstruction::DEST_A : 0)
+        | (dest.find('D') != string::npos ? HackInstruction::DEST_D : 0)
+        | (dest.find('M') != string::npos ? HackInstruction::DEST_M : 0);
+    return instruction;
+}
+
+int16_t findFinalValue(const HackMachine& machine, const HackMachine::MemoryWrites& writes, int address)
+{
+    for (const auto& [writtenAddress, value] : writes)
+    {
+        if (writtenAddress == address)
+        {
+            return value;
+        }
+    }
+    return machine.read(address);
+}
+
+int countDifferences(const HackMachine& machine, const HackMachine::MemoryWrites& expected, const HackMachine::MemoryWrites& actual)
+{
+    // R13-R15 are temporary registers of the CodeWriter and the stack above SP is free
+    int stackPointer = findFinalValue(machine, expected, 0);
+    auto isCompared = [stackPointer](int address)
+    {
+        return (address < 13 || address > 15) && (address < stackPointer || address >= HackMachine::STACK_END);
+    };
+
+    int differenceCount = 0;
+    for (const auto& [address, value] : expected)
+    {
+        differenceCount += isCompared(address) && findFinalValue(machine, actual, address) != value;
+    }
+    for (const auto& [address, value] : actual)
+    {
+        // words written by both are already compared
+        bool isExpected = any_of(expected.begin(), expected.end(), [address = address](const auto& write) { return write.first == address; });
+        differenceCount += isCompared(address) && !isExpected && machine.read(address) != value;
+    }
+    return differenceCount;
+}
+
+/// <summary>
+/// Creates Superoptimizer.
+/// </summary>
+/// <param name="seed">Seed of the machine states and of the stochastic search</param>
+/// <param name="maxExhaustiveLength">Maximal length of the exhaustively enumerated code</param>
+/// <param name="iterations">Count of the steps of the stochastic search</param>
+Superoptimizer::Superoptimizer(unsigned seed, int maxExhaustiveLength, int iterations)
+    : mRandom(seed),
+    mMaxExhaustiveLength(maxExhaustiveLength),
+    mIterations(iterations)
+{
+    mMachines.reserve(VERIFICATION_TEST_COUNT);
+    for (size_t i = 0; i < VERIFICATION_TEST_COUNT; i++)
+    {
+        mMachines.emplace_back(mRandom);
+    }
+}
+
+/// <summary>
+/// Returns single push, pop and arithmetic commands and common pairs of them.
+/// </summary>
+vector<vector<VMCommand>> Superoptimizer::getDefaultTargets()
+{
+    auto push = [](const string& segment, int index) { return VMCommand{ ECommandType::C_PUSH, segment, index, "" }; };
+    auto pop = [](const string& segment, int index) { return VMCommand{ ECommandType::C_POP, segment, index, "" }; };
+    auto arithmetic = [](const string& command) { return VMCommand{ ECommandType::C_ARITHMETIC, command, -1, "" }; };
+
+    vector<vector<VMCommand>> targets;
+    for (const auto& segment : { "local", "argument", "this", "that" })
+    {
+        targets.push_back({ push(segment, 0) });
+        targets.push_back({ push(segment, 1) });
+        targets.push_back({ pop(segment, 0) });
+        targets.push_back({ pop(segment, 1) });
+    }
+    for (const auto& segment : { "pointer", "temp", "static" })
+    {
+        targets.push_back({ push(segment, 0) });
+        targets.push_back({ pop(segment, 0) });
+    }
+    for (int value : { 0, 1, 2 })
+    {
+        targets.push_back({ push("constant", value) });
+    }
+    for (const auto& command : { "add", "sub", "neg", "and", "or", "not" })
+    {
+        targets.push_back({ arithmetic(command) });
+    }
+
+    targets.push_back({ push("constant", 1), arithmetic("add") });
+    targets.push_back({ push("constant", 1), arithmetic("sub") });
+    targets.push_back({ push("constant", 0), arithmetic("not") });
+    targets.push_back({ push("constant", 1), arithmetic("neg") });
+    targets.push_back({ push("local", 0), push("local", 1) });
+    targets.push_back({ push("argument", 0), pop("pointer", 0) });
+    targets.push_back({ push("local", 0), arithmetic("add") });
+    targets.push_back({ pop("temp", 0), push("temp", 0) });
+    targets.push_back({ pop("pointer", 1), push("that", 0) });
+    return targets;
+}
+
+/// <summary>
+/// Returns the most frequent sequences of 1 to 3 push, pop and arithmetic commands from .vm files of the directories.
+/// </summary>
+/// <param name="count">Count of the sequences of each length</param>
+vector<vector<VMCommand>> Superoptimizer::findFrequentTargets(const vector<fs::path>& directories, int count)
+{
+    constexpr size_t MAX_TARGET_LENGTH = 3;
+    // sequence name -> commands and occurrence count
+    map<string, pair<vector<VMCommand>, int>> sequences;
+    for (const auto& directory : directories)
+    {
+        if (!fs::is_directory(directory))
+        {
+            throw SuperoptimizerError("Directory " + directory.string() + " does not exist.");
+        }
+
+        for (const auto& entry : fs::directory_iterator(directory))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".vm")
+            {
+                continue;
+            }
+
+            vector<VMCommand> window;
+            Parser parser(entry.path().string());
+            while (parser.hasMoreLines())
+            {
+                parser.advance();
+                if (parser.commandType() == ECommandType::COMMENT || parser.commandType() == ECommandType::UNDEFINED)
+                {
+                    continue;
+                }
+
+                auto command = VMCommand{ parser.commandType(), parser.arg1(), parser.arg2(), "" };
+                if (!isStraightLineCommand(command))
+                {
+                    window.clear();
+                    continue;
+                }
+                if (command.type == ECommandType::C_ARITHMETIC)
+                {
+                    command.arg2 = -1;
+                }
+
+                window.push_back(command);
+                if (window.size() > MAX_TARGET_LENGTH)
+                {
+                    window.erase(window.begin());
+                }
+                for (size_t length = 1; length <= window.size(); length++)
+                {
+                    vector<VMCommand> sequence(window.end() - length, window.end());
+                    sequences.try_emplace(toString(sequence), sequence, 0).first->second.second++;
+                }
+            }
+        }
+    }
+
+    vector<vector<VMCommand>> targets;
+    for (size_t length = 1; length <= MAX_TARGET_LENGTH; length++)
+    {
+        vector<const pair<vector<VMCommand>, int>*> candidates;
+        for (const auto& [name, sequence] : sequences)
+        {
+            if (sequence.first.size() == length)
+            {
+                candidates.push_back(&sequence);
+            }
+        }
+        stable_sort(candidates.begin(), candidates.end(), [](auto left, auto right) { return left->second > right->second; });
+        for (size_t i = 0; i < candidates.size() && i < static_cast<size_t>(count); i++)
+        {
+            targets.push_back(candidates[i]->first);
+        }
+    }
+    return targets;
+}
+
+/// <summary>
+/// Searches for the shortest code of the VM commands. The code is the reference, if nothing shorter was found.
+/// May throw SuperoptimizerError or VMTranslatorError for unsupported commands.
+/// </summary>
+Superoptimizer::Result Superoptimizer::optimize(const vector<VMCommand>& target)
+{
+    Result result;
+    result.name = toString(target);
+    result.reference = translate(target, result.symbols);
+    result.code = result.reference;
+
+    // states, in which the reference accesses memory outside of the model, are not used
+    mExpectedWrites.resize(mMachines.size());
+    mValidTests.clear();
+    for (size_t i = 0; i < mMachines.size(); i++)
+    {
+        if (mMachines[i].run(result.reference, mExpectedWrites[i]))
+        {
+            mValidTests.push_back(static_cast<int>(i));
+        }
+    }
+    if (mValidTests.size() < VERIFICATION_TEST_COUNT / 4)
+    {
+        throw SuperoptimizerError("Code of " + result.name + " accesses memory outside of the model.");
+    }
+
+    // the code uses the same addresses as the reference, 0 and 1 are useful constants
+    mAddresses.clear();
+    for (const auto& instruction : result.reference)
+    {
+        auto isSame = [&instruction](const HackInstruction& address) { return address.address == instruction.address; };
+        if (instruction.isAddress && none_of(mAddresses.begin(), mAddresses.end(), isSame))
+        {
+            mAddresses.push_back(instruction);
+        }
+    }
+    for (int16_t constant : { 0, 1 })
+    {
+        auto isSame = [constant](const HackInstruction& address) { return address.address == constant; };
+        if (none_of(mAddresses.begin(), mAddresses.end(), isSame))
+        {
+            HackInstruction instruction;
+            instruction.isAddress = true;
+            instruction.address = constant;
+            mAddresses.push_back(instruction);
+        }
+    }
+
+    for (size_t length = 1; length < result.reference.size() && length <= static_cast<size_t>(mMaxExhaustiveLength); length++)
+    {
+        vector<HackInstruction> code;
+        if (searchExhaustive(code, length, false, false))
+        {
+            simplify(mFoundCode);
+            result.code = mFoundCode;
+            return result;
+        }
+    }
+
+    if (result.reference.size() > static_cast<size_t>(mMaxExhaustiveLength) + 1)
+    {
+        searchStochastic(result);
+    }
+    return result;
+}
+
+/// <summary>
+/// Writes the found code as an entry of the table: "commands | reference length -> length", code and empty line.
+/// </summary>
+void Superoptimizer::writeEntry(ostream& stream, const Result& result)
+{
+    stream << result.name << " | " << result.reference.size() << " -> " << result.code.size() << "\n";
+    for (const auto& instruction : result.code)
+    {
+        auto it = instruction.isAddress ? result.symbols.find(instruction.address) : result.symbols.end();
+        stream << (it != result.symbols.end() ? "@" + it->second : instruction.toString()) << "\n";
+    }
+    stream << "\n";
+}
+
+vector<HackInstruction> Superoptimizer::translate(const vector<VMCommand>& target, map<int16_t, string>& symbols) const
+{
+    ostringstream stream;
+    CodeWriter codeWriter(stream, false, false);
+    codeWriter.setFileName(STATIC_FILE_NAME);
+    for (const auto& command : target)
+    {
+        if (!isStraightLineCommand(command))
+        {
+            throw SuperoptimizerError("Command " + toString(command) + " is not supported.");
+        }
+        if (command.type == ECommandType::C_ARITHMETIC)
+        {
+            codeWriter.writeArithmetic(command.arg1);
+        }
+        else
+        {
+            codeWriter.writePushPop(command.type, command.arg1, command.arg2);
+        }
+    }
+
+    vector<HackInstruction> code;
+    istringstream codeStream(stream.str());
+    string line;
+    while (getline(codeStream, line))
+    {
+        line.erase(remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (!line.empty() && line.rfind("//", 0) != 0)
+        {
+            code.push_back(parseInstruction(line, symbols));
+        }
+    }
+    return code;
+}
+
+bool Superoptimizer::isEquivalent(const vector<HackInstruction>& code, size_t firstTest, size_t lastTest)
+{
+    for (size_t i = firstTest; i < lastTest && i < mValidTests.size(); i++)
+    {
+        const auto& machine = mMachines[mValidTests[i]];
+        if (!machine.run(code, mWrites) || countDifferences(machine, mExpectedWrites[mValidTests[i]], mWrites) > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Superoptimizer::simplify(vector<HackInstruction>& code)
+{
+    for (size_t i = code.size(); i-- > 0;)
+    {
+        auto candidate = code;
+        candidate.erase(candidate.begin() + i);
+        if (!candidate.empty() && isEquivalent(candidate, 0, VERIFICATION_TEST_COUNT))
+        {
+            code = std::move(candidate);
+        }
+    }
+
+    // the search often writes the same value to more registers than needed
+    for (auto& instruction : code)
+    {
+        for (int bit : { HackInstruction::DEST_M, HackInstruction::DEST_A, HackInstruction::DEST_D })
+        {
+            auto dest = instruction.dest;
+            if (instruction.isAddress || (dest & bit) == 0 || dest == bit)
+            {
+                continue;
+            }
+
+            instruction.dest = dest & ~bit;
+            if (!isEquivalent(code, 0, VERIFICATION_TEST_COUNT))
+            {
+                instruction.dest = dest;
+            }
+        }
+    }
+}
+
+bool Superoptimizer::searchExhaustive(vector<HackInstruction>& code, size_t length, bool isADefined, bool isDDefined)
+{
+    if (code.size() == length)
+    {
+        if (isEquivalent(code, 0, SEARCH_TEST_COUNT) && isEquivalent(code, SEARCH_TEST_COUNT, VERIFICATION_TEST_COUNT))
+        {
+            mFoundCode = code;
+            return true;
+        }
+        return false;
+    }
+
+    // A and D registers are not compared, so the last instruction must write the memory
+    bool isLast = code.size() + 1 == length;
+    // the address loaded by the previous instruction must be used
+    bool mustUseA = !code.empty() && code.back().isAddress;
+    bool isPreviousWritingOnlyA = !code.empty() && !code.back().isAddress && code.back().dest == HackInstruction::DEST_A;
+
+    if (!isLast && !mustUseA && !isPreviousWritingOnlyA)
+    {
+        for (const auto& address : mAddresses)
+        {
+            code.push_back(address);
+            if (searchExhaustive(code, length, true, isDDefined))
+            {
+                return true;
+            }
+            code.pop_back();
+        }
+    }
+
+    HackInstruction instruction;
+    for (int comp = 0; comp < HackInstruction::COMPUTATION_COUNT; comp++)
+    {
+        instruction.comp = comp;
+        bool readsA = instruction.readsA() || instruction.readsM();
+        if ((readsA && !isADefined) || (instruction.readsD() && !isDDefined))
+        {
+            continue;
+        }
+
+        for (int dest = 1; dest <= 7; dest++)
+        {
+            bool writesM = dest & HackInstruction::DEST_M;
+            if ((writesM && !isADefined) || (isLast && !writesM) || (mustUseA && !readsA && !writesM))
+            {
+                continue;
+            }
+
+            instruction.dest = dest;
+            code.push_back(instruction);
+            if (searchExhaustive(code, length, isADefined || (dest & HackInstruction::DEST_A), isDDefined || (dest & HackInstruction::DEST_D)))
+            {
+                return true;
+            }
+            code.pop_back();
+        }
+    }
+    return false;
+}
+
+void Superoptimizer::searchStochastic(Result& result)
+{
+    uniform_real_distribution<double> probability(0.0, 1.0);
+    auto current = result.reference;
+    int currentCost = getCost(current, INT_MAX);
+
+    for (int iteration = 0; iteration < mIterations; iteration++)
+    {
+        auto candidate = current;
+        auto position = mRandom() % candidate.size();
+        switch (mRandom() % 5)
+        {
+        case 0:
+            candidate.erase(candidate.begin() + position);
+            break;
+        case 1:
+            candidate.insert(candidate.begin() + mRandom() % (candidate.size() + 1), makeRandomInstruction());
+            break;
+        case 2:
+            candidate[position] = makeRandomInstruction();
+            break;
+        case 3:
+        {
+            // moves the instruction to another position
+            auto instruction = candidate[position];
+            candidate.erase(candidate.begin() + position);
+            candidate.insert(candidate.begin() + mRandom() % (candidate.size() + 1), instruction);
+            break;
+        }
+        default:
+            if (candidate[position].isAddress)
+            {
+                candidate[position] = mAddresses[mRandom() % mAddresses.size()];
+            }
+            else if (mRandom() % 2 == 0)
+            {
+                candidate[position].dest = 1 + mRandom() % 7;
+            }
+            else
+            {
+                candidate[position].comp = mRandom() % HackInstruction::COMPUTATION_COUNT;
+            }
+            break;
+        }
+        if (candidate.empty())
+        {
+            continue;
+        }
+
+        // the step is accepted with probability exp(-STOCHASTIC_BETA * cost increase), so the evaluation of
+        //     the candidate stops at the largest accepted cost
+        double maxCost = currentCost - log(1.0 - probability(mRandom)) / STOCHASTIC_BETA;
+        int cost = getCost(candidate, static_cast<int>(min(maxCost, static_cast<double>(INT_MAX))));
+        if (cost <= maxCost)
+        {
+            current = candidate;
+            currentCost = cost;
+        }
+
+        // the cost without mismatches is the length
+        bool isCorrect = cost == static_cast<int>(candidate.size());
+        if (isCorrect && candidate.size() < result.code.size() && isEquivalent(candidate, SEARCH_TEST_COUNT, VERIFICATION_TEST_COUNT))
+        {
+            simplify(candidate);
+            result.code = candidate;
+        }
+    }
+}
+
+HackInstruction Superoptimizer::makeRandomInstruction()
+{
+    if (mRandom() % 4 == 0)
+    {
+        return mAddresses[mRandom() % mAddresses.size()];
+    }
+
+    HackInstruction instruction;
+    instruction.dest = 1 + mRandom() % 7;
+    instruction.comp = mRandom() % HackInstruction::COMPUTATION_COUNT;
+    return instruction;
+}
+
+int Superoptimizer::getCost(const vector<HackInstruction>& code, int maxCost)
+{
+    // every different word is a mismatch, so the cost decreases as the code approaches the reference
+    int cost = static_cast<int>(code.size());
+    for (size_t i = 0; i < SEARCH_TEST_COUNT && cost <= maxCost; i++)
+    {
+        const auto& machine = mMachines[mValidTests[i]];
+        const auto& expectedWrites = mExpectedWrites[mValidTests[i]];
+        int mismatchCount = machine.run(code, mWrites)
+            ? countDifferences(machine, expectedWrites, mWrites)
+            : static_cast<int>(expectedWrites.size()) + 1;
+        cost += MISMATCH_COST * mismatchCount;
+    }
+    return cost;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "HackInstruction.h"
+#include "HackMachine.h"
+#include "../VMTranslator/VMCommand.h"
+
+/// <summary>
+/// Superoptimizer searches for the shortest Hack code equivalent to the code written by the CodeWriter
+///     for a short sequence of VM commands.
+/// <para/> Sequences up to the given length are enumerated exhaustively, longer ones are searched stochastically
+///     starting from the reference code. Every candidate is checked against the reference on random machine states.
+/// <para/> The code is equivalent, if it leaves the same values in the memory. A and D registers, R13-R15 and
+///     the stack above the final SP are not compared.
+/// </summary>
+class Superoptimizer
+{
+public:
+    /// <summary>
+    /// Count of the machine states used by the search.
+    /// </summary>
+    static constexpr size_t SEARCH_TEST_COUNT = 16;
+    /// <summary>
+    /// Count of the machine states, which must give the same result for the found code.
+    /// </summary>
+    static constexpr size_t VERIFICATION_TEST_COUNT = 2000;
+
+    struct Result
+    {
+        std::string name;
+        std::vector<HackInstruction> reference;
+        std::vector<HackInstruction> code;
+        // symbols of the addresses in the reference code
+        std::map<int16_t, std::string> symbols;
+    };
+
+    /// <summary>
+    /// Creates Superoptimizer.
+    /// </summary>
+    /// <param name="seed">Seed of the machine states and of the stochastic search</param>
+    /// <param name="maxExhaustiveLength">Maximal length of the exhaustively enumerated code</param>
+    /// <param name="iterations">Count of the steps of the stochastic search</param>
+    Superoptimizer(unsigned seed, int maxExhaustiveLength, int iterations);
+
+    /// <summary>
+    /// Returns single push, pop and arithmetic commands and common pairs of them.
+    /// </summary>
+    static std::vector<std::vector<VMCommand>> getDefaultTargets();
+    /// <summary>
+    /// Returns the most frequent sequences of 1 to 3 push, pop and arithmetic commands from .vm files of the directories.
+    /// </summary>
+    /// <param name="count">Count of the sequences of each length</param>
+    static std::vector<std::vector<VMCommand>> findFrequentTargets(const std::vector<std::filesystem::path>& directories, int count);
+
+    /// <summary>
+    /// Searches for the shortest code of the VM commands. The code is the reference, if nothing shorter was found.
+    /// May throw SuperoptimizerError or VMTranslatorError for unsupported commands.
+    /// </summary>
+    Result optimize(const std::vector<VMCommand>& target);
+    /// <summary>
+    /// Writes the found code as an entry of the table: "commands | reference length -> length", code and empty line.
+    /// </summary>
+    static void writeEntry(std::ostream& stream, const Result& result);
+
+private:
+    std::vector<HackInstruction> translate(const std::vector<VMCommand>& target, std::map<int16_t, std::string>& symbols) const;
+    bool isEquivalent(const std::vector<HackInstruction>& code, size_t firstTest, size_t lastTest);
+    void simplify(std::vector<HackInstruction>& code);
+
+    bool searchExhaustive(std::vector<HackInstruction>& code, size_t length, bool isADefined, bool isDDefined);
+    void searchStochastic(Result& result);
+    HackInstruction makeRandomInstruction();
+    int getCost(const std::vector<HackInstruction>& code, int maxCost);
+
+    std::mt19937 mRandom;
+    int mMaxExhaustiveLength;
+    int mIterations;
+    std::vector<HackMachine> mMachines;
+
+    // expected memory writes in every machine state, indices of the states with the valid reference
+    std::vector<HackMachine::MemoryWrites> mExpectedWrites;
+    std::vector<int> mValidTests;
+    HackMachine::MemoryWrites mWrites;
+    std::vector<HackInstruction> mAddresses;
+    std::vector<HackInstruction> mFoundCode;
+};
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "Superoptimizer.h"
+#include "SuperoptimizerError.h"
+#include "../VMTranslator/VMTranslatorError.h"
+
+namespace fs = std::filesystem;
+
+bool parseNumber(int argc, char* argv[], int& i, int& value);
+
+int main(int argc, char* argv[])
+{
+    int maxExhaustiveLength = 3;
+    int iterations = 2000000;
+    int targetCount = 10;
+    int seed = 1;
+    std::vector<fs::path> inputDirectories;
+    bool validArguments = argc >= 2;
+    for (int i = 2; i < argc && validArguments; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--max-exhaustive")
+        {
+            validArguments = parseNumber(argc, argv, i, maxExhaustiveLength);
+        }
+        else if (arg == "--iterations")
+        {
+            validArguments = parseNumber(argc, argv, i, iterations);
+        }
+        else if (arg == "--targets")
+        {
+            validArguments = parseNumber(argc, argv, i, targetCount);
+        }
+        else if (arg == "--seed")
+        {
+            validArguments = parseNumber(argc, argv, i, seed);
+        }
+        else if (arg.rfind("--", 0) != 0)
+        {
+            inputDirectories.emplace_back(arg);
+        }
+        else
+        {
+            validArguments = false;
+        }
+    }
+
+    if (!validArguments)
+    {
+        std::cout << "Usage: \n"
+            << "\tSuperoptimizer OutputFile [InputDirectory...] [--max-exhaustive N] [--iterations N] [--targets N] [--seed N]\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        // without input directories the built-in commands are optimized
+        auto targets = inputDirectories.empty()
+            ? Superoptimizer::getDefaultTargets()
+            : Superoptimizer::findFrequentTargets(inputDirectories, targetCount);
+
+        std::ofstream outputFile(argv[1]);
+        if (!outputFile.is_open())
+        {
+            throw SuperoptimizerError("Cannot create or open " + std::string(argv[1]) + " file.");
+        }
+        outputFile << "// Shortest Hack code of VM commands found by the Superoptimizer (seed " << seed << ").\n"
+            << "// Format: commands | reference length -> length, the code and an empty line.\n\n";
+
+        auto superoptimizer = Superoptimizer(static_cast<unsigned>(seed), maxExhaustiveLength, iterations);
+        int improvedCount = 0;
+        for (const auto& target : targets)
+        {
+            Superoptimizer::Result result;
+            try
+            {
+                result = superoptimizer.optimize(target);
+            }
+            catch (const SuperoptimizerError& error)
+            {
+                // a sequence, which cannot be modeled, does not stop the search
+                std::cout << "Skipped: " << error.what() << "\n";
+                continue;
+            }
+            std::cout << result.name << ": " << result.reference.size() << " -> " << result.code.size() << "\n";
+            if (result.code.size() < result.reference.size())
+            {
+                Superoptimizer::writeEntry(outputFile, result);
+                improvedCount++;
+            }
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+
+        std::cout << "\nFound shorter code for " << improvedCount << " of " << targets.size() << " sequences.\n";
+        std::cout << "Created " << fs::path(argv[1]) << " file.\n";
+        std::cout << "Finished in " << (endTime - startTime) / std::chrono::milliseconds(1) << " ms.\n";
+        return EXIT_SUCCESS;
+    }
+    catch (const VMTranslatorError& error)
+    {
+        std::cout << "VMTranslator error: " << error.what() << "\n";
+    }
+    catch (const SuperoptimizerError& error)
+    {
+        std::cout << "Error: " << error.what() << " Aborting...\n";
+    }
+    return EXIT_FAILURE;
+}
+
+bool parseNumber(int argc, char* argv[], int& i, int& value)
+{
+    if (i + 1 >= argc)
+    {
+        return false;
+    }
+
+    try
+    {
+        value = std::stoi(argv[++i]);
+        return value >= 0;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/// <summary>
+/// Tool running the .tst script, it is selected by the file loaded by the script.
+/// </summary>
+enum class EScriptEngine
+{
+    UNDEFINED = 0,
+    // "load Chip.hdl"
+    HARDWARE_SIMULATOR = 1,
+    // "load Program.asm" or "load Program.hack"
+    CPU_EMULATOR = 2,
+    // "load Program.vm" or "load" of the directory
+    VM_EMULATOR = 3
+};
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "TestRunner.h"
+#include "TestRunnerError.h"
+#include "../CPUEmulator/CpuTestScript.h"
+#include "../HardwareSimulator/ChipTestScript.h"
+#include "../VMEmulator/VmTestScript.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const char* getEngineName(EScriptEngine engine)
+{
+    switch (engine)
+    {
+    case EScriptEngine::HARDWARE_SIMULATOR:
+        return "HDL";
+    case EScriptEngine::CPU_EMULATOR:
+        return "CPU";
+    case EScriptEngine::VM_EMULATOR:
+        return "VM";
+    default:
+        return "-";
+    }
+}
+
+const char* getResultName(ETestResult result)
+{
+    switch (result)
+    {
+    case ETestResult::PASSED:
+        return "PASSED";
+    case ETestResult::SKIPPED:
+        return "SKIPPED";
+    default:
+        return "FAILED";
+    }
+}
+
+TestRunner::TestRunner(int threadCount)
+    : mPool(threadCount)
+{
+}
+
+/// <summary>
+/// Adds the script or all scripts in the directory and its subdirectories. May throw TestRunnerError.
+/// </summary>
+void TestRunner::addScripts(const fs::path& inputPath)
+{
+    if (!fs::exists(inputPath))
+    {
+        throw TestRunnerError("Input path or directory " + inputPath.string() + " does not exist.");
+    }
+
+    vector<fs::path> paths;
+    if (!fs::is_directory(inputPath))
+    {
+        paths.push_back(inputPath);
+    }
+    else
+    {
+        for (const auto& entry : fs::recursive_directory_iterator(inputPath))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".tst")
+            {
+                paths.push_back(entry.path());
+            }
+        }
+        sort(paths.begin(), paths.end());
+    }
+
+    for (const auto& path : paths)
+    {
+        ifstream file(path);
+        string code((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+        auto& testCase = mTestCases.emplace_back();
+        testCase.path = path;
+        testCase.engine = findEngine(code);
+        auto outputFile = findArgument(code, "output-file");
+        if (outputFile.has_value() && !outputFile->empty())
+        {
+            testCase.outputPath = (path.parent_path() / *outputFile).lexically_normal();
+        }
+    }
+}
+
+/// <summary>
+/// Sets keys held on the Keyboard chip by chip tests, every while loop of a script presses the next key.
+/// </summary>
+void TestRunner::setKeys(const string& keys)
+{
+    mKeys = keys;
+}
+
+/// <summary>
+/// Runs all added scripts and prints the table of results. Returns whether no script failed.
+/// </summary>
+bool TestRunner::run()
+{
+    // scripts writing the same output file (Name.tst and NameVME.tst) run one after another in one task
+    vector<vector<size_t>> tasks;
+    map<fs::path, size_t> outputTasks;
+    for (size_t index = 0; index < mTestCases.size(); index++)
+    {
+        const auto& outputPath = mTestCases[index].outputPath;
+        if (outputPath.empty())
+        {
+            tasks.push_back({ index });
+            continue;
+        }
+        auto [outputTask, isInserted] = outputTasks.try_emplace(outputPath, tasks.size());
+        if (isInserted)
+        {
+            tasks.emplace_back();
+        }
+        tasks[outputTask->second].push_back(index);
+    }
+
+    auto startTime = chrono::high_resolution_clock::now();
+    mPool.run(tasks.size(), [this, &tasks](size_t task, int thread)
+    {
+        for (auto index : tasks[task])
+        {
+            auto& testCase = mTestCases[index];
+            testCase.thread = thread;
+            runTestCase(testCase);
+        }
+    });
+    auto endTime = chrono::high_resolution_clock::now();
+
+    printTable(chrono::duration<double, milli>(endTime - startTime).count());
+    return none_of(mTestCases.begin(), mTestCases.end(), [](const TestCase& testCase) { return testCase.result == ETestResult::FAILED; });
+}
+
+/// <summary>
+/// Returns the engine selected by the first load command of the script.
+/// </summary>
+EScriptEngine TestRunner::findEngine(const string& code)
+{
+    auto fileName = findArgument(code, "load");
+    if (!fileName.has_value())
+    {
+        return EScriptEngine::UNDEFINED;
+    }
+
+    auto extension = fs::path(*fileName).extension();
+    if (extension == ".hdl")
+    {
+        return EScriptEngine::HARDWARE_SIMULATOR;
+    }
+    if (extension == ".asm" || extension == ".hack")
+    {
+        return EScriptEngine::CPU_EMULATOR;
+    }
+    // the VMEmulator loads all .vm files of the directory without the argument
+    return EScriptEngine::VM_EMULATOR;
+}
+
+/// <summary>
+/// Returns the argument of the first command of the script, which is empty, if the command has no argument.
+/// </summary>
+optional<string> TestRunner::findArgument(const string& code, const string& command)
+{
+    size_t position = 0;
+    while (position < code.size())
+    {
+        if (code.compare(position, 2, "//") == 0)
+        {
+            position = code.find('\n', position);
+            continue;
+        }
+        if (code.compare(position, 2, "/*") == 0)
+        {
+            position = code.find("*/", position);
+            position = position == string::npos ? position : position + 2;
+            continue;
+        }
+        bool isWordStart = position == 0 || !isalnum(static_cast<unsigned char>(code[position - 1]));
+        auto argumentStart = position + command.size();
+        bool isWordEnd = argumentStart >= code.size() || isspace(static_cast<unsigned char>(code[argumentStart]))
+            || code[argumentStart] == ',' || code[argumentStart] == ';';
+        if (!isWordStart || code.compare(position, command.size(), command) != 0 || !isWordEnd)
+        {
+            position++;
+            continue;
+        }
+
+        auto argumentEnd = code.find_first_of(",;", argumentStart);
+        istringstream argument(code.substr(argumentStart, argumentEnd - argumentStart));
+        string value;
+        argument >> value;
+        return value;
+    }
+    return nullopt;
+}
+
+void TestRunner::runTestCase(TestCase& testCase) const
+{
+    auto startTime = chrono::high_resolution_clock::now();
+    try
+    {
+        switch (testCase.engine)
+        {
+        case EScriptEngine::HARDWARE_SIMULATOR:
+        {
+            auto script = ChipTestScript(testCase.path);
+            script.setKeys(mKeys);
+            testCase.result = script.run();
+            testCase.message = script.getMessage();
+            testCase.outputCount = script.getOutputCount();
+            break;
+        }
+        case EScriptEngine::CPU_EMULATOR:
+        {
+            auto script = CpuTestScript(testCase.path);
+            testCase.result = script.run();
+            testCase.message = script.getMessage();
+            testCase.outputCount = script.getOutputCount();
+            break;
+        }
+        case EScriptEngine::VM_EMULATOR:
+        {
+            auto script = VmTestScript(testCase.path);
+            testCase.result = script.run();
+            testCase.message = script.getMessage();
+            testCase.outputCount = script.getOutputCount();
+            break;
+        }
+        case EScriptEngine::UNDEFINED:
+            testCase.result = ETestResult::SKIPPED;
+            testCase.message = "The script loads no file.";
+            break;
+        default:
+            testCase.result = ETestResult::SKIPPED;
+            testCase.message = string("No engine for ") + getEngineName(testCase.engine) + " scripts.";
+            break;
+        }
+    }
+    catch (const exception& error)
+    {
+        // TestScriptError and errors of simulators
+        testCase.result = ETestResult::FAILED;
+        testCase.message = error.what();
+    }
+    auto endTime = chrono::high_resolution_clock::now();
+    testCase.milliseconds = chrono::duration<double, milli>(endTime - startTime).count();
+}
+
+void TestRunner::printTable(double milliseconds) const
+{
+    int counts[4] = {};
+    double totalMilliseconds = 0;
+    cout << left << setw(8) << "Result" << setw(8) << "Engine" << right << setw(12) << "Time [ms]" << setw(8) << "Thread"
+        << setw(9) << "Outputs" << "  Script\n";
+    for (const auto& testCase : mTestCases)
+    {
+        cout << left << setw(8) << getResultName(testCase.result) << setw(8) << getEngineName(testCase.engine)
+            << right << setw(12) << fixed << setprecision(1) << testCase.milliseconds << setw(8) << testCase.thread
+            << setw(9) << testCase.outputCount << "  " << testCase.path.string() << "\n";
+        if (!testCase.message.empty() && testCase.result != ETestResult::PASSED)
+        {
+            cout << "\t" << testCase.message << "\n";
+        }
+        counts[static_cast<int>(testCase.result)]++;
+        totalMilliseconds += testCase.milliseconds;
+    }
+
+    cout << "\nPassed " << counts[static_cast<int>(ETestResult::PASSED)]
+        << ", failed " << counts[static_cast<int>(ETestResult::FAILED)] + counts[static_cast<int>(ETestResult::UNDEFINED)]
+        << ", skipped " << counts[static_cast<int>(ETestResult::SKIPPED)] << " scripts.\n"
+        << "Ran " << mTestCases.size() << " scripts in " << setprecision(1) << milliseconds << " ms on " << mPool.getThreadCount()
+        << " threads (" << totalMilliseconds << " ms of scripts, " << mPool.getStolenTaskCount() << " stolen).\n";
+}
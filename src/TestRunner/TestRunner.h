@@ -0,0 +1,56 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include "EScriptEngine.h"
+#include "WorkStealingPool.h"
+#include "../HardwareSimulator/ETestResult.h"
+
+/// <summary>
+/// TestRunner finds .tst scripts of all projects and runs them in parallel, every script compares its output
+///     with the .cmp file in the process of the runner.
+/// <para/> The engine of the script is selected by its load command. Engines, which are not available,
+///     skip their scripts.
+/// </summary>
+class TestRunner
+{
+public:
+    explicit TestRunner(int threadCount);
+
+    /// <summary>
+    /// Adds the script or all scripts in the directory and its subdirectories. May throw TestRunnerError.
+    /// </summary>
+    void addScripts(const std::filesystem::path& inputPath);
+    /// <summary>
+    /// Sets keys held on the Keyboard chip by chip tests, every while loop of a script presses the next key.
+    /// </summary>
+    void setKeys(const std::string& keys);
+    /// <summary>
+    /// Runs all added scripts and prints the table of results. Returns whether no script failed.
+    /// </summary>
+    bool run();
+
+private:
+    struct TestCase
+    {
+        std::filesystem::path path;
+        // output-file of the script, empty without the command
+        std::filesystem::path outputPath;
+        EScriptEngine engine = EScriptEngine::UNDEFINED;
+        ETestResult result = ETestResult::UNDEFINED;
+        std::string message;
+        int outputCount = 0;
+        double milliseconds = 0;
+        int thread = 0;
+    };
+
+    static EScriptEngine findEngine(const std::string& code);
+    static std::optional<std::string> findArgument(const std::string& code, const std::string& command);
+    void runTestCase(TestCase& testCase) const;
+    void printTable(double milliseconds) const;
+
+    WorkStealingPool mPool;
+    std::string mKeys;
+    std::vector<TestCase> mTestCases;
+};
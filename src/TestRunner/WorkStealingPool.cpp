@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <thread>
+#include "WorkStealingPool.h"
+
+using namespace std;
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : mThreadCount(max(threadCount, 1))
+{
+    for (int i = 0; i < mThreadCount; i++)
+    {
+        mQueues.push_back(make_unique<Queue>());
+    }
+}
+
+/// <summary>
+/// Runs the task for every index from 0 to taskCount - 1 and waits for all of them.
+/// The task must not throw, it receives the index and the number of the thread.
+/// </summary>
+void WorkStealingPool::run(size_t taskCount, const function<void(size_t task, int thread)>& task)
+{
+    mStolenTaskCount = 0;
+    // tasks are dealt round-robin, neighbouring tasks usually take similar time
+    for (size_t i = 0; i < taskCount; i++)
+    {
+        mQueues[i % mThreadCount]->tasks.push_front(i);
+    }
+
+    auto work = [&](int thread)
+    {
+        size_t index = 0;
+        while (popTask(thread, index) || stealTask(thread, index))
+        {
+            task(index, thread);
+        }
+    };
+
+    // the calling thread is the first worker, no tasks are added during the run
+    vector<thread> threads;
+    for (int i = 1; i < mThreadCount; i++)
+    {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::getThreadCount() const
+{
+    return mThreadCount;
+}
+
+/// <summary>
+/// Returns the count of tasks taken from the queue of another thread by the last run.
+/// </summary>
+long long WorkStealingPool::getStolenTaskCount() const
+{
+    return mStolenTaskCount;
+}
+
+bool WorkStealingPool::popTask(int thread, size_t& task)
+{
+    auto& queue = *mQueues[thread];
+    lock_guard<mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::stealTask(int thread, size_t& task)
+{
+    for (int i = 1; i < mThreadCount; i++)
+    {
+        auto& queue = *mQueues[(thread + i) % mThreadCount];
+        lock_guard<mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            mStolenTaskCount++;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// WorkStealingPool runs independent tasks on several threads.
+/// <para/> Every thread has its own queue of tasks and takes them from its back. A thread with the empty queue
+///     steals a task from the front of another queue, so long tasks do not leave other threads idle.
+/// </summary>
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threadCount);
+
+    /// <summary>
+    /// Runs the task for every index from 0 to taskCount - 1 and waits for all of them.
+    /// The task must not throw, it receives the index and the number of the thread.
+    /// </summary>
+    void run(size_t taskCount, const std::function<void(size_t task, int thread)>& task);
+
+    int getThreadCount() const;
+    /// <summary>
+    /// Returns the count of tasks taken from the queue of another thread by the last run.
+    /// </summary>
+    long long getStolenTaskCount() const;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    bool popTask(int thread, size_t& task);
+    bool stealTask(int thread, size_t& task);
+
+    int mThreadCount;
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::atomic<long long> mStolenTaskCount = 0;
+};
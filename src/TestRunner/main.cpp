@@ -0,0 +1,69 @@
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "TestRunner.h"
+#include "TestRunnerError.h"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[])
+{
+    std::string keys;
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<fs::path> inputPaths;
+    bool validArguments = argc >= 2;
+    for (int i = 1; i < argc && validArguments; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc)
+        {
+            keys = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            try
+            {
+                threadCount = std::stoi(argv[++i]);
+                validArguments = threadCount > 0;
+            }
+            catch (const std::exception&)
+            {
+                validArguments = false;
+            }
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            validArguments = false;
+        }
+        else
+        {
+            inputPaths.emplace_back(arg);
+        }
+    }
+
+    if (!validArguments || inputPaths.empty())
+    {
+        std::cout << "Usage: \n"
+            << "\tTestRunner Script.tst|Directory... [--keys Keys] [--threads N]\n"
+            << "\t--keys: keys held on the Keyboard by chip tests, every while loop of a script presses the next key\n"
+            << "\t--threads: count of scripts run in parallel, the count of processor cores by default\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        auto testRunner = TestRunner(threadCount);
+        testRunner.setKeys(keys);
+        for (const auto& inputPath : inputPaths)
+        {
+            testRunner.addScripts(inputPath);
+        }
+        return testRunner.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const TestRunnerError& error)
+    {
+        std::cout << "Error: " << error.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
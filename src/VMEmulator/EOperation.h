@@ -0,0 +1,23 @@
+#pragma once
+enum class EOperation {
+    UNDEFINED = 0,
+    ADD = 1,
+    SUB = 2,
+    NEG = 3,
+    EQ = 4,
+    GT = 5,
+    LT = 6,
+    AND = 7,
+    OR = 8,
+    NOT = 9,
+    PUSH_CONSTANT = 10,
+    PUSH_SEGMENT = 11,
+    PUSH_ADDRESS = 12,
+    POP_SEGMENT = 13,
+    POP_ADDRESS = 14,
+    GOTO = 15,
+    IF_GOTO = 16,
+    FUNCTION = 17,
+    CALL = 18,
+    RETURN = 19
+};
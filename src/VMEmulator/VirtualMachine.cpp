@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <fstream>
+#include "VirtualMachine.h"
+#include "VMEmulatorError.h"
+#include "../VMTranslator/Parser.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// SP, LCL, ARG, THIS and THAT
+constexpr int SP = 0;
+constexpr int LCL = 1;
+constexpr int ARG = 2;
+constexpr int THIS = 3;
+constexpr int THAT = 4;
+constexpr int TEMP_ADDRESS = 5;
+
+const unordered_map<string, EOperation> arithmeticOperations = {
+    { "add", EOperation::ADD },
+    { "sub", EOperation::SUB },
+    { "neg", EOperation::NEG },
+    { "eq", EOperation::EQ },
+    { "gt", EOperation::GT },
+    { "lt", EOperation::LT },
+    { "and", EOperation::AND },
+    { "or", EOperation::OR },
+    { "not", EOperation::NOT }
+};
+
+const unordered_map<string, int> segmentRegisters = {
+    { "local", LCL },
+    { "argument", ARG },
+    { "this", THIS },
+    { "that", THAT }
+};
+
+VirtualMachine::VirtualMachine()
+    : mRam(RAM_SIZE)
+{
+}
+
+/// <summary>
+/// Loads .vm files and resets the machine. The program starts by the call of Sys.init, if it is defined,
+///     otherwise at the first command. May throw VMEmulatorError.
+/// </summary>
+void VirtualMachine::loadProgram(const vector<fs::path>& paths)
+{
+    mInstructions.clear();
+    mLabels.clear();
+    mFunctions.clear();
+    mStaticAddresses.clear();
+    for (const auto& path : paths)
+    {
+        loadFile(path);
+    }
+    resolveTargets();
+
+    auto sysInit = mFunctions.find("Sys.init");
+    mCallsSysInit = sysInit != mFunctions.end();
+    mStartIndex = mCallsSysInit ? sysInit->second : 0;
+    reset();
+}
+
+/// <summary>
+/// Clears RAM, the program counter and the step count, the program is kept.
+///     Sys.init is called like by the bootstrap code, SP = 256 and call Sys.init 0.
+/// </summary>
+void VirtualMachine::reset()
+{
+    fill(mRam.begin(), mRam.end(), 0);
+    mPC = mStartIndex;
+    mStepCount = 0;
+    if (mCallsSysInit)
+    {
+        // the return index after the last command ends the program, LCL, ARG, THIS and THAT are saved as 0
+        mRam[256] = static_cast<int16_t>(mInstructions.size());
+        mRam[SP] = 261;
+        mRam[LCL] = 261;
+        mRam[ARG] = 256;
+    }
+}
+
+/// <summary>
+/// Executes stepCount commands. May throw VMEmulatorError, if the program ends.
+/// </summary>
+void VirtualMachine::run(long long stepCount)
+{
+    auto* ram = mRam.data();
+    auto at = [ram](int address) -> int16_t&
+    {
+        return ram[address & (RAM_SIZE - 1)];
+    };
+    auto push = [&](int value)
+    {
+        at(ram[SP]) = static_cast<int16_t>(value);
+        ram[SP]++;
+    };
+    auto pop = [&]()
+    {
+        ram[SP]--;
+        return at(ram[SP]);
+    };
+
+    for (long long step = 0; step < stepCount; step++)
+    {
+        if (mPC < 0 || mPC >= static_cast<int>(mInstructions.size()))
+        {
+            throw VMEmulatorError("Program ended after " + to_string(mStepCount) + " steps.");
+        }
+        const auto& instruction = mInstructions[mPC++];
+        mStepCount++;
+
+        switch (instruction.operation)
+        {
+        case EOperation::ADD: { int y = pop(); push(pop() + y); break; }
+        case EOperation::SUB: { int y = pop(); push(pop() - y); break; }
+        case EOperation::NEG: push(-pop()); break;
+        case EOperation::EQ: { int y = pop(); push(pop() == y ? -1 : 0); break; }
+        case EOperation::GT: { int y = pop(); push(pop() > y ? -1 : 0); break; }
+        case EOperation::LT: { int y = pop(); push(pop() < y ? -1 : 0); break; }
+        case EOperation::AND: { int y = pop(); push(pop() & y); break; }
+        case EOperation::OR: { int y = pop(); push(pop() | y); break; }
+        case EOperation::NOT: push(~pop()); break;
+        case EOperation::PUSH_CONSTANT:
+            push(instruction.argument);
+            break;
+        case EOperation::PUSH_SEGMENT:
+            push(at(ram[instruction.argument] + instruction.index));
+            break;
+        case EOperation::PUSH_ADDRESS:
+            push(at(instruction.argument));
+            break;
+        case EOperation::POP_SEGMENT:
+        {
+            // the address is computed before the pop, like in the translated code
+            int address = ram[instruction.argument] + instruction.index;
+            at(address) = pop();
+            break;
+        }
+        case EOperation::POP_ADDRESS:
+            at(instruction.argument) = pop();
+            break;
+        case EOperation::GOTO:
+            mPC = instruction.index;
+            break;
+        case EOperation::IF_GOTO:
+            mPC = pop() != 0 ? instruction.index : mPC;
+            break;
+        case EOperation::FUNCTION:
+            for (int i = 0; i < instruction.argument; i++)
+            {
+                push(0);
+            }
+            break;
+        case EOperation::CALL:
+        {
+            int sp = ram[SP];
+            push(mPC);
+            push(ram[LCL]);
+            push(ram[ARG]);
+            push(ram[THIS]);
+            push(ram[THAT]);
+            ram[ARG] = static_cast<int16_t>(sp - instruction.argument);
+            ram[LCL] = ram[SP];
+            mPC = instruction.index;
+            break;
+        }
+        case EOperation::RETURN:
+        {
+            int frame = ram[LCL];
+            int returnIndex = at(frame - 5);
+            at(ram[ARG]) = pop();
+            ram[SP] = static_cast<int16_t>(ram[ARG] + 1);
+            ram[THAT] = at(frame - 1);
+            ram[THIS] = at(frame - 2);
+            ram[ARG] = at(frame - 3);
+            ram[LCL] = at(frame - 4);
+            mPC = returnIndex;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+int16_t VirtualMachine::getRam(int address) const
+{
+    return mRam[address];
+}
+
+void VirtualMachine::setRam(int address, int16_t value)
+{
+    mRam[address] = value;
+}
+
+/// <summary>
+/// Returns the count of executed commands.
+/// </summary>
+long long VirtualMachine::getStepCount() const
+{
+    return mStepCount;
+}
+
+void VirtualMachine::loadFile(const fs::path& path)
+{
+    ifstream file(path);
+    if (!file.is_open())
+    {
+        throw VMEmulatorError("Cannot open " + path.string() + " file.");
+    }
+
+    auto fileName = path.stem().string();
+    string functionName;
+    auto parser = Parser(file);
+    while (parser.hasMoreLines())
+    {
+        parser.advance();
+        auto type = parser.commandType();
+        if (type == ECommandType::COMMENT)
+        {
+            continue;
+        }
+        if (type == ECommandType::UNDEFINED)
+        {
+            throw VMEmulatorError("Unknown command in " + path.filename().string() + " file.");
+        }
+
+        Instruction instruction;
+        auto arg1 = type == ECommandType::C_RETURN ? string() : parser.arg1();
+        switch (type)
+        {
+        case ECommandType::C_ARITHMETIC:
+            instruction.operation = arithmeticOperations.at(arg1);
+            break;
+        case ECommandType::C_PUSH:
+        case ECommandType::C_POP:
+        {
+            bool isPush = type == ECommandType::C_PUSH;
+            int index = parser.arg2();
+            if (arg1 == "constant" && isPush)
+            {
+                instruction.operation = EOperation::PUSH_CONSTANT;
+                instruction.argument = index;
+            }
+            else if (auto it = segmentRegisters.find(arg1); it != segmentRegisters.end())
+            {
+                instruction.operation = isPush ? EOperation::PUSH_SEGMENT : EOperation::POP_SEGMENT;
+                instruction.argument = it->second;
+                instruction.index = index;
+            }
+            else if (arg1 == "temp" || arg1 == "pointer" || arg1 == "static")
+            {
+                instruction.operation = isPush ? EOperation::PUSH_ADDRESS : EOperation::POP_ADDRESS;
+                if (arg1 == "static")
+                {
+                    // variables are placed in the order of their first use, like by the HackAssembler
+                    auto key = fileName + "." + to_string(index);
+                    auto address = STATIC_ADDRESS + static_cast<int>(mStaticAddresses.size());
+                    instruction.argument = mStaticAddresses.emplace(key, address).first->second;
+                }
+                else
+                {
+                    instruction.argument = (arg1 == "temp" ? TEMP_ADDRESS : THIS) + index;
+                }
+            }
+            else
+            {
+                throw VMEmulatorError("Invalid segment " + arg1 + " in " + path.filename().string() + " file.");
+            }
+            break;
+        }
+        case ECommandType::C_LABEL:
+            // labels are not steps, they point to the next command
+            mLabels[functionName + "$" + arg1] = static_cast<int>(mInstructions.size());
+            continue;
+        case ECommandType::C_GOTO:
+        case ECommandType::C_IF:
+            instruction.operation = type == ECommandType::C_GOTO ? EOperation::GOTO : EOperation::IF_GOTO;
+            instruction.target = functionName + "$" + arg1;
+            break;
+        case ECommandType::C_FUNCTION:
+            functionName = arg1;
+            if (!mFunctions.emplace(functionName, static_cast<int>(mInstructions.size())).second)
+            {
+                throw VMEmulatorError("Function " + functionName + " is defined twice.");
+            }
+            instruction.operation = EOperation::FUNCTION;
+            instruction.argument = parser.arg2();
+            break;
+        case ECommandType::C_CALL:
+            instruction.operation = EOperation::CALL;
+            instruction.argument = parser.arg2();
+            instruction.target = arg1;
+            break;
+        case ECommandType::C_RETURN:
+            instruction.operation = EOperation::RETURN;
+            break;
+        default:
+            break;
+        }
+        mInstructions.push_back(std::move(instruction));
+    }
+}
+
+void VirtualMachine::resolveTargets()
+{
+    for (auto& instruction : mInstructions)
+    {
+        if (instruction.operation == EOperation::GOTO || instruction.operation == EOperation::IF_GOTO)
+        {
+            auto it = mLabels.find(instruction.target);
+            if (it == mLabels.end())
+            {
+                throw VMEmulatorError("Label " + instruction.target + " is not defined.");
+            }
+            instruction.index = it->second;
+        }
+        else if (instruction.operation == EOperation::CALL)
+        {
+            auto it = mFunctions.find(instruction.target);
+            if (it == mFunctions.end())
+            {
+                throw VMEmulatorError("Function " + instruction.target + " is not defined.");
+            }
+            instruction.index = it->second;
+        }
+    }
+}
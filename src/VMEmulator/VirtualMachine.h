@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "EOperation.h"
+
+/// <summary>
+/// VirtualMachine interprets VM code on the memory of the Hack computer, like the VMEmulator.
+/// <para/> SP, LCL, ARG, THIS and THAT are kept in RAM[0..4], the stack and frames of calls have the same layout
+///     as in the code of the VMTranslator, only return addresses are indices of commands.
+/// <para/> Commands are decoded when they are loaded: segments become registers or fixed addresses and labels
+///     and functions become indices, so every step only dispatches the decoded operation.
+/// </summary>
+class VirtualMachine
+{
+public:
+    static constexpr int RAM_SIZE = 32768;
+    static constexpr int STATIC_ADDRESS = 16;
+
+    VirtualMachine();
+
+    /// <summary>
+    /// Loads .vm files and resets the machine. The program starts by the call of Sys.init, if it is defined,
+    ///     otherwise at the first command. May throw VMEmulatorError.
+    /// </summary>
+    void loadProgram(const std::vector<std::filesystem::path>& paths);
+    /// <summary>
+    /// Clears RAM, the program counter and the step count, the program is kept.
+    ///     Sys.init is called like by the bootstrap code, SP = 256 and call Sys.init 0.
+    /// </summary>
+    void reset();
+    /// <summary>
+    /// Executes stepCount commands. May throw VMEmulatorError, if the program ends.
+    /// </summary>
+    void run(long long stepCount);
+
+    int16_t getRam(int address) const;
+    void setRam(int address, int16_t value);
+    /// <summary>
+    /// Returns the count of executed commands.
+    /// </summary>
+    long long getStepCount() const;
+
+private:
+    struct Instruction
+    {
+        EOperation operation = EOperation::UNDEFINED;
+        // constant, pointer register, fixed address, count of locals or arguments
+        int argument = 0;
+        // index in the segment or the command index of a jump or a call
+        int index = 0;
+        // label or function resolved after all files are loaded
+        std::string target;
+    };
+
+    void loadFile(const std::filesystem::path& path);
+    void resolveTargets();
+
+    std::vector<Instruction> mInstructions;
+    std::unordered_map<std::string, int> mLabels;
+    std::unordered_map<std::string, int> mFunctions;
+    std::unordered_map<std::string, int> mStaticAddresses;
+    int mStartIndex = 0;
+    bool mCallsSysInit = false;
+
+    std::vector<int16_t> mRam;
+    int mPC = 0;
+    long long mStepCount = 0;
+};
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include "VmTestScript.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const vector<string> pointerNames = { "sp", "local", "argument", "this", "that" };
+
+/// <summary>
+/// Parses the .tst file. May throw TestScriptError.
+/// </summary>
+VmTestScript::VmTestScript(const fs::path& path)
+    : TestScript(path)
+{
+}
+
+/// <summary>
+/// Returns .vm files loaded by the last load command.
+/// </summary>
+const vector<fs::path>& VmTestScript::getLoadedFiles() const
+{
+    return mLoadedFiles;
+}
+
+/// <summary>
+/// Returns the count of VM commands executed by all loaded programs.
+/// </summary>
+long long VmTestScript::getStepCount() const
+{
+    return mStepCount + (mMachine ? mMachine->getStepCount() : 0);
+}
+
+/// <summary>
+/// Loads the .vm file, the directory or the directory of the script without the argument.
+/// </summary>
+bool VmTestScript::load(const Command& command)
+{
+    auto path = mPath.parent_path();
+    if (command.words.size() == 2)
+    {
+        path /= command.words[1];
+        // the script is meant for the HardwareSimulator or the CPUEmulator
+        if (path.extension() != ".vm" && !fs::is_directory(path))
+        {
+            return false;
+        }
+    }
+
+    mLoadedFiles.clear();
+    if (fs::is_directory(path))
+    {
+        for (const auto& entry : fs::directory_iterator(path))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".vm")
+            {
+                mLoadedFiles.push_back(entry.path());
+            }
+        }
+        sort(mLoadedFiles.begin(), mLoadedFiles.end());
+    }
+    else
+    {
+        mLoadedFiles.push_back(path);
+    }
+    // .jack files of the directory are not compiled yet
+    if (mLoadedFiles.empty())
+    {
+        return false;
+    }
+
+    if (mMachine)
+    {
+        mStepCount += mMachine->getStepCount();
+    }
+    mMachine = make_unique<VirtualMachine>();
+    mMachine->loadProgram(mLoadedFiles);
+    return true;
+}
+
+bool VmTestScript::executeSimulatorCommand(const Command& command)
+{
+    if (command.words.size() != 1 || command.words[0] != "vmstep")
+    {
+        return false;
+    }
+    getMachine(command).run(1);
+    return true;
+}
+
+int VmTestScript::readValue(const Command& command, const string& name, bool& isSigned) const
+{
+    isSigned = true;
+    return getMachine(command).getRam(findAddress(command, name));
+}
+
+void VmTestScript::writeValue(const Command& command, const string& name, int value)
+{
+    getMachine(command).setRam(findAddress(command, name), static_cast<int16_t>(value));
+}
+
+string VmTestScript::getTime(const Command& command) const
+{
+    return to_string(getMachine(command).getStepCount());
+}
+
+/// <summary>
+/// Runs repeat loops of vmstep commands as one run of the machine.
+/// </summary>
+bool VmTestScript::repeat(const Command& command, int count)
+{
+    bool isStepOnly = all_of(command.body.begin(), command.body.end(), [](const Command& bodyCommand)
+    {
+        return bodyCommand.body.empty() && bodyCommand.words.size() == 1 && bodyCommand.words[0] == "vmstep";
+    });
+    if (!isStepOnly)
+    {
+        return TestScript::repeat(command, count);
+    }
+    getMachine(command).run(static_cast<long long>(count) * static_cast<long long>(command.body.size()));
+    return true;
+}
+
+/// <summary>
+/// Returns the RAM address of "RAM[address]", a pointer, e.g. "sp", or an element of a segment, e.g. "local[2]".
+/// </summary>
+int VmTestScript::findAddress(const Command& command, const string& name) const
+{
+    auto bracket = name.find('[');
+    auto variableName = name.substr(0, bracket);
+    auto pointer = find(pointerNames.begin(), pointerNames.end(), variableName);
+    if (bracket == string::npos && pointer != pointerNames.end())
+    {
+        return static_cast<int>(pointer - pointerNames.begin());
+    }
+    if (bracket == string::npos || name.back() != ']')
+    {
+        fail(command, "Unknown variable " + name);
+    }
+
+    int index = parseNumber(command, name.substr(bracket + 1, name.size() - bracket - 2));
+    int address = variableName == "RAM" ? index
+        : variableName == "temp" ? 5 + index
+        : pointer != pointerNames.end() && pointer != pointerNames.begin()
+            ? getMachine(command).getRam(static_cast<int>(pointer - pointerNames.begin())) + index
+        : (fail(command, "Unknown variable " + name), 0);
+    if (address < 0 || address >= VirtualMachine::RAM_SIZE)
+    {
+        fail(command, "Address of " + name + " is out of range");
+    }
+    return address;
+}
+
+VirtualMachine& VmTestScript::getMachine(const Command& command) const
+{
+    if (!mMachine)
+    {
+        fail(command, "No program is loaded");
+    }
+    return *mMachine;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "VirtualMachine.h"
+#include "../HardwareSimulator/TestScript.h"
+
+/// <summary>
+/// VmTestScript executes a .tst script of the VMEmulator, scripts of other simulators and scripts loading
+///     a directory without .vm files are skipped.
+/// <para/> Variables are RAM[address], sp, local, argument, this, that and elements of the local, argument, this,
+///     that and temp segments, e.g. argument[1]. Repeat loops containing only vmstep commands run in the native
+///     loop of the machine.
+/// </summary>
+class VmTestScript : public TestScript
+{
+public:
+    /// <summary>
+    /// Parses the .tst file. May throw TestScriptError.
+    /// </summary>
+    explicit VmTestScript(const std::filesystem::path& path);
+
+    /// <summary>
+    /// Returns .vm files loaded by the last load command.
+    /// </summary>
+    const std::vector<std::filesystem::path>& getLoadedFiles() const;
+    /// <summary>
+    /// Returns the count of VM commands executed by all loaded programs.
+    /// </summary>
+    long long getStepCount() const;
+
+private:
+    bool load(const Command& command) override;
+    bool executeSimulatorCommand(const Command& command) override;
+    int readValue(const Command& command, const std::string& name, bool& isSigned) const override;
+    void writeValue(const Command& command, const std::string& name, int value) override;
+    std::string getTime(const Command& command) const override;
+    bool repeat(const Command& command, int count) override;
+
+    int findAddress(const Command& command, const std::string& name) const;
+    VirtualMachine& getMachine(const Command& command) const;
+
+    std::unique_ptr<VirtualMachine> mMachine;
+    std::vector<std::filesystem::path> mLoadedFiles;
+    long long mStepCount = 0;
+};
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "VMEmulatorError.h"
+#include "VmTestScript.h"
+#include "../Assembler/HackAssemblerError.h"
+#include "../CPUEmulator/CPUEmulatorError.h"
+#include "../CPUEmulator/CpuTestScript.h"
+#include "../HardwareSimulator/TestScriptError.h"
+#include "../VMTranslator/VMTranslator.h"
+#include "../VMTranslator/VMTranslatorError.h"
+
+namespace fs = std::filesystem;
+
+std::vector<fs::path> findScripts(const std::vector<fs::path>& inputPaths);
+bool runScripts(const std::vector<fs::path>& scriptPaths, bool isCrossChecked);
+ETestResult crossCheck(const fs::path& scriptPath, const std::vector<fs::path>& vmPaths, std::string& message);
+std::vector<uint16_t> translateProgram(const std::vector<fs::path>& vmPaths);
+const char* getResultName(ETestResult result);
+void printSpeed(long long stepCount, double milliseconds);
+
+int main(int argc, char* argv[])
+{
+    bool isCrossChecked = false;
+    std::vector<fs::path> inputPaths;
+    bool validArguments = argc >= 2;
+    for (int i = 1; i < argc && validArguments; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--cross-check")
+        {
+            isCrossChecked = true;
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            validArguments = false;
+        }
+        else
+        {
+            inputPaths.emplace_back(arg);
+        }
+    }
+
+    if (!validArguments || inputPaths.empty())
+    {
+        std::cout << "Usage: \n"
+            << "\tVMEmulator Script.tst|Directory... [--cross-check]\n"
+            << "\t--cross-check: translates the loaded .vm files by the VMTranslator and the HackAssembler and runs them\n"
+            << "\t\tby the CPU script of the test (Name.tst for NameVME.tst) on the CPU emulator\n";
+        return EXIT_FAILURE;
+    }
+
+    return runScripts(findScripts(inputPaths), isCrossChecked) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// <summary>
+/// Replaces directories with their .tst files.
+/// </summary>
+std::vector<fs::path> findScripts(const std::vector<fs::path>& inputPaths)
+{
+    std::vector<fs::path> paths;
+    for (const auto& inputPath : inputPaths)
+    {
+        if (!fs::is_directory(inputPath))
+        {
+            paths.push_back(inputPath);
+            continue;
+        }
+
+        std::vector<fs::path> directoryPaths;
+        for (const auto& entry : fs::directory_iterator(inputPath))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".tst")
+            {
+                directoryPaths.push_back(entry.path());
+            }
+        }
+        std::sort(directoryPaths.begin(), directoryPaths.end());
+        paths.insert(paths.end(), directoryPaths.begin(), directoryPaths.end());
+    }
+    return paths;
+}
+
+bool runScripts(const std::vector<fs::path>& scriptPaths, bool isCrossChecked)
+{
+    int passedCount = 0;
+    int failedCount = 0;
+    int skippedCount = 0;
+    long long totalStepCount = 0;
+    double totalMilliseconds = 0;
+    for (const auto& path : scriptPaths)
+    {
+        auto result = ETestResult::FAILED;
+        std::string message;
+        int outputCount = 0;
+        long long stepCount = 0;
+        std::vector<fs::path> vmPaths;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            auto script = VmTestScript(path);
+            result = script.run();
+            message = script.getMessage();
+            outputCount = script.getOutputCount();
+            stepCount = script.getStepCount();
+            vmPaths = script.getLoadedFiles();
+        }
+        catch (const TestScriptError& error)
+        {
+            message = error.what();
+        }
+        catch (const VMEmulatorError& error)
+        {
+            message = error.what();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        std::cout << std::left << std::setw(8) << getResultName(result) << path.string();
+        if (result == ETestResult::SKIPPED)
+        {
+            std::cout << " (not a VM test or no compiled .vm files)\n";
+            skippedCount++;
+            continue;
+        }
+        std::cout << ": " << outputCount << " outputs, ";
+        printSpeed(stepCount, milliseconds);
+        if (!message.empty())
+        {
+            std::cout << "\t" << message << "\n";
+        }
+
+        if (isCrossChecked && !vmPaths.empty())
+        {
+            std::string crossCheckMessage;
+            auto crossCheckResult = crossCheck(path, vmPaths, crossCheckMessage);
+            std::cout << "\tCross-check: " << getResultName(crossCheckResult) << " " << crossCheckMessage << "\n";
+            result = crossCheckResult == ETestResult::FAILED ? ETestResult::FAILED : result;
+        }
+
+        passedCount += result == ETestResult::PASSED;
+        failedCount += result != ETestResult::PASSED;
+        totalStepCount += stepCount;
+        totalMilliseconds += milliseconds;
+    }
+
+    std::cout << "\nPassed " << passedCount << ", failed " << failedCount << ", skipped " << skippedCount << " scripts.\nExecuted ";
+    printSpeed(totalStepCount, totalMilliseconds);
+    return failedCount == 0;
+}
+
+/// <summary>
+/// Runs the CPU script of the test (Name.tst for NameVME.tst) with the program translated from the .vm files.
+/// </summary>
+ETestResult crossCheck(const fs::path& scriptPath, const std::vector<fs::path>& vmPaths, std::string& message)
+{
+    auto name = scriptPath.stem().string();
+    if (name.size() <= 3 || name.compare(name.size() - 3, 3, "VME") != 0)
+    {
+        message = "(the script is not named NameVME.tst)";
+        return ETestResult::SKIPPED;
+    }
+    auto cpuScriptPath = scriptPath.parent_path() / (name.substr(0, name.size() - 3) + ".tst");
+    if (!fs::exists(cpuScriptPath))
+    {
+        message = "(" + cpuScriptPath.filename().string() + " does not exist)";
+        return ETestResult::SKIPPED;
+    }
+
+    auto result = ETestResult::FAILED;
+    try
+    {
+        auto script = CpuTestScript(cpuScriptPath);
+        script.setProgram(translateProgram(vmPaths));
+        result = script.run();
+        message = cpuScriptPath.filename().string() + ", " + std::to_string(script.getCycleCount()) + " clock cycles";
+        message += script.getMessage().empty() ? "" : ", " + script.getMessage();
+    }
+    catch (const TestScriptError& error)
+    {
+        message = error.what();
+    }
+    catch (const VMTranslatorError& error)
+    {
+        message = error.what();
+    }
+    catch (const assembler::HackAssemblerError& error)
+    {
+        message = error.what();
+    }
+    catch (const CPUEmulatorError& error)
+    {
+        message = error.what();
+    }
+    return result;
+}
+
+/// <summary>
+/// Translates the .vm files into machine instructions by the VMTranslator and the HackAssembler.
+/// </summary>
+std::vector<uint16_t> translateProgram(const std::vector<fs::path>& vmPaths)
+{
+    std::stringstream assemblyCode;
+    auto vmTranslator = VMTranslator(assemblyCode, false);
+    for (const auto& path : vmPaths)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            throw VMTranslatorError("Cannot open " + path.string() + " file.");
+        }
+        vmTranslator.parseStream(file, path.stem().string());
+    }
+    vmTranslator.writeFinalCode();
+    return HackComputer::assemble(assemblyCode, vmPaths.front().stem().string() + ".asm");
+}
+
+const char* getResultName(ETestResult result)
+{
+    switch (result)
+    {
+    case ETestResult::PASSED:
+        return "PASSED";
+    case ETestResult::SKIPPED:
+        return "SKIPPED";
+    default:
+        return "FAILED";
+    }
+}
+
+void printSpeed(long long stepCount, double milliseconds)
+{
+    std::cout << stepCount << " VM commands in " << std::fixed << std::setprecision(1) << milliseconds << " ms";
+    if (milliseconds > 0)
+    {
+        std::cout << " (" << std::setprecision(0) << stepCount / milliseconds * 1000 << " commands/s)";
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <set>
+#include <string>
+
+/// <summary>
+/// Assembly code of a single .vm file translated independently of the other files,
+///     together with the information needed to link it into the final .asm file.
+/// </summary>
+struct AssemblyFragment
+{
+    std::string code;
+    std::set<std::string, std::less<>> definedLabels;
+    std::set<std::string, std::less<>> usedLabels;
+    bool isComparisonUsed = false;
+    int comparisonCount = 0;
+};
@@ -5,23 +5,50 @@
 
 using namespace std;
 
+bool isInlineComparison(const TranslationOptions& options)
+{
+    return options.comparisons == EComparisonMode::INLINE
+        || (options.comparisons == EComparisonMode::DEFAULT && options.cacheTopOfStack);
+}
+
 /// <summary>
 /// Opens the output file and gets ready to write into it
 /// </summary>
 /// <param name="filename">Name of the output file</param>
 /// <param name="generateComment">Information if comment should be generated</param>
-CodeWriter::CodeWriter(const string& filename, bool generateComment)
-    : mGenerateComment(generateComment)
+CodeWriter::CodeWriter(const string& filename, bool generateComment, const TranslationOptions& options)
+    : mGenerateComment(generateComment),
+    mCacheTopOfStack(options.cacheTopOfStack),
+    mInlineComparisons(isInlineComparison(options))
 {
-    mOutputFile = make_unique<ofstream>(filename);
-    if (!mOutputFile->is_open())
+    mOwnedOutputFile = make_unique<ofstream>(filename);
+    if (!mOwnedOutputFile->is_open())
     {
         throw VMTranslatorError("Cannot find or open " + filename + " file.");
     }
+    mOutputFile = mOwnedOutputFile.get();
 
     initialCode();
 }
 
+/// <summary>
+/// Gets ready to write into the stream.
+/// </summary>
+/// <param name="outputStream">Stream for the assembly code</param>
+/// <param name="generateComment">Information if comment should be generated</param>
+/// <param name="writeInitialCode">False for fragments, which are linked by another CodeWriter</param>
+CodeWriter::CodeWriter(ostream& outputStream, bool generateComment, bool writeInitialCode, const TranslationOptions& options)
+    : mOutputFile(&outputStream),
+    mGenerateComment(generateComment),
+    mCacheTopOfStack(options.cacheTopOfStack),
+    mInlineComparisons(isInlineComparison(options))
+{
+    if (writeInitialCode)
+    {
+        initialCode();
+    }
+}
+
 /// <summary>
 /// Informs that the translation of a new VM file has started (called by VMTranslator).
 /// </summary>
@@ -42,6 +69,11 @@ void CodeWriter::writeArithmetic(const string& command)
         *mOutputFile << "\n// " << command << "\n";
     }
 
+    if (mIsTopInDRegister && writeCachedArithmetic(command))
+    {
+        return;
+    }
+
     if (command == "add")
     {
         const char* addCommand = 
@@ -141,6 +173,11 @@ void CodeWriter::writePushPop(ECommandType commandType, const string& segment, i
         throw VMTranslatorError("Method only allowed with C_PUSH or C_POP command.");
     }
 
+    if (commandType == ECommandType::C_PUSH)
+    {
+        writeCachedTop();
+    }
+
     if (segment == "local")
     {
         writeLocalArgThisThat(commandType, "LCL", index);
@@ -185,6 +222,8 @@ void CodeWriter::writePushPop(ECommandType commandType, const string& segment, i
 /// <param name="label">Label name</param>
 void CodeWriter::writeLabel(const string& label)
 {
+    writeCachedTop();
+
     if (mGenerateComment)
     {
         *mOutputFile << "\n// label " << label<< "\n";
@@ -215,6 +254,8 @@ void CodeWriter::writeLabel(const string& label)
 /// <param name="label">Label name</param>
 void CodeWriter::writeGoto(const string& label)
 {
+    writeCachedTop();
+
     if (mGenerateComment)
     {
         *mOutputFile << "\n// goto " << label << "\n";
@@ -243,7 +284,7 @@ void CodeWriter::writeIf(const string& label)
     auto fullName = this->getFullLabelName(label);
 
     *mOutputFile
-        << stack2DRegister()
+        << popDRegister()
         << "@" << fullName << "\n"
         << "D;JNE\n";
     
@@ -257,6 +298,8 @@ void CodeWriter::writeIf(const string& label)
 /// <param name="nVars">Count of the function local variables</param>
 void CodeWriter::writeFunction(const string& functionName, int nVars)
 {
+    writeCachedTop();
+
     if (mGenerateComment)
     {
         *mOutputFile << "\n// function " << functionName << " " << nVars << "\n";
@@ -290,12 +333,15 @@ void CodeWriter::writeFunction(const string& functionName, int nVars)
 /// <param name="nArgs">Count of the arguments that have been pushed onto the stack before the call</param>
 void CodeWriter::writeCall(const string& functionName, int nArgs)
 {
+    writeCachedTop();
+
     if (mGenerateComment)
     {
         *mOutputFile << "\n// call " << functionName << " " << nArgs << "\n";
     }
 
-    auto returnLabel = functionName + "$ret." + std::to_string(getNumber(functionName));
+    // numbered per caller, so that files can be translated independently
+    auto returnLabel = getFullLabelName("ret." + std::to_string(getNumber(getFullLabelName("ret"))));
 
     if (mDefinedLabels.count(returnLabel))
     {
@@ -407,16 +453,91 @@ A=M
 )";
 
     string returnString(returnCommand);
+    if (mIsTopInDRegister)
+    {
+        // the frame is restored with the D register, the returned value waits in R15
+        *mOutputFile
+            << "@R15\n"
+            << "M=D\n";
+        returnString = regex_replace(returnString, regex("stack2DRegister"), "@R15\nD=M");
+        mIsTopInDRegister = false;
+    }
     returnString = regex_replace(returnString, regex("stack2DRegister"), stack2DRegister());
     *mOutputFile << returnString;
 }
 
+/// <summary>
+/// Writes assembly code that effects the call of the current function immediately followed by the return.
+/// <para/> Arguments replace the arguments of the current call and the function starts again in the same frame.
+/// </summary>
+/// <param name="nArgs">Count of the arguments that have been pushed onto the stack before the call</param>
+void CodeWriter::writeTailCall(int nArgs)
+{
+    writeCachedTop();
+
+    if (mGenerateComment)
+    {
+        *mOutputFile << "\n// call " << mFunctionName << " " << nArgs << " (tail call)\n";
+    }
+
+    if (mNoFunctionDefined)
+    {
+        throw VMTranslatorError("Tail call outside of a function.");
+    }
+
+    // the last argument is on the top of the stack
+    for (int i = nArgs - 1; i >= 0; i--)
+    {
+        *mOutputFile
+            << stack2DRegister()
+            << "@ARG\n"
+            << (i == 0 ? "A=M\n" : "A=M+1\n");
+        for (int j = 1; j < i; j++)
+        {
+            *mOutputFile << "A=A+1\n";
+        }
+        *mOutputFile << "M=D\n";
+    }
+
+    // the function command pushes local variables again
+    *mOutputFile
+        << "@LCL\n"
+        << "D=M\n"
+        << "@SP\n"
+        << "M=D\n"
+        << "@" << mFunctionName << "\n"
+        << "0;JMP\n";
+}
+
+/// <summary>
+/// Writes the top of the stack kept in the D register into memory.
+/// Called at the end of the code, which is linked by another CodeWriter.
+/// </summary>
+void CodeWriter::writeCachedTop()
+{
+    if (mIsTopInDRegister)
+    {
+        *mOutputFile << DRegister2Stack();
+        mIsTopInDRegister = false;
+    }
+}
+
+/// <summary>
+/// Returns count of eq, gt and lt commands written so far, including linked fragments.
+/// </summary>
+int CodeWriter::getComparisonCount() const
+{
+    return mComparisonCount;
+}
+
 /// <summary>
 /// Validates if every label used in goto and if-goto is defined.
 /// Adjusts code at the end of the file.
 /// </summary>
 void CodeWriter::writeFinalCode()
 {
+    writeCachedTop();
+
     for (const auto& labelName : mDefinedGoto)
     {
         if (!mDefinedLabels.count(labelName))
@@ -475,6 +596,41 @@ A=M
     }
 }
 
+/// <summary>
+/// Writes assembly code translated by another CodeWriter and takes over its labels.
+/// </summary>
+void CodeWriter::writeFragment(const AssemblyFragment& fragment)
+{
+    writeCachedTop();
+
+    for (const auto& label : fragment.definedLabels)
+    {
+        if (mDefinedLabels.count(label))
+        {
+            throw VMTranslatorError("Duplicated labels " + label);
+        }
+    }
+
+    *mOutputFile << fragment.code;
+    mDefinedLabels.insert(fragment.definedLabels.begin(), fragment.definedLabels.end());
+    mDefinedGoto.insert(fragment.usedLabels.begin(), fragment.usedLabels.end());
+    mIsComparisonUsed = mIsComparisonUsed || fragment.isComparisonUsed;
+    mComparisonCount += fragment.comparisonCount;
+}
+
+/// <summary>
+/// Returns labels defined and used so far, without the code.
+/// </summary>
+AssemblyFragment CodeWriter::getLinkInfo() const
+{
+    AssemblyFragment fragment;
+    fragment.definedLabels = mDefinedLabels;
+    fragment.usedLabels = mDefinedGoto;
+    fragment.isComparisonUsed = mIsComparisonUsed;
+    fragment.comparisonCount = mComparisonCount;
+    return fragment;
+}
+
 void CodeWriter::initialCode()
 {
     const char* initCode =
@@ -492,6 +648,14 @@ M=D
 
 void CodeWriter::writeComparisonCommand(const string& comparisonCheck)
 {
+    mComparisonCount++;
+    if (mInlineComparisons)
+    {
+        writeInlineComparison(comparisonCheck);
+        return;
+    }
+
+    writeCachedTop();
     mIsComparisonUsed = true;
 
     const char* comparisonCommand =
@@ -512,7 +676,113 @@ COMPARISON_CHECK
 (AFTER_CONDITION)
 )";
     string comparisonString(comparisonCommand);
-    comparisonString = regex_replace(comparisonString, regex("AFTER_CONDITION"), string("AFTER_CONDITION.") + to_string(getNumber("AFTER_CONDITION")));
+    auto afterLabel = getFullLabelName("AFTER_CONDITION." + to_string(getNumber(getFullLabelName("AFTER_CONDITION"))));
+    comparisonString = regex_replace(comparisonString, regex("AFTER_CONDITION"), afterLabel);
+    comparisonString = regex_replace(comparisonString, regex("COMPARISON_CHECK"), comparisonCheck);
+    *mOutputFile << comparisonString;
+}
+
+// the D register holds the only or the second operand, the result is left in it
+bool CodeWriter::writeCachedArithmetic(const string& command)
+{
+    if (command == "add")
+    {
+        *mOutputFile
+            << "@SP\n"
+            << "AM=M-1\n"
+            << "D=M+D\n";
+    }
+    else if (command == "sub")
+    {
+        *mOutputFile
+            << "@SP\n"
+            << "AM=M-1\n"
+            << "D=M-D\n";
+    }
+    else if (command == "neg")
+    {
+        *mOutputFile << "D=-D\n";
+    }
+    else if (command == "and")
+    {
+        *mOutputFile
+            << "@SP\n"
+            << "AM=M-1\n"
+            << "D=M&D\n";
+    }
+    else if (command == "or")
+    {
+        *mOutputFile
+            << "@SP\n"
+            << "AM=M-1\n"
+            << "D=M|D\n";
+    }
+    else if (command == "not")
+    {
+        *mOutputFile << "D=!D\n";
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// the result replaces the operands in memory or, with cached top of the stack, it is left in the D register
+void CodeWriter::writeInlineComparison(const string& comparisonCheck)
+{
+    auto number = to_string(getNumber(getFullLabelName("cmp")));
+    auto trueLabel = getFullLabelName("cmp." + number + ".true");
+    auto endLabel = getFullLabelName("cmp." + number + ".end");
+
+    if (mDefinedLabels.count(trueLabel) || mDefinedLabels.count(endLabel))
+    {
+        throw VMTranslatorError("Duplicated labels " + trueLabel);
+    }
+
+    // the shared code needs the D register for the return address, the inline code does not
+    const char* cachedComparisonCommand =
+R"(@SP
+AM=M-1
+D=M-D
+@TRUE_LABEL
+COMPARISON_CHECK
+D=0
+@END_LABEL
+0;JMP
+(TRUE_LABEL)
+D=-1
+(END_LABEL)
+)";
+    const char* comparisonCommand =
+R"(@SP
+AM=M-1
+D=M
+A=A-1
+D=M-D
+M=-1
+@END_LABEL
+COMPARISON_CHECK
+@SP
+A=M-1
+M=0
+(END_LABEL)
+)";
+
+    string comparisonString;
+    if (mCacheTopOfStack)
+    {
+        *mOutputFile << popDRegister();
+        comparisonString = cachedComparisonCommand;
+        mIsTopInDRegister = true;
+    }
+    else
+    {
+        comparisonString = comparisonCommand;
+    }
+
+    comparisonString = regex_replace(comparisonString, regex("TRUE_LABEL"), trueLabel);
+    comparisonString = regex_replace(comparisonString, regex("END_LABEL"), endLabel);
     comparisonString = regex_replace(comparisonString, regex("COMPARISON_CHECK"), comparisonCheck);
     *mOutputFile << comparisonString;
 }
@@ -533,10 +803,26 @@ D=M
         pushString = regex_replace(pushString, regex("SEGMENT_NAME"), segmentName);
         *mOutputFile 
             << pushString 
-            << DRegister2Stack();
+            << pushDRegister();
     }
     else if (commandType == ECommandType::C_POP)
     {
+        // close addresses are reached by increments, so the value can stay in the D register
+        if (mIsTopInDRegister && index <= 6)
+        {
+            *mOutputFile
+                << "@" << segmentName << "\n"
+                << "A=M\n";
+            for (int i = 0; i < index; i++)
+            {
+                *mOutputFile << "A=A+1\n";
+            }
+            *mOutputFile << "M=D\n";
+            mIsTopInDRegister = false;
+            return;
+        }
+        writeCachedTop();
+
         const char* address2temp =
 R"(@INDEX
 D=A
@@ -574,12 +860,12 @@ void CodeWriter::writePointer(ECommandType commandType, int index)
         *mOutputFile
             << "@" << segmentName << "\n"
             << "D=M\n"
-            << DRegister2Stack();
+            << pushDRegister();
     }
     else if (commandType == ECommandType::C_POP)
     {
         *mOutputFile
-            << stack2DRegister()
+            << popDRegister()
             << "@" << segmentName << "\n"
             << "M=D\n";
     }
@@ -598,12 +884,12 @@ void CodeWriter::writeTemp(ECommandType commandType, int index)
         *mOutputFile
             << "@R" << tempIndex << "\n"
             << "D=M\n"
-            << DRegister2Stack();
+            << pushDRegister();
     }
     else if (commandType == ECommandType::C_POP)
     {
         *mOutputFile
-            << stack2DRegister()
+            << popDRegister()
             << "@R" << tempIndex << "\n"
             << "M=D\n";
     }
@@ -621,7 +907,7 @@ void CodeWriter::writeConstant(ECommandType commandType, int index)
         *mOutputFile
             << "@" << index << "\n"
             << "D=A\n"
-            << DRegister2Stack();
+            << pushDRegister();
     }
     else if (commandType == ECommandType::C_POP)
     {
@@ -636,12 +922,12 @@ void CodeWriter::writeStatic(ECommandType commandType, int index)
         *mOutputFile
             << "@"<< mFileName << "." << index << "\n"
             << "D=M\n"
-            << DRegister2Stack();
+            << pushDRegister();
     }
     else if (commandType == ECommandType::C_POP)
     {
         *mOutputFile
-            << stack2DRegister()
+            << popDRegister()
             << "@" << mFileName << "." << index << "\n"
             << "M=D\n";
     }
@@ -707,3 +993,25 @@ int CodeWriter::getNumber(const string& label)
     mCountersMap.insert_or_assign(label, newValue);
     return newValue;
 }
+
+// pushes the D register, with cacheTopOfStack it only becomes the top of the stack
+string CodeWriter::pushDRegister()
+{
+    if (mCacheTopOfStack)
+    {
+        mIsTopInDRegister = true;
+        return "";
+    }
+    return DRegister2Stack();
+}
+
+// pops the top of the stack into the D register, if it is not already there
+string CodeWriter::popDRegister()
+{
+    if (mIsTopInDRegister)
+    {
+        mIsTopInDRegister = false;
+        return "";
+    }
+    return stack2DRegister();
+}
@@ -1,9 +1,13 @@
 #pragma once
 #include <fstream>
+#include <memory>
+#include <ostream>
 #include <unordered_map>
 #include <set>
 #include <string>
+#include "AssemblyFragment.h"
 #include "ECommandType.h"
+#include "TranslationOptions.h"
 
 /// <summary>
 /// The module translates a parsed VM command into Hack assembly code.
@@ -15,7 +19,14 @@ public:
     /// Opens the output file and gets ready to write into it
     /// </summary>
     /// <param name="filename">Name of the output file</param>
-    CodeWriter(const std::string& filename, bool generateComment);
+    CodeWriter(const std::string& filename, bool generateComment, const TranslationOptions& options = TranslationOptions());
+    /// <summary>
+    /// Gets ready to write into the stream.
+    /// </summary>
+    /// <param name="outputStream">Stream for the assembly code</param>
+    /// <param name="writeInitialCode">False for fragments, which are linked by another CodeWriter</param>
+    CodeWriter(std::ostream& outputStream, bool generateComment, bool writeInitialCode = true,
+        const TranslationOptions& options = TranslationOptions());
 
     /// <summary>
     /// Informs that the translation of a new VM file has started (called by VMTranslator).
@@ -66,15 +77,40 @@ public:
     /// </summary>
     void writeReturn();
     /// <summary>
+    /// Writes assembly code that effects the call of the current function immediately followed by the return.
+    /// <para/> Arguments replace the arguments of the current call and the function starts again in the same frame.
+    /// </summary>
+    /// <param name="nArgs">Count of the arguments that have been pushed onto the stack before the call</param>
+    void writeTailCall(int nArgs);
+    /// <summary>
+    /// Writes the top of the stack kept in the D register into memory.
+    /// Called at the end of the code, which is linked by another CodeWriter.
+    /// </summary>
+    void writeCachedTop();
+    /// <summary>
+    /// Returns count of eq, gt and lt commands written so far, including linked fragments.
+    /// </summary>
+    int getComparisonCount() const;
+    /// <summary>
     /// Validates if every label used in goto and if-goto is defined.
     /// Adjusts code at the end of the file.
     /// </summary>
     void writeFinalCode();
+    /// <summary>
+    /// Writes assembly code translated by another CodeWriter and takes over its labels.
+    /// </summary>
+    void writeFragment(const AssemblyFragment& fragment);
+    /// <summary>
+    /// Returns labels defined and used so far, without the code.
+    /// </summary>
+    AssemblyFragment getLinkInfo() const;
 
 private:
     void initialCode();
 
     void writeComparisonCommand(const std::string& comparisonCheck);
+    bool writeCachedArithmetic(const std::string& command);
+    void writeInlineComparison(const std::string& comparisonCheck);
 
     void writeLocalArgThisThat(ECommandType commandType, const std::string& segmentName, int index);
     void writePointer(ECommandType commandType, int index);
@@ -87,13 +123,22 @@ private:
 
     std::string stack2DRegister() const;
     std::string DRegister2Stack() const;
+    std::string pushDRegister();
+    std::string popDRegister();
     int getNumber(const std::string& label);
 
-    std::unique_ptr<std::ofstream> mOutputFile;
+    std::unique_ptr<std::ofstream> mOwnedOutputFile;
+    std::ostream* mOutputFile = nullptr;
     bool mGenerateComment = false;
 
+    // with cacheTopOfStack the top of the stack may be kept in the D register instead of memory
+    bool mCacheTopOfStack = false;
+    bool mIsTopInDRegister = false;
+
     std::unordered_map<std::string, int> mCountersMap;
     bool mIsComparisonUsed = false;
+    bool mInlineComparisons = false;
+    int mComparisonCount = 0;
 
     std::set<std::string, std::less<>> mDefinedLabels;
     std::set<std::string, std::less<>> mDefinedGoto;
@@ -0,0 +1,8 @@
+#pragma once
+
+enum class EComparisonMode
+{
+    DEFAULT = 0,
+    SHARED = 1,
+    INLINE = 2
+};
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <set>
+#include "FunctionInliner.h"
+
+using namespace std;
+
+// static variables are placed in RAM[16..255]
+constexpr int STATIC_VARIABLE_COUNT = 240;
+
+bool isBinaryCommand(const string& command)
+{
+    return command != "neg" && command != "not";
+}
+
+/// <summary>
+/// Creates FunctionInliner for the whole program.
+/// </summary>
+FunctionInliner::FunctionInliner(vector<VMCommand> program)
+    : mProgram(std::move(program))
+{
+}
+
+/// <summary>
+/// Returns the program with inlined calls.
+/// </summary>
+vector<VMCommand> FunctionInliner::run()
+{
+    vector<string> functionNames;
+    set<pair<string, int>> staticVariables;
+    for (size_t i = 0; i < mProgram.size(); i++)
+    {
+        const auto& command = mProgram[i];
+        if (command.type == ECommandType::C_FUNCTION)
+        {
+            if (!functionNames.empty())
+            {
+                mFunctions[functionNames.back()].end = i;
+            }
+            // duplicated functions are reported by the CodeWriter
+            auto& function = mFunctions[command.arg1];
+            function.begin = i;
+            function.localCount = command.arg2;
+            functionNames.push_back(command.arg1);
+        }
+        if ((command.type == ECommandType::C_PUSH || command.type == ECommandType::C_POP) && command.arg1 == "static")
+        {
+            staticVariables.emplace(command.fileName, command.arg2);
+        }
+    }
+    if (functionNames.empty())
+    {
+        return mProgram;
+    }
+    mFunctions[functionNames.back()].end = mProgram.size();
+    mFreeStaticCount = STATIC_VARIABLE_COUNT - static_cast<int>(staticVariables.size());
+
+    for (const auto& command : mProgram)
+    {
+        if (auto it = mFunctions.find(command.arg1); command.type == ECommandType::C_CALL && it != mFunctions.end())
+        {
+            it->second.argumentCount = max(it->second.argumentCount, command.arg2);
+        }
+    }
+    for (const auto& name : functionNames)
+    {
+        analyze(mFunctions[name]);
+    }
+
+    // code before the first function is kept as it is, its calls keep their callees
+    vector<VMCommand> prologue(mProgram.begin(), mProgram.begin() + mFunctions[functionNames.front()].begin);
+    for (const auto& command : prologue)
+    {
+        if (auto it = mFunctions.find(command.arg1); command.type == ECommandType::C_CALL && it != mFunctions.end())
+        {
+            it->second.remainingCallCount++;
+        }
+    }
+    vector<vector<VMCommand>> functionCodes;
+    for (const auto& name : functionNames)
+    {
+        const auto& function = mFunctions[name];
+        auto& output = functionCodes.emplace_back();
+        int inlinedCount = 0;
+
+        for (size_t i = function.begin; i < function.end; i++)
+        {
+            const auto& command = mProgram[i];
+            auto it = command.type == ECommandType::C_CALL ? mFunctions.find(command.arg1) : mFunctions.end();
+            if (it == mFunctions.end())
+            {
+                output.push_back(command);
+                continue;
+            }
+
+            auto& callee = it->second;
+            // the callee would read the frame of the caller
+            if (!callee.isInlinable || command.arg2 < callee.accessedArgumentCount)
+            {
+                callee.remainingCallCount++;
+                output.push_back(command);
+                continue;
+            }
+
+            writeInlinedCall(output, command, inlinedCount++);
+            mInlinedCallCount++;
+        }
+    }
+
+    bool isStartedBySysInit = mFunctions.count("Sys.init") > 0;
+    vector<VMCommand> result = std::move(prologue);
+    for (size_t i = 0; i < functionNames.size(); i++)
+    {
+        const auto& function = mFunctions[functionNames[i]];
+        if (isStartedBySysInit && function.isInlinable && function.remainingCallCount == 0 && functionNames[i] != "Sys.init")
+        {
+            mRemovedFunctionCount++;
+            continue;
+        }
+        result.insert(result.end(), functionCodes[i].begin(), functionCodes[i].end());
+    }
+    return result;
+}
+
+int FunctionInliner::getInlinedFunctionCount() const
+{
+    return mInlinedFunctionCount;
+}
+
+int FunctionInliner::getInlinedCallCount() const
+{
+    return mInlinedCallCount;
+}
+
+int FunctionInliner::getRemovedFunctionCount() const
+{
+    return mRemovedFunctionCount;
+}
+
+void FunctionInliner::analyze(Function& function)
+{
+    int size = 0;
+    bool hasLabels = false;
+    function.isLocalInitialized.assign(function.localCount, false);
+    vector<bool> isLocalAccessed(function.localCount, false);
+    vector<int> argumentReadCount;
+
+    for (size_t i = function.begin + 1; i < function.end; i++)
+    {
+        const auto& command = mProgram[i];
+        switch (command.type)
+        {
+        case ECommandType::C_CALL:
+        case ECommandType::C_FUNCTION:
+            return;
+        case ECommandType::C_LABEL:
+            hasLabels = true;
+            continue;
+        case ECommandType::C_RETURN:
+            function.isReturnedInside = function.isReturnedInside || i + 1 != function.end;
+            break;
+        case ECommandType::C_PUSH:
+        case ECommandType::C_POP:
+            if (command.arg1 == "argument")
+            {
+                if (command.arg2 < 0)
+                {
+                    return;
+                }
+                function.accessedArgumentCount = max(function.accessedArgumentCount, command.arg2 + 1);
+                argumentReadCount.resize(function.accessedArgumentCount);
+                argumentReadCount[command.arg2] += command.type == ECommandType::C_PUSH ? 1 : 2;
+            }
+            else if (command.arg1 == "local")
+            {
+                if (command.arg2 < 0 || command.arg2 >= function.localCount)
+                {
+                    return;
+                }
+                // a local variable written before it is read does not need the initial 0
+                if (!isLocalAccessed[command.arg2])
+                {
+                    isLocalAccessed[command.arg2] = true;
+                    function.isLocalInitialized[command.arg2] = command.type == ECommandType::C_POP;
+                }
+            }
+            else if (command.arg1 == "pointer" && command.type == ECommandType::C_POP)
+            {
+                function.setsThis = function.setsThis || command.arg2 == 0;
+                function.setsThat = function.setsThat || command.arg2 == 1;
+            }
+            break;
+        default:
+            break;
+        }
+        size++;
+    }
+
+    for (int i = 0; i < function.localCount; i++)
+    {
+        // with jumps the first command in the code may be executed later, unused variables need no value
+        function.isLocalInitialized[i] = isLocalAccessed[i] ? function.isLocalInitialized[i] && !hasLabels : true;
+    }
+
+    int staticCount = function.argumentCount + function.localCount + function.setsThis + function.setsThat;
+    if (size > MAX_FUNCTION_SIZE || staticCount > mFreeStaticCount || !hasBalancedStack(function))
+    {
+        return;
+    }
+
+    const auto& firstCommand = mProgram[function.begin + 1];
+    if (firstCommand.type == ECommandType::C_PUSH && firstCommand.arg1 == "argument" && argumentReadCount[firstCommand.arg2] == 1)
+    {
+        function.stackArgument = firstCommand.arg2;
+    }
+
+    function.isInlinable = true;
+    mFreeStaticCount -= staticCount;
+    mInlinedFunctionCount++;
+}
+
+/// <summary>
+/// Checks, whether the function never reads below its own operand stack, the stack has the same depth
+///     on all paths to a label and every return leaves exactly the returned value.
+/// </summary>
+bool FunctionInliner::hasBalancedStack(const Function& function) const
+{
+    auto begin = function.begin + 1;
+    auto size = function.end - begin;
+
+    unordered_map<string, size_t> labels;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (mProgram[begin + i].type == ECommandType::C_LABEL)
+        {
+            labels[mProgram[begin + i].arg1] = i;
+        }
+    }
+
+    // operand stack depth before the command, -1 for commands not reached yet
+    vector<int> depths(size, -1);
+    vector<size_t> pending;
+    auto reach = [&](size_t index, int depth)
+    {
+        if (index >= size || (depths[index] != -1 && depths[index] != depth))
+        {
+            return false;
+        }
+        if (depths[index] == -1)
+        {
+            depths[index] = depth;
+            pending.push_back(index);
+        }
+        return true;
+    };
+
+    if (size == 0 || !reach(0, 0))
+    {
+        return false;
+    }
+
+    while (!pending.empty())
+    {
+        auto index = pending.back();
+        pending.pop_back();
+        const auto& command = mProgram[begin + index];
+        auto depth = depths[index];
+
+        int popped = 0;
+        int pushed = 0;
+        bool isFallingThrough = true;
+        switch (command.type)
+        {
+        case ECommandType::C_PUSH:
+            pushed = 1;
+            break;
+        case ECommandType::C_POP:
+            popped = 1;
+            break;
+        case ECommandType::C_ARITHMETIC:
+            popped = isBinaryCommand(command.arg1) ? 2 : 1;
+            pushed = 1;
+            break;
+        case ECommandType::C_IF:
+            popped = 1;
+            [[fallthrough]];
+        case ECommandType::C_GOTO:
+        {
+            auto it = labels.find(command.arg1);
+            if (depth < popped || it == labels.end() || !reach(it->second, depth - popped))
+            {
+                return false;
+            }
+            isFallingThrough = command.type == ECommandType::C_IF;
+            break;
+        }
+        case ECommandType::C_RETURN:
+            if (depth != 1)
+            {
+                return false;
+            }
+            isFallingThrough = false;
+            break;
+        default:
+            break;
+        }
+
+        if (depth < popped)
+        {
+            return false;
+        }
+        if (isFallingThrough && !reach(index + 1, depth - popped + pushed))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FunctionInliner::writeInlinedCall(vector<VMCommand>& output, const VMCommand& call, int inlineNumber)
+{
+    const auto& callee = mFunctions[call.arg1];
+    auto staticFileName = call.arg1 + "$inline";
+    auto labelPrefix = "inline." + to_string(inlineNumber) + ".";
+    auto returnLabel = "inline." + to_string(inlineNumber) + ":return";
+    auto write = [&](ECommandType type, const string& arg1, int arg2, const string& fileName)
+    {
+        output.push_back(VMCommand{ type, arg1, arg2, fileName });
+    };
+
+    int localBase = callee.argumentCount;
+    int thisIndex = localBase + callee.localCount;
+    int thatIndex = thisIndex + callee.setsThis;
+    // the only argument may stay on the stack, if it is pushed by the first command
+    bool isArgumentOnStack = callee.stackArgument == 0 && call.arg2 == 1;
+
+    for (int i = isArgumentOnStack ? -1 : call.arg2 - 1; i >= 0; i--)
+    {
+        write(ECommandType::C_POP, "static", i, staticFileName);
+    }
+    for (int i = 0; i < callee.localCount; i++)
+    {
+        if (!callee.isLocalInitialized[i])
+        {
+            write(ECommandType::C_PUSH, "constant", 0, call.fileName);
+            write(ECommandType::C_POP, "static", localBase + i, staticFileName);
+        }
+    }
+    if (callee.setsThis)
+    {
+        write(ECommandType::C_PUSH, "pointer", 0, call.fileName);
+        write(ECommandType::C_POP, "static", thisIndex, staticFileName);
+    }
+    if (callee.setsThat)
+    {
+        write(ECommandType::C_PUSH, "pointer", 1, call.fileName);
+        write(ECommandType::C_POP, "static", thatIndex, staticFileName);
+    }
+
+    for (size_t i = callee.begin + 1 + (isArgumentOnStack ? 1 : 0); i < callee.end; i++)
+    {
+        auto command = mProgram[i];
+        switch (command.type)
+        {
+        case ECommandType::C_PUSH:
+        case ECommandType::C_POP:
+            if (command.arg1 == "argument" || command.arg1 == "local")
+            {
+                command.arg2 += command.arg1 == "local" ? localBase : 0;
+                command.arg1 = "static";
+                command.fileName = staticFileName;
+            }
+            break;
+        case ECommandType::C_LABEL:
+        case ECommandType::C_GOTO:
+        case ECommandType::C_IF:
+            command.arg1 = labelPrefix + command.arg1;
+            break;
+        case ECommandType::C_RETURN:
+            if (i + 1 == callee.end)
+            {
+                continue;
+            }
+            command = VMCommand{ ECommandType::C_GOTO, returnLabel, -1, call.fileName };
+            break;
+        default:
+            break;
+        }
+        output.push_back(command);
+    }
+
+    if (callee.isReturnedInside)
+    {
+        write(ECommandType::C_LABEL, returnLabel, -1, call.fileName);
+    }
+    if (callee.setsThat)
+    {
+        write(ECommandType::C_PUSH, "static", thatIndex, staticFileName);
+        write(ECommandType::C_POP, "pointer", 1, call.fileName);
+    }
+    if (callee.setsThis)
+    {
+        write(ECommandType::C_PUSH, "static", thisIndex, staticFileName);
+        write(ECommandType::C_POP, "pointer", 0, call.fileName);
+    }
+}
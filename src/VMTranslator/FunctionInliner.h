@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "VMCommand.h"
+
+/// <summary>
+/// FunctionInliner replaces calls of small leaf functions with their bodies in the whole program.
+/// <para/> Arguments and local variables of the inlined function are moved to static variables of the separate
+///     "FunctionName$inline" file. THIS and THAT changed by the function are restored after its body.
+/// <para/> Functions, whose all calls were inlined, are removed if the program is started by Sys.init.
+/// </summary>
+class FunctionInliner
+{
+public:
+    /// <summary>
+    /// Maximal count of commands of the inlined function, labels are not counted.
+    /// </summary>
+    static constexpr int MAX_FUNCTION_SIZE = 40;
+
+    /// <summary>
+    /// Creates FunctionInliner for the whole program.
+    /// </summary>
+    explicit FunctionInliner(std::vector<VMCommand> program);
+
+    /// <summary>
+    /// Returns the program with inlined calls.
+    /// </summary>
+    std::vector<VMCommand> run();
+
+    int getInlinedFunctionCount() const;
+    int getInlinedCallCount() const;
+    int getRemovedFunctionCount() const;
+
+private:
+    struct Function
+    {
+        size_t begin = 0;
+        size_t end = 0;
+        int localCount = 0;
+        // the largest argument count of the calls, every argument needs a static variable
+        int argumentCount = 0;
+        int accessedArgumentCount = 0;
+        bool isInlinable = false;
+        bool setsThis = false;
+        bool setsThat = false;
+        bool isReturnedInside = false;
+        // argument read only by the first command, it can stay on the stack
+        int stackArgument = -1;
+        std::vector<bool> isLocalInitialized;
+        int remainingCallCount = 0;
+    };
+
+    void analyze(Function& function);
+    bool hasBalancedStack(const Function& function) const;
+    void writeInlinedCall(std::vector<VMCommand>& output, const VMCommand& call, int inlineNumber);
+
+    std::vector<VMCommand> mProgram;
+    std::unordered_map<std::string, Function> mFunctions;
+    int mFreeStaticCount = 0;
+
+    int mInlinedFunctionCount = 0;
+    int mInlinedCallCount = 0;
+    int mRemovedFunctionCount = 0;
+};
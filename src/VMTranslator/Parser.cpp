@@ -58,11 +58,21 @@ vector<string> split(const string& s, char delim)
 /// <param name="filename">Name of the input file</param>
 Parser::Parser(const string& filename)
 {
-    mInputStream = make_unique<ifstream>(filename);
-    if (!mInputStream->is_open())
+    mInputFile = make_unique<ifstream>(filename);
+    if (!mInputFile->is_open())
     {
         throw VMTranslatorError("Cannot open " + filename + " file");
     }
+    mInputStream = mInputFile.get();
+}
+
+/// <summary>
+/// Gets ready to parse VM code from the stream.
+/// </summary>
+/// <param name="inputStream">Stream with VM code</param>
+Parser::Parser(istream& inputStream)
+    : mInputStream(&inputStream)
+{
 }
 
 /// <summary>
@@ -1,5 +1,7 @@
 #pragma once
 #include <fstream>
+#include <istream>
+#include <memory>
 #include <string>
 #include "ECommandType.h"
 
@@ -15,6 +17,11 @@ public:
     /// </summary>
     /// <param name="filename">Name of the input file</param>
     explicit Parser(const std::string& filename);
+    /// <summary>
+    /// Gets ready to parse VM code from the stream.
+    /// </summary>
+    /// <param name="inputStream">Stream with VM code</param>
+    explicit Parser(std::istream& inputStream);
 
     /// <summary>
     /// Are there more lines in the input?
@@ -44,7 +51,8 @@ public:
     int arg2() const;
 
 private:
-    std::unique_ptr<std::ifstream> mInputStream;
+    std::unique_ptr<std::ifstream> mInputFile;
+    std::istream* mInputStream = nullptr;
     
     std::string mCurrentLine = "";
     ECommandType mCommandType = ECommandType::UNDEFINED;
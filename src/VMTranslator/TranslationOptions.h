@@ -0,0 +1,27 @@
+#pragma once
+#include "EComparisonMode.h"
+
+/// <summary>
+/// Selects optimizations of the VMTranslator. All of them are disabled by default,
+///     so the generated code is the same as without options.
+/// </summary>
+struct TranslationOptions
+{
+    /// <summary>
+    /// Parses all files first and replaces calls of small leaf functions with their bodies.
+    /// </summary>
+    bool inlineFunctions = false;
+    /// <summary>
+    /// Replaces the call of the current function immediately followed by the return with a jump to its beginning.
+    /// </summary>
+    bool tailCalls = false;
+    /// <summary>
+    /// Keeps the top of the stack in the D register between commands and writes it into memory only when needed.
+    /// </summary>
+    bool cacheTopOfStack = false;
+    /// <summary>
+    /// Selects, whether eq, gt and lt jump to the code shared by the whole program or are written inline.
+    /// By default comparisons are shared, unless the top of the stack is cached.
+    /// </summary>
+    EComparisonMode comparisons = EComparisonMode::DEFAULT;
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include "ECommandType.h"
+
+/// <summary>
+/// Single parsed VM command, used when the whole program is transformed before the translation.
+/// </summary>
+struct VMCommand
+{
+    ECommandType type = ECommandType::UNDEFINED;
+    std::string arg1;
+    int arg2 = -1;
+    /// <summary>
+    /// Name of the .vm file containing the command, static variables belong to it.
+    /// </summary>
+    std::string fileName;
+};
@@ -1,5 +1,7 @@
 #include <iostream>
 #include <filesystem>
+#include <sstream>
+#include "FunctionInliner.h"
 #include "Parser.h"
 #include "VMTranslator.h"
 #include "VMTranslatorError.h"
@@ -7,7 +9,8 @@
 using namespace std;
 namespace fs = std::filesystem;
 
-VMTranslator::VMTranslator(const string& path)
+VMTranslator::VMTranslator(const string& path, const TranslationOptions& options)
+    : mOptions(options)
 {
     fs::path filePath = path;
     fs::path inputPath = filePath.is_relative()
@@ -39,7 +42,13 @@ VMTranslator::VMTranslator(const string& path)
         throw VMTranslatorError("Input file " + string(path) + " doesn't have .vm extension");
     }
 
-    mCodeWriter = make_unique<CodeWriter>(mOutputFileName, true);
+    mCodeWriter = make_unique<CodeWriter>(mOutputFileName, true, mOptions);
+}
+
+VMTranslator::VMTranslator(ostream& outputStream, bool generateComment, const TranslationOptions& options)
+    : mOptions(options)
+{
+    mCodeWriter = make_unique<CodeWriter>(outputStream, generateComment, true, mOptions);
 }
 
 bool VMTranslator::isDirectoryPath() const
@@ -73,7 +82,7 @@ void VMTranslator::parseDirectory()
         parseSingleFile(vmFile);
     }
 
-    mCodeWriter->writeFinalCode();
+    writeFinalCode();
 }
 
 void VMTranslator::parseSingleFile()
@@ -85,7 +94,7 @@ void VMTranslator::parseSingleFile()
 
     parseSingleFile(mInputFileName);
 
-    mCodeWriter->writeFinalCode();
+    writeFinalCode();
 }
 
 string VMTranslator::getOutputFile() const
@@ -93,11 +102,89 @@ string VMTranslator::getOutputFile() const
     return mOutputFileName;
 }
 
+void VMTranslator::parseStream(istream& inputStream, const string& fileName)
+{
+    auto parser = Parser(inputStream);
+    parse(parser, fileName);
+}
+
+void VMTranslator::writeFinalCode()
+{
+    if (mOptions.inlineFunctions)
+    {
+        auto functionInliner = FunctionInliner(std::move(mCommands));
+        auto commands = functionInliner.run();
+        mCommands.clear();
+
+        mOptimizationReport = "Inlined " + to_string(functionInliner.getInlinedCallCount()) + " calls of "
+            + to_string(functionInliner.getInlinedFunctionCount()) + " leaf functions, removed "
+            + to_string(functionInliner.getRemovedFunctionCount()) + " functions.";
+
+        for (const auto& command : commands)
+        {
+            mCodeWriter->setFileName(command.fileName);
+            writeCommand(command);
+        }
+        writePendingCall();
+    }
+
+    if (mTailCallCount > 0)
+    {
+        mOptimizationReport += mOptimizationReport.empty() ? "" : " ";
+        mOptimizationReport += "Replaced " + to_string(mTailCallCount) + " tail calls with jumps.";
+    }
+
+    if (mOptions.comparisons != EComparisonMode::DEFAULT)
+    {
+        // ROM words and executed cycles of a single comparison, cached top of the stack may need to be written first
+        string inlineCost = mOptions.cacheTopOfStack ? "9-12 words and 6-11 cycles" : "11 words and 8-11 cycles";
+        string sharedCost = mOptions.cacheTopOfStack ? "14-19 words and 22-29 cycles" : "14 words and 22-24 cycles";
+        sharedCost += " each, with 20 words of the shared code";
+        inlineCost += " each";
+
+        bool isInline = mOptions.comparisons == EComparisonMode::INLINE;
+        mOptimizationReport += mOptimizationReport.empty() ? "" : "\n";
+        mOptimizationReport += "Wrote " + to_string(mCodeWriter->getComparisonCount()) + " comparisons "
+            + (isInline ? "inline: " + inlineCost + " (shared: " + sharedCost + ")."
+                : "shared: " + sharedCost + " (inline: " + inlineCost + ").");
+    }
+
+    mCodeWriter->writeFinalCode();
+}
+
+string VMTranslator::getOptimizationReport() const
+{
+    return mOptimizationReport;
+}
+
+void VMTranslator::writeFragment(const AssemblyFragment& fragment)
+{
+    mCodeWriter->writeFragment(fragment);
+}
+
+AssemblyFragment VMTranslator::translateFragment(istream& inputStream, const string& fileName, bool generateComment,
+    const TranslationOptions& options)
+{
+    ostringstream outputStream;
+    VMTranslator vmTranslator;
+    vmTranslator.mOptions = options;
+    vmTranslator.mCodeWriter = make_unique<CodeWriter>(outputStream, generateComment, false, options);
+    vmTranslator.parseStream(inputStream, fileName);
+    vmTranslator.mCodeWriter->writeCachedTop();
+
+    auto fragment = vmTranslator.mCodeWriter->getLinkInfo();
+    fragment.code = outputStream.str();
+    return fragment;
+}
+
 void VMTranslator::parseSingleFile(const string& path)
 {
     auto parser = Parser(path);
+    parse(parser, fs::path(path).replace_extension("").filename().string());
+}
 
-    auto fileName = fs::path(path).replace_extension("").filename().string();
+void VMTranslator::parse(Parser& parser, const string& fileName)
+{
     mCodeWriter->setFileName(fileName);
 
     while (parser.hasMoreLines())
@@ -111,37 +198,87 @@ void VMTranslator::parseSingleFile(const string& path)
         {
             continue;
         }
-        else if (parser.commandType() == ECommandType::C_ARITHMETIC)
-        {
-            mCodeWriter->writeArithmetic(parser.arg1());
-        }
-        else if (parser.commandType() == ECommandType::C_PUSH || parser.commandType() == ECommandType::C_POP)
-        {
-            mCodeWriter->writePushPop(parser.commandType(), parser.arg1(), parser.arg2());
-        }
-        else if (parser.commandType() == ECommandType::C_LABEL)
-        {
-            mCodeWriter->writeLabel(parser.arg1());
-        }
-        else if (parser.commandType() == ECommandType::C_GOTO)
-        {
-            mCodeWriter->writeGoto(parser.arg1());
-        }
-        else if (parser.commandType() == ECommandType::C_IF)
-        {
-            mCodeWriter->writeIf(parser.arg1());
-        }
-        else if (parser.commandType() == ECommandType::C_FUNCTION)
+
+        auto command = VMCommand{ parser.commandType(), parser.arg1(), parser.arg2(), fileName };
+        if (mOptions.inlineFunctions)
         {
-            mCodeWriter->writeFunction(parser.arg1(), parser.arg2());
+            mCommands.push_back(std::move(command));
         }
-        else if (parser.commandType() == ECommandType::C_RETURN)
+        else
         {
-            mCodeWriter->writeReturn();
+            writeCommand(command);
         }
-        else if (parser.commandType() == ECommandType::C_CALL)
+    }
+    writePendingCall();
+}
+
+void VMTranslator::writeCommand(const VMCommand& command)
+{
+    if (mPendingCall)
+    {
+        if (command.type == ECommandType::C_RETURN)
         {
-            mCodeWriter->writeCall(parser.arg1(), parser.arg2());
+            mCodeWriter->writeTailCall(mPendingCall->arg2);
+            mPendingCall.reset();
+            mTailCallCount++;
+            return;
         }
+        writePendingCall();
+    }
+
+    if (command.type == ECommandType::C_FUNCTION)
+    {
+        mFunctionName = command.arg1;
+    }
+    if (mOptions.tailCalls && command.type == ECommandType::C_CALL && command.arg1 == mFunctionName)
+    {
+        mPendingCall = command;
+        return;
+    }
+    translateCommand(command);
+}
+
+void VMTranslator::writePendingCall()
+{
+    if (mPendingCall)
+    {
+        translateCommand(*mPendingCall);
+        mPendingCall.reset();
+    }
+}
+
+void VMTranslator::translateCommand(const VMCommand& command)
+{
+    if (command.type == ECommandType::C_ARITHMETIC)
+    {
+        mCodeWriter->writeArithmetic(command.arg1);
+    }
+    else if (command.type == ECommandType::C_PUSH || command.type == ECommandType::C_POP)
+    {
+        mCodeWriter->writePushPop(command.type, command.arg1, command.arg2);
+    }
+    else if (command.type == ECommandType::C_LABEL)
+    {
+        mCodeWriter->writeLabel(command.arg1);
+    }
+    else if (command.type == ECommandType::C_GOTO)
+    {
+        mCodeWriter->writeGoto(command.arg1);
+    }
+    else if (command.type == ECommandType::C_IF)
+    {
+        mCodeWriter->writeIf(command.arg1);
+    }
+    else if (command.type == ECommandType::C_FUNCTION)
+    {
+        mCodeWriter->writeFunction(command.arg1, command.arg2);
+    }
+    else if (command.type == ECommandType::C_RETURN)
+    {
+        mCodeWriter->writeReturn();
+    }
+    else if (command.type == ECommandType::C_CALL)
+    {
+        mCodeWriter->writeCall(command.arg1, command.arg2);
     }
 }
@@ -1,6 +1,13 @@
 #pragma once
+#include <istream>
+#include <optional>
+#include <ostream>
 #include <string>
+#include <vector>
 #include "CodeWriter.h"
+#include "Parser.h"
+#include "TranslationOptions.h"
+#include "VMCommand.h"
 
 /// <summary>
 /// VMTranslator contains main implementation to parse single file or all files from the specified directory. 
@@ -14,7 +21,12 @@ public:
     /// May throw a runtime exception.
     /// </summary>
     /// <param name="path"></param>
-    explicit VMTranslator(const std::string& path);
+    explicit VMTranslator(const std::string& path, const TranslationOptions& options = TranslationOptions());
+    /// <summary>
+    /// Creates CodeWriter writing into the stream. VM code is passed with parseStream,
+    ///     translation must be finished with writeFinalCode.
+    /// </summary>
+    VMTranslator(std::ostream& outputStream, bool generateComment, const TranslationOptions& options = TranslationOptions());
 
     /// <summary>
     /// Returns an information, whether provided path is directory or single file.
@@ -33,13 +45,57 @@ public:
     /// </summary>
     /// <returns></returns>
     std::string getOutputFile() const;
+    /// <summary>
+    /// Parses VM code of the single class from the stream.
+    /// </summary>
+    /// <param name="inputStream">Stream with VM code</param>
+    /// <param name="fileName">Name of the class, used for static variables</param>
+    void parseStream(std::istream& inputStream, const std::string& fileName);
+    /// <summary>
+    /// Validates labels and writes the bootstrap code after all classes are parsed.
+    /// With inlining enabled, the whole program is translated here.
+    /// </summary>
+    void writeFinalCode();
+    /// <summary>
+    /// Returns summary of the optimizations, empty if no optimization is enabled.
+    /// </summary>
+    std::string getOptimizationReport() const;
+    /// <summary>
+    /// Appends class translated with translateFragment.
+    /// </summary>
+    void writeFragment(const AssemblyFragment& fragment);
+
+    /// <summary>
+    /// Translates VM code of the single class independently of the other classes.
+    /// The result can be stored and later passed to writeFragment.
+    /// </summary>
+    /// <param name="inputStream">Stream with VM code</param>
+    /// <param name="fileName">Name of the class, used for static variables</param>
+    static AssemblyFragment translateFragment(std::istream& inputStream, const std::string& fileName, bool generateComment,
+        const TranslationOptions& options = TranslationOptions());
 
 private:
+    VMTranslator() = default;
+
     void parseSingleFile(const std::string& path);
+    void parse(Parser& parser, const std::string& fileName);
+    void writeCommand(const VMCommand& command);
+    void writePendingCall();
+    void translateCommand(const VMCommand& command);
 
     std::string mInputFileName;
     std::string mOutputFileName;
-    bool mIsDirectoryPath;
+    bool mIsDirectoryPath = false;
+    TranslationOptions mOptions;
+
+    // commands of the whole program, if they are transformed before the translation
+    std::vector<VMCommand> mCommands;
+    std::string mOptimizationReport;
+
+    // call of the current function, written as a tail call if the return follows
+    std::string mFunctionName;
+    std::optional<VMCommand> mPendingCall;
+    int mTailCallCount = 0;
 
     std::unique_ptr<CodeWriter> mCodeWriter;
 };
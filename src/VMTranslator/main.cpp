@@ -6,28 +6,54 @@
 
 int main(int argc, char* argv[])
 {
-    if (argc > 2)
+    std::string path;
+    TranslationOptions options;
+
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "Usage: \n"
-            << "\tVMTranslator InputDirectory\n"
-            << "\tVMTranslator InputFile.vm\n";
-        return EXIT_FAILURE;
+        std::string arg = argv[i];
+        if (arg == "--inline")
+        {
+            options.inlineFunctions = true;
+        }
+        else if (arg == "--tail-calls")
+        {
+            options.tailCalls = true;
+        }
+        else if (arg == "--cache-tos")
+        {
+            options.cacheTopOfStack = true;
+        }
+        else if (arg == "--comparisons=inline")
+        {
+            options.comparisons = EComparisonMode::INLINE;
+        }
+        else if (arg == "--comparisons=shared")
+        {
+            options.comparisons = EComparisonMode::SHARED;
+        }
+        else if (path.empty() && arg.rfind("--", 0) != 0)
+        {
+            path = arg;
+        }
+        else
+        {
+            std::cout << "Usage: \n"
+                << "\tVMTranslator InputDirectory [--inline] [--tail-calls] [--cache-tos] [--comparisons=inline|shared]\n"
+                << "\tVMTranslator InputFile.vm [--inline] [--tail-calls] [--cache-tos] [--comparisons=inline|shared]\n";
+            return EXIT_FAILURE;
+        }
     }
 
-    std::string path;
-    if (argc == 1)
+    if (path.empty())
     {
         std::cout << "No file or directory specifed. Searching for files in current directory.\n";
         path = std::filesystem::current_path().string();
     }
-    else
-    {
-        path = argv[1];
-    }
     
     try
     {
-        auto vmTranslator = VMTranslator(path);
+        auto vmTranslator = VMTranslator(path, options);
 
         auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -42,6 +68,10 @@ int main(int argc, char* argv[])
 
         auto endTime = std::chrono::high_resolution_clock::now();
         
+        if (auto report = vmTranslator.getOptimizationReport(); !report.empty())
+        {
+            std::cout << report << "\n";
+        }
         std::cout << "Created assembly code " << vmTranslator.getOutputFile() << " file in " << (endTime - startTime) / std::chrono::milliseconds(1) << " ms.\n";
         return EXIT_SUCCESS;
     }